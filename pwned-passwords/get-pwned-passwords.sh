@@ -1,14 +1,30 @@
 #!/bin/bash
 
+# usage: get-pwned-passwords.sh [ntlm]
+#   default is the SHA-1 database pwd-full.srds - or with 'ntlm' the NTLM database pwd-ntlm.srds
+
 DBVER="Version 8"
-HASH_N="pwned-passwords-sha1-ordered-by-hash-v8"
-ARCH_SHA="3499a3f82bb94f62cbd9bc782d6d20324e7cde8e"
+if [ "$1" == "ntlm" ]; then
+  # NTLM hashes, e.g. for Active Directory audits with: haveibeenpwned --ntlm
+  HASH_N="pwned-passwords-ntlm-ordered-by-hash-v8"
+  RAW=16
+  DBN="pwd-ntlm.srds"
+else
+  HASH_N="pwned-passwords-sha1-ordered-by-hash-v8"
+  ARCH_SHA="3499a3f82bb94f62cbd9bc782d6d20324e7cde8e"
+  RAW=20
+  DBN="pwd-full.srds"
+fi
 
 echo "continue/download compressed 7zip archive ${DBVER} - ordered by hash"
 wget -c "https://downloads.pwnedpasswords.com/passwords/${HASH_N}.7z"
 
 echo ""
-echo "verify donwloaded files' integrity via SHA1 hash values against ${ARCH_SHA}"
+if [ -n "${ARCH_SHA}" ]; then
+  echo "verify donwloaded files' integrity via SHA1 hash values against ${ARCH_SHA}"
+else
+  echo "verify donwloaded files' integrity via SHA1 hash values against the one published at"
+fi
 echo "  https://haveibeenpwned.com/Passwords"
 sha1sum ${HASH_N}.7z
 
@@ -22,9 +38,14 @@ echo "check first 50 lines .. whilst decompressing full password file?"
 7z x -so ${HASH_N}.7z ${HASH_N}.txt | head -n 50 >first50.txt
 
 echo ""
-echo "decompress ${HASH_N}.7z     and convert to binary .."
-7z x -so ${HASH_N}.7z ${HASH_N}.txt | hex2rds -B 4096 -o pwd-full.srds
-echo "${HASH_N}.7z" >pwd-full.srds.source.txt
+echo "decompress ${HASH_N}.7z     and convert to binary - checking sort order and indexing on the fly .."
+set -o pipefail
+7z x -so ${HASH_N}.7z ${HASH_N}.txt | hex2rds -B 4096 -n ${RAW} -I ${DBN}.idx -p 20 -H ${DBN}.hot -t 100000 -m ${DBN}.meta -o ${DBN}
+if [ $? -ne 0 ]; then
+  echo "error: conversion failed or ${DBN} is not sorted!"
+  exit 10
+fi
+echo "${HASH_N}.7z" >${DBN}.source.txt
 # if database would be compressed with gz or bz2 we could curl directly pipe into gunzip / bunzip2
 
 
@@ -34,6 +55,8 @@ echo "merging updates 1 & 2 .."
 srdsmerge -vv -l 20 -o pwd-updates.srds  pwd-update1.srds pwd-update2.srds
 echo "merging 1.0 database with updates .. this takes some time .."
 srdsmerge -vv -l 20 -o pwd-full.srds     pwd-1.0.srds     pwd-updates.srds
+# or without temporary pwd-updates.srds:
+#srdsmerge -l 20 pwd-update1.srds pwd-update2.srds | srdsmerge -l 20 -o pwd-full.srds pwd-1.0.srds -
 
 #od -A n -t x1 -w20 -v pwd-updates.srds | sed 's/ //g' | head -n 20
 #od -A n -t x1 -w20 -v pwd-updates.srds | head -n 20
@@ -42,9 +65,23 @@ srdsmerge -vv -l 20 -o pwd-full.srds     pwd-1.0.srds     pwd-updates.srds
 fi
 
 echo ""
-echo "test sort order of result file: pwd-full.srds .. this takes some time .."
+echo "sort order of result file ${DBN} was checked while converting"
 # od -A n -t x1 -w20 -v pwd-full.srds | sort -c  # this is really slow!
-srdscheck -v -l 20 pwd-full.srds
+# srdscheck -v -l ${RAW} ${DBN}                 # re-reads the full file
+cat ${DBN}.meta
 
-echo ""
-echo "test fulfilled - all ok, if there was no output"
+# optional: succinct Elias-Fano representation (~ 4.5 bytes per hash) for in memory lookups with srdsgrep -E
+# srds2ef -v -l ${RAW} -i ${DBN} -o ${DBN}.ef
+
+# optional: static search tree layout - a copy of the database with page sized tree nodes in front.
+# each lookup reads ~ 3 pages. haveibeenpwned searches it instead of the database
+# srds2tree -v -l ${RAW} -k 512 -i ${DBN} -o ${DBN}.tree
+
+# optional: key prefix column for srdsgrep -K: one 8 byte prefix per page (~ 33 MB) fits in RAM
+# srds2col -v -l ${RAW} -s 0 -i ${DBN} -o ${DBN}.col
+
+# optional: learned index (a few kB) for srdsgrep -P: predicts each hash's position within 64 records
+# srds2pgm -v -l ${RAW} -e 64 -i ${DBN} -o ${DBN}.pgm
+
+# optional: split into shards of key ranges, e.g. over 2 disks. haveibeenpwned routes each hash to its shard
+# srdssplit -v -l ${RAW} -n 4 -p 16 -d /disk1 -d /disk2 -m ${DBN}.manifest -o pwd ${DBN}
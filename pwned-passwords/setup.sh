@@ -11,4 +11,43 @@ fi
 install -d "$PREFIX/bin"
 install -d "$PREFIX/share/haveibeenpwned"
 install haveibeenpwned "$PREFIX/bin/"
-install pwd-full.srds  "$PREFIX/share/haveibeenpwned/"
+if [ -f pwd-full.srds ]; then
+  install pwd-full.srds  "$PREFIX/share/haveibeenpwned/"
+fi
+if [ -f pwd-full.srds.idx ]; then
+  install -m 644 pwd-full.srds.idx "$PREFIX/share/haveibeenpwned/"
+fi
+if [ -f pwd-full.srds.hot ]; then
+  install -m 644 pwd-full.srds.hot "$PREFIX/share/haveibeenpwned/"
+fi
+if [ -f pwd-full.srds.tree ]; then
+  install -m 644 pwd-full.srds.tree "$PREFIX/share/haveibeenpwned/"
+fi
+if [ -f pwd-full.srds.col ]; then
+  install -m 644 pwd-full.srds.col "$PREFIX/share/haveibeenpwned/"
+fi
+if [ -f pwd-full.srds.pgm ]; then
+  install -m 644 pwd-full.srds.pgm "$PREFIX/share/haveibeenpwned/"
+fi
+if [ -f pwd-full.srds.ef ]; then
+  install -m 644 pwd-full.srds.ef "$PREFIX/share/haveibeenpwned/"
+fi
+if [ -f pwd-ntlm.srds ]; then
+  install -m 644 pwd-ntlm.srds "$PREFIX/share/haveibeenpwned/"
+  for f in pwd-ntlm.srds.idx pwd-ntlm.srds.meta pwd-ntlm.srds.hot pwd-ntlm.srds.pgm pwd-ntlm.srds.tree pwd-ntlm.srds.col; do
+    if [ -f $f ]; then
+      install -m 644 $f "$PREFIX/share/haveibeenpwned/"
+    fi
+  done
+fi
+# shards from srdssplit: the manifest's paths are relative to its directory
+for m in pwd-full.srds.manifest pwd-ntlm.srds.manifest; do
+  if [ -f $m ]; then
+    install -m 644 $m "$PREFIX/share/haveibeenpwned/"
+    for f in $( grep "^shard=" $m | cut -d ' ' -f 4 ); do
+      # shards with absolute paths stay where they are
+      case "$f" in /*) continue ;; esac
+      install -m 644 -D $f "$PREFIX/share/haveibeenpwned/$f"
+    done
+  fi
+done
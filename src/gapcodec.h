@@ -0,0 +1,427 @@
+/*
+ * gapcodec.h
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * gap coding of sorted raw data sets - without need of an external compressor:
+ * each record is interpreted as big endian unsigned integer of blockSize bytes.
+ * the (big integer) difference 'gap' to the previous record is Rice coded:
+ *   gap = q * 2^k + r  is written as  q '1' bits, one '0' bit and the k low bits r.
+ * for sorted hashes, the gaps are (nearly) exponentially distributed,
+ * for which Rice coding is close to optimal: about  bits(gap) + 2 bits per record.
+ * with ~850 million SHA-1 hashes, this is ~ 16.7 bytes per record - instead of 20.
+ * gaps with q >= GAP_QMAX (e.g. unsorted data) are escaped: GAP_QMAX '1' bits and
+ * the full gap (modulo 2^(8*blockSize)) with 8*blockSize bits.
+ *
+ * records are coded in blocks of up to GAP_BLOCKRECS records.
+ * k is chosen per block from the median bit length of the block's gaps.
+ * the previous record is carried over blocks.
+ *
+ * stream format - all numbers little endian:
+ *   8 bytes   magic "SRDSGAP1"
+ *   4 bytes   blockSize
+ *   blocks:
+ *     2 bytes   k
+ *     4 bytes   number of records in block
+ *     4 bytes   number of payload bytes
+ *     payload   bit stream, MSB first, padded with '0' bits to full byte
+ *
+ * Author:  Hayati Ayguen
+ */
+
+#ifndef GAPCODEC_H
+#define GAPCODEC_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define GAP_MAGIC        "SRDSGAP1"
+#define GAP_HEADER_SIZE  12
+#define GAP_BLKHDR_SIZE  10
+#define GAP_BLOCKRECS    4096
+#define GAP_QMAX         48
+#define GAP_MAX_BLOCKSIZE  256   /* bit lengths of the gaps are counted in a fixed histogram */
+
+
+static inline
+void gapPutLE( unsigned char * p, uint32_t v, int n )
+{
+  int k;
+  for ( k = 0; k < n; ++k )
+    p[k] = (unsigned char)( v >> (8 * k) );
+}
+
+static inline
+uint32_t gapGetLE( const unsigned char * p, int n )
+{
+  uint32_t v = 0;
+  int k;
+  for ( k = n - 1; k >= 0; --k )
+    v = ( v << 8 ) | p[k];
+  return v;
+}
+
+/* c = a - b  over n big endian bytes */
+static inline
+void gapSub( unsigned char * c, const unsigned char * a, const unsigned char * b, int n )
+{
+  int borrow = 0, k;
+  for ( k = n - 1; k >= 0; --k ) {
+    const int v = (int)a[k] - (int)b[k] - borrow;
+    c[k] = (unsigned char)v;
+    borrow = ( v < 0 );
+  }
+}
+
+/* c = a + b  over n big endian bytes */
+static inline
+void gapAdd( unsigned char * c, const unsigned char * a, const unsigned char * b, int n )
+{
+  int carry = 0, k;
+  for ( k = n - 1; k >= 0; --k ) {
+    const int v = (int)a[k] + (int)b[k] + carry;
+    c[k] = (unsigned char)v;
+    carry = v >> 8;
+  }
+}
+
+/* number of significant bits */
+static inline
+int gapBitLen( const unsigned char * a, int n )
+{
+  int k;
+  for ( k = 0; k < n && !a[k]; ++k )
+    ;
+  if ( k == n )
+    return 0;
+  return 8 * ( n - 1 - k ) + ( 32 - __builtin_clz( (unsigned)a[k] ) );
+}
+
+
+/* bit stream writer / reader - MSB first */
+
+struct GapBitWriter {
+  unsigned char * p;
+  uint64_t acc;
+  int cnt;
+};
+
+static inline
+void gapPutBits( struct GapBitWriter * w, uint64_t v, int n )   /* n <= 56 */
+{
+  w->acc = ( w->acc << n ) | v;
+  w->cnt += n;
+  while ( w->cnt >= 8 ) {
+    w->cnt -= 8;
+    *w->p++ = (unsigned char)( w->acc >> w->cnt );
+  }
+}
+
+/* writes the low 'nbits' bits of the n bytes big endian integer a */
+static inline
+void gapPutLowBits( struct GapBitWriter * w, const unsigned char * a, int n, int nbits )
+{
+  int k;
+  if ( nbits <= 0 )
+    return;
+  k = n - 1 - ( nbits - 1 ) / 8;
+  gapPutBits( w, a[k] & ( ( 1U << ( ( nbits - 1 ) % 8 + 1 ) ) - 1 ), ( nbits - 1 ) % 8 + 1 );
+  for ( ++k; k < n; ++k )
+    gapPutBits( w, a[k], 8 );
+}
+
+struct GapBitReader {
+  const unsigned char * p;
+  const unsigned char * end;
+  uint64_t acc;
+  int cnt;
+};
+
+static inline
+uint64_t gapGetBits( struct GapBitReader * r, int n )   /* n <= 56 */
+{
+  while ( r->cnt < n ) {
+    r->acc = ( r->acc << 8 ) | ( r->p < r->end ? *r->p++ : 0 );
+    r->cnt += 8;
+  }
+  r->cnt -= n;
+  return ( r->acc >> r->cnt ) & ( ( (uint64_t)1 << n ) - 1 );
+}
+
+/* reads 'nbits' bits into the low bits of the n bytes big endian integer a - upper bytes are zeroed */
+static inline
+void gapGetLowBits( struct GapBitReader * r, unsigned char * a, int n, int nbits )
+{
+  int k;
+  memset( a, 0, n );
+  if ( nbits <= 0 )
+    return;
+  k = n - 1 - ( nbits - 1 ) / 8;
+  a[k] = (unsigned char)gapGetBits( r, ( nbits - 1 ) % 8 + 1 );
+  for ( ++k; k < n; ++k )
+    a[k] = (unsigned char)gapGetBits( r, 8 );
+}
+
+/* counts '1' bits up to the next '0' - maximum qmax */
+static inline
+int gapGetUnary( struct GapBitReader * r, int qmax )
+{
+  int q = 0;
+  while ( q < qmax && gapGetBits( r, 1 ) )
+    ++q;
+  return q;
+}
+
+
+/* encoder */
+
+struct GapEncoder {
+  FILE * out;
+  int blockSize;
+  size_t numRecs;          /* records in current block */
+  unsigned char * prev;    /* last record of previous block */
+  unsigned char * recs;    /* records of current block */
+  unsigned char * gaps;
+  unsigned char * payload;
+  unsigned long long bytesWritten;
+};
+
+/* returns 0 on success */
+static
+int gapEncoderInit( struct GapEncoder * e, FILE * out, int blockSize )
+{
+  unsigned char h[GAP_HEADER_SIZE];
+  memset( e, 0, sizeof(*e) );
+  if ( blockSize <= 0 || blockSize > GAP_MAX_BLOCKSIZE )
+    return -1;
+  e->out = out;
+  e->blockSize = blockSize;
+  e->prev = (unsigned char *)calloc( 1, blockSize );
+  e->recs = (unsigned char *)malloc( (size_t)GAP_BLOCKRECS * blockSize );
+  e->gaps = (unsigned char *)malloc( (size_t)GAP_BLOCKRECS * blockSize );
+  e->payload = (unsigned char *)malloc( GAP_BLKHDR_SIZE + (size_t)GAP_BLOCKRECS * ( blockSize + GAP_QMAX / 8 + 2 ) );
+  if ( !e->prev || !e->recs || !e->gaps || !e->payload )
+    return -1;
+  memcpy( h, GAP_MAGIC, 8 );
+  gapPutLE( h + 8, (uint32_t)blockSize, 4 );
+  e->bytesWritten = GAP_HEADER_SIZE;
+  return fwrite( h, GAP_HEADER_SIZE, 1, out ) == 1 ? 0 : -1;
+}
+
+static
+int gapEncoderFlush( struct GapEncoder * e )
+{
+  const int bs = e->blockSize;
+  const size_t n = e->numRecs;
+  size_t hist[8 * GAP_MAX_BLOCKSIZE + 1];
+  struct GapBitWriter w;
+  size_t i, sum, len;
+  int k, b;
+
+  if ( !n )
+    return 0;
+  if ( bs > GAP_MAX_BLOCKSIZE )
+    return -1;
+
+  /* gaps and median bit length */
+  memset( hist, 0, ( 8 * bs + 1 ) * sizeof(size_t) );
+  for ( i = 0; i < n; ++i ) {
+    const unsigned char * cur = e->recs + i * bs;
+    gapSub( e->gaps + i * bs, cur, i ? cur - bs : e->prev, bs );
+    ++hist[ gapBitLen( e->gaps + i * bs, bs ) ];
+  }
+  for ( b = 0, sum = 0; b <= 8 * bs; ++b ) {
+    sum += hist[b];
+    if ( 2 * sum >= n )
+      break;
+  }
+  k = ( b > 0 ) ? b - 1 : 0;
+
+  w.p = e->payload + GAP_BLKHDR_SIZE;
+  w.acc = 0;
+  w.cnt = 0;
+  for ( i = 0; i < n; ++i ) {
+    const unsigned char * g = e->gaps + i * bs;
+    const int bl = gapBitLen( g, bs );
+    uint64_t q = 0;
+    if ( bl - k > 6 )
+      q = GAP_QMAX;   /* q >= 64 */
+    else if ( bl > k ) {
+      /* q = g >> k: at most 6 bits from the top bytes */
+      int j;
+      for ( j = bl - 1; j >= k; --j )
+        q = ( q << 1 ) | ( ( g[ bs - 1 - j / 8 ] >> ( j % 8 ) ) & 1 );
+    }
+    if ( q < GAP_QMAX ) {
+      gapPutBits( &w, ( ( (uint64_t)1 << q ) - 1 ) << 1, (int)q + 1 );
+      gapPutLowBits( &w, g, bs, k );
+    }
+    else {
+      gapPutBits( &w, ( (uint64_t)1 << GAP_QMAX ) - 1, GAP_QMAX );
+      gapPutLowBits( &w, g, bs, 8 * bs );
+    }
+  }
+  if ( w.cnt )
+    gapPutBits( &w, 0, 8 - w.cnt );
+
+  len = (size_t)( w.p - e->payload );
+  gapPutLE( e->payload, (uint32_t)k, 2 );
+  gapPutLE( e->payload + 2, (uint32_t)n, 4 );
+  gapPutLE( e->payload + 6, (uint32_t)( len - GAP_BLKHDR_SIZE ), 4 );
+  if ( fwrite( e->payload, 1, len, e->out ) != len )
+    return -1;
+  e->bytesWritten += len;
+
+  memcpy( e->prev, e->recs + ( n - 1 ) * bs, bs );
+  e->numRecs = 0;
+  return 0;
+}
+
+/* appends n records. returns 0 on success */
+static
+int gapEncoderPut( struct GapEncoder * e, const unsigned char * recs, size_t n )
+{
+  const int bs = e->blockSize;
+  while ( n ) {
+    size_t m = GAP_BLOCKRECS - e->numRecs;
+    if ( m > n )
+      m = n;
+    memcpy( e->recs + e->numRecs * bs, recs, m * bs );
+    e->numRecs += m;
+    recs += m * bs;
+    n -= m;
+    if ( e->numRecs == GAP_BLOCKRECS && gapEncoderFlush( e ) )
+      return -1;
+  }
+  return 0;
+}
+
+/* flushes last block and frees buffers. returns 0 on success */
+static
+int gapEncoderFinish( struct GapEncoder * e )
+{
+  int ret = gapEncoderFlush( e );
+  free( e->prev );
+  free( e->recs );
+  free( e->gaps );
+  free( e->payload );
+  e->prev = e->recs = e->gaps = e->payload = NULL;
+  return ret;
+}
+
+
+/* decoder */
+
+struct GapDecoder {
+  FILE * in;
+  int blockSize;
+  int k;
+  size_t recsLeft;           /* in current block */
+  unsigned char * prev;      /* last decoded record */
+  unsigned char * gap;
+  unsigned char * payload;
+  size_t payloadCap;
+  struct GapBitReader r;
+};
+
+/* checks whether the n bytes at p start a gap coded stream */
+static inline
+int gapIsStream( const unsigned char * p, size_t n )
+{
+  return n >= 8 && !memcmp( p, GAP_MAGIC, 8 );
+}
+
+/*
+ * reads stream header - or takes the GAP_HEADER_SIZE bytes already read from 'header'.
+ * with blockSize > 0, it must match the stream.
+ * returns blockSize of the stream or -1 on error
+ */
+static
+int gapDecoderInit( struct GapDecoder * d, FILE * in, int blockSize, const unsigned char * header )
+{
+  unsigned char h[GAP_HEADER_SIZE];
+  memset( d, 0, sizeof(*d) );
+  d->in = in;
+  if ( header )
+    memcpy( h, header, GAP_HEADER_SIZE );
+  else if ( fread( h, GAP_HEADER_SIZE, 1, in ) != 1 )
+    return -1;
+  if ( !gapIsStream( h, GAP_HEADER_SIZE ) )
+    return -1;
+  d->blockSize = (int)gapGetLE( h + 8, 4 );
+  if ( d->blockSize <= 0 || d->blockSize > GAP_MAX_BLOCKSIZE || ( blockSize > 0 && blockSize != d->blockSize ) )
+    return -1;
+  d->prev = (unsigned char *)calloc( 1, d->blockSize );
+  d->gap = (unsigned char *)malloc( d->blockSize );
+  if ( !d->prev || !d->gap )
+    return -1;
+  return d->blockSize;
+}
+
+/* decodes up to maxN records into out. returns number of records, 0 at end or -1 on error */
+static
+long gapDecoderGet( struct GapDecoder * d, unsigned char * out, size_t maxN )
+{
+  const int bs = d->blockSize;
+  size_t n = 0;
+
+  while ( n < maxN ) {
+    int q;
+    if ( !d->recsLeft ) {
+      unsigned char h[GAP_BLKHDR_SIZE];
+      size_t len;
+      if ( fread( h, GAP_BLKHDR_SIZE, 1, d->in ) != 1 )
+        return ( n || !ferror(d->in) ) ? (long)n : -1;
+      d->k = (int)gapGetLE( h, 2 );
+      d->recsLeft = gapGetLE( h + 2, 4 );
+      len = gapGetLE( h + 6, 4 );
+      if ( d->k > 8 * bs || d->recsLeft > GAP_BLOCKRECS )
+        return -1;
+      if ( len > d->payloadCap ) {
+        free( d->payload );
+        d->payloadCap = len;
+        d->payload = (unsigned char *)malloc( len );
+        if ( !d->payload )
+          return -1;
+      }
+      if ( len && fread( d->payload, 1, len, d->in ) != len )
+        return -1;
+      d->r.p = d->payload;
+      d->r.end = d->payload + len;
+      d->r.acc = 0;
+      d->r.cnt = 0;
+      continue;
+    }
+
+    q = gapGetUnary( &d->r, GAP_QMAX );
+    if ( q < GAP_QMAX ) {
+      int j;
+      gapGetLowBits( &d->r, d->gap, bs, d->k );
+      for ( j = 0; j < 6 && ( q >> j ); ++j )
+        if ( ( q >> j ) & 1 )
+          d->gap[ bs - 1 - ( d->k + j ) / 8 ] |= (unsigned char)( 1 << ( ( d->k + j ) % 8 ) );
+    }
+    else
+      gapGetLowBits( &d->r, d->gap, bs, 8 * bs );
+
+    gapAdd( d->prev, d->prev, d->gap, bs );
+    memcpy( out + n * bs, d->prev, bs );
+    ++n;
+    --d->recsLeft;
+  }
+  return (long)n;
+}
+
+static
+void gapDecoderFree( struct GapDecoder * d )
+{
+  free( d->prev );
+  free( d->gap );
+  free( d->payload );
+  d->prev = d->gap = d->payload = NULL;
+}
+
+#endif /* GAPCODEC_H */
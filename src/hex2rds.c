@@ -11,14 +11,28 @@
  * Author:  Hayati Ayguen
  */
 
+/* fopencookie() for the telemetry */
+#define _GNU_SOURCE
+
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "hexcodec.h"
+#include "srdsindex.h"
+#include "srdshot.h"
+#include "srdsstat.h"
+#include "srdsckpt.h"
+#include "srdsio.h"
 
 #define DBGOUT  0
 
+#define CHUNK_MIN_SIZE  ( 4 * 1024 * 1024 )  /* minimum size of input chunks */
+
 /* returns length in number of hexadecimal digits - might be odd! */
 static
 int hashLen( const char * s )
@@ -109,17 +123,582 @@ int convertHash( const char * s, size_t maxBinLen, unsigned char * bin )
   return blen;
 }
 
+
+/*
+ * fast path for the fixed format: lines of exactly 2*rawSize hexadecimal digits,
+ * optionally followed by ':COUNT'. decodeFixed() returns 1 if all digits are valid.
+ * irregular lines are left to the scalar parser above.
+ */
+
+static signed char hexValue[256];
+
+static
+void initHexValues()
+{
+  int c;
+  for ( c = 0; c < 256; ++c )
+    hexValue[c] = -1;
+  for ( c = '0'; c <= '9'; ++c )
+    hexValue[c] = (signed char)( c - '0' );
+  for ( c = 'A'; c <= 'F'; ++c )
+    hexValue[c] = hexValue[c - 'A' + 'a'] = (signed char)( 10 + c - 'A' );
+}
+
+static
+int decodeFixedScalar( const char * s, size_t rawSize, unsigned char * bin )
+{
+  const unsigned char * u = (const unsigned char *)s;
+  int valid = 0;
+  size_t k;
+  for ( k = 0; k < rawSize; ++k ) {
+    const int hi = hexValue[ u[2*k] ];
+    const int lo = hexValue[ u[2*k+1] ];
+    valid |= hi | lo;  /* negative on any invalid digit */
+    bin[k] = (unsigned char)( (hi << 4) | (lo & 15) );
+  }
+  return valid >= 0;
+}
+
+#if defined(__GNUC__) && defined(__SSE2__) && ( defined(__x86_64__) || defined(__i386__) )
+#define SSE2_AVAILABLE  1
+#include <x86intrin.h>
+
+/* converts 16 hexadecimal digits into 8 bytes. returns mask of valid digits */
+static inline
+int decode16_sse2( const char * s, unsigned char * bin )
+{
+  const __m128i c = _mm_loadu_si128( (const __m128i *)s );
+  const __m128i l = _mm_or_si128( c, _mm_set1_epi8(0x20) );
+  const __m128i digit = _mm_and_si128( _mm_cmpgt_epi8( c, _mm_set1_epi8('0' - 1) ),
+                                       _mm_cmplt_epi8( c, _mm_set1_epi8('9' + 1) ) );
+  const __m128i alpha = _mm_and_si128( _mm_cmpgt_epi8( l, _mm_set1_epi8('a' - 1) ),
+                                       _mm_cmplt_epi8( l, _mm_set1_epi8('f' + 1) ) );
+  /* '0'..'9' => 0..9,  'A'..'F' / 'a'..'f' => 1..6 + 9 */
+  const __m128i nib = _mm_add_epi8( _mm_and_si128( c, _mm_set1_epi8(0x0F) ),
+                                    _mm_and_si128( alpha, _mm_set1_epi8(9) ) );
+  /* little endian 16 bit: low byte is high nibble, high byte is low nibble */
+  const __m128i w = _mm_or_si128( _mm_slli_epi16( _mm_and_si128( nib, _mm_set1_epi16(0x00FF) ), 4 ),
+                                  _mm_srli_epi16( nib, 8 ) );
+  _mm_storel_epi64( (__m128i *)bin, _mm_packus_epi16( w, w ) );
+  return _mm_movemask_epi8( _mm_or_si128( digit, alpha ) );
+}
+
+static
+int decodeFixedSSE2( const char * s, size_t rawSize, unsigned char * bin )
+{
+  int valid = 0xFFFF;
+  size_t o;
+  for ( o = 0; o + 8 <= rawSize; o += 8 )
+    valid &= decode16_sse2( s + 2*o, bin + o );
+  if ( o < rawSize )  /* overlapping tail */
+    valid &= decode16_sse2( s + 2*rawSize - 16, bin + rawSize - 8 );
+  return valid == 0xFFFF;
+}
+
+__attribute__((target("avx2")))
+static
+int decodeFixedAVX2( const char * s, size_t rawSize, unsigned char * bin )
+{
+  unsigned valid = 0xFFFFFFFFU;
+  size_t o;
+  for ( o = 0; o + 16 <= rawSize; o += 16 ) {
+    const __m256i c = _mm256_loadu_si256( (const __m256i *)( s + 2*o ) );
+    const __m256i l = _mm256_or_si256( c, _mm256_set1_epi8(0x20) );
+    const __m256i digit = _mm256_and_si256( _mm256_cmpgt_epi8( c, _mm256_set1_epi8('0' - 1) ),
+                                            _mm256_cmpgt_epi8( _mm256_set1_epi8('9' + 1), c ) );
+    const __m256i alpha = _mm256_and_si256( _mm256_cmpgt_epi8( l, _mm256_set1_epi8('a' - 1) ),
+                                            _mm256_cmpgt_epi8( _mm256_set1_epi8('f' + 1), l ) );
+    const __m256i nib = _mm256_add_epi8( _mm256_and_si256( c, _mm256_set1_epi8(0x0F) ),
+                                         _mm256_and_si256( alpha, _mm256_set1_epi8(9) ) );
+    /* (16 * high + low nibble) per 16 bit */
+    const __m256i w = _mm256_maddubs_epi16( nib, _mm256_set1_epi16(0x0110) );
+    const __m256i p = _mm256_permute4x64_epi64( _mm256_packus_epi16( w, w ), 0x08 );
+    _mm_storeu_si128( (__m128i *)( bin + o ), _mm256_castsi256_si128( p ) );
+    valid &= (unsigned)_mm256_movemask_epi8( _mm256_or_si256( digit, alpha ) );
+  }
+  if ( o < rawSize ) {
+    if ( rawSize - o > 8 ) {
+      valid &= 0xFFFF0000U | (unsigned)decode16_sse2( s + 2*o, bin + o );
+      o += 8;
+    }
+    valid &= 0xFFFF0000U | (unsigned)decode16_sse2( s + 2*rawSize - 16, bin + rawSize - 8 );
+  }
+  return valid == 0xFFFFFFFFU;
+}
+#endif
+
+typedef int (*DecodeFixedFunc)( const char * s, size_t rawSize, unsigned char * bin );
+
+static
+DecodeFixedFunc selectDecodeFixed( size_t rawSize, int verboseFlag )
+{
+#if defined(SSE2_AVAILABLE)
+  if ( rawSize >= 8 ) {
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports("avx2") ) {
+      if ( verboseFlag )
+        fprintf(stderr, "info: using AVX2 hex decoding\n");
+      return decodeFixedAVX2;
+    }
+    if ( verboseFlag )
+      fprintf(stderr, "info: using SSE2 hex decoding\n");
+    return decodeFixedSSE2;
+  }
+#endif
+  if ( verboseFlag )
+    fprintf(stderr, "info: using scalar hex decoding\n");
+  return decodeFixedScalar;
+}
+
+/*
+ * input is processed in chunks of complete lines: read -> convert -> write.
+ * with multiple threads ('-j'), the main thread reads, worker threads convert
+ * and a writer thread outputs the chunks in input order (reorder buffer).
+ * warnings are collected per chunk, with line numbers relative to the chunk,
+ * and printed by the writer - relative to the global line number.
+ */
+
+enum { CHUNK_FREE = 0, CHUNK_FILLED, CHUNK_CONVERTED };
+
+struct Warning {
+  int lineNo;         /* relative to 1st line of chunk */
+  int bLen;
+  size_t off, len;    /* line inside chunk text */
+};
+
+struct Chunk {
+  char * text;        /* complete lines */
+  size_t textLen;
+  unsigned char * bin;
+  uint64_t * counts;  /* ':COUNT' of each record - for the hot sidecar */
+  size_t numRec;
+  int numLines;
+  struct Warning * warn;
+  size_t numWarn, warnCap;
+  int state;
+};
+
+static size_t rawSize = 0;
+static DecodeFixedFunc decodeFixed = NULL;
+
+/* single pass verification and sidecars - updated by writeChunk() in output order */
+static int checkOrder = 0;
+static int collectMeta = 0;
+static struct SrdsIndexWriter * idxWriter = NULL;
+static struct SrdsHotHeap * hotHeap = NULL;
+static unsigned char * hotRun = NULL;   /* current run of equal records */
+static uint64_t hotRunCount = 0;
+static uint32_t hotRunOcc = 0;
+static unsigned long long numWritten = 0;
+static unsigned char * minRec = NULL;
+static unsigned char * maxRec = NULL;
+static unsigned char * lastRec = NULL;
+static struct SrdsStat telemetry;
+
+/* checkpoints - see srdsckpt.h. written by writeChunk() */
+static char * ckptFn = NULL;
+static double ckptInterval = 0.0;
+static double nextCkpt = 0.0;
+static int outFd = -1;
+static uint64_t inConsumed = 0;   /* input offset behind the last written line */
+
+
+/* value of ':COUNT' behind the hexadecimal digits of line. 1 if missing */
+static
+uint64_t parseCount( const char * s, size_t len )
+{
+  const char * colon = (const char *)memchr( s, ':', len );
+  const char * e = s + len;
+  uint64_t v = 0;
+  if ( !colon )
+    return 1;
+  for ( s = colon + 1; s < e && *s >= '0' && *s <= '9'; ++s )
+    v = v * 10 + (uint64_t)( *s - '0' );
+  return v;
+}
+
+/* equal (adjacent) records are summed up - before being offered to the heap */
+static
+void hotAdd( const unsigned char * rec, uint64_t count )
+{
+  if ( hotRunOcc && !memcmp( hotRun, rec, rawSize ) ) {
+    hotRunCount += count;
+    ++hotRunOcc;
+    return;
+  }
+  if ( hotRunOcc )
+    srdsHotHeapAdd( hotHeap, hotRun, hotRunCount, hotRunOcc );
+  memcpy( hotRun, rec, rawSize );
+  hotRunCount = count;
+  hotRunOcc = 1;
+}
+
+
+/* reads next chunk of complete lines. returns -1 on error */
+static
+int readChunk( FILE * inp, struct Chunk * c, size_t chunkSize, char * carry, size_t * carryLen, int * atEof )
+{
+  size_t fill = *carryLen;
+  size_t len;
+  memcpy( c->text, carry, fill );
+  if ( !*atEof )
+  {
+    fill += fread( c->text + fill, 1, chunkSize - fill, inp );
+    if ( ferror(inp) )
+      return -1;
+    *atEof = feof(inp);
+  }
+
+  len = fill;
+  if ( !*atEof )
+  {
+    /* cut after last newline - if there is none: overlong line */
+    while ( len > 0 && c->text[len - 1] != '\n' )
+      --len;
+    if ( !len )
+      len = fill;
+  }
+  *carryLen = fill - len;
+  memcpy( carry, c->text + len, *carryLen );
+  c->textLen = len;
+  return 0;
+}
+
+
+/* converts all lines of chunk. returns -1 on error */
+static
+int convertChunk( struct Chunk * c, char ** lineBuf, size_t * lineBufLen )
+{
+  const size_t hexLen = 2 * rawSize;
+  size_t pos = 0;
+  c->numRec = 0;
+  c->numLines = 0;
+  c->numWarn = 0;
+
+  while ( pos < c->textLen )
+  {
+    const char * s = c->text + pos;
+    const char * nl = (const char *)memchr( s, '\n', c->textLen - pos );
+    const size_t len = nl ? (size_t)( nl - s ) + 1 : c->textLen - pos;
+    unsigned char * bin = c->bin + c->numRec * rawSize;
+    int bLen;
+
+    ++c->numLines;
+    if ( len >= hexLen
+         && ( len == hexLen || s[hexLen] == ':' || s[hexLen] == '\n' || s[hexLen] == '\r' )
+         && decodeFixed( s, rawSize, bin ) )
+    {
+      bLen = (int)rawSize;  /* fast path */
+    }
+    else
+    {
+      /* irregular line: scalar parser */
+      if ( *lineBufLen <= len )
+      {
+        free(*lineBuf);
+        *lineBufLen = len + 1;
+        *lineBuf = (char *)malloc( *lineBufLen );
+        if (!*lineBuf)
+        {
+          fprintf(stderr, "error allocating line buffer of %u bytes!\n", (unsigned)(*lineBufLen) );
+          *lineBufLen = 0;
+          return -1;
+        }
+      }
+      memcpy( *lineBuf, s, len );
+      (*lineBuf)[len] = 0;
+      bLen = convertHash(*lineBuf, rawSize, bin);
+    }
+
+    if ( ! bLen )
+    {
+      /* empty line */
+    }
+    else if ( bLen < 0 || (size_t)bLen != rawSize )
+    {
+      if ( c->numWarn >= c->warnCap )
+      {
+        c->warnCap = c->warnCap ? 2 * c->warnCap : 64;
+        c->warn = (struct Warning *)realloc( c->warn, c->warnCap * sizeof(struct Warning) );
+        if (!c->warn)
+        {
+          fprintf(stderr, "error allocating warning buffer!\n");
+          return -1;
+        }
+      }
+      c->warn[c->numWarn].lineNo = c->numLines;
+      c->warn[c->numWarn].bLen = bLen;
+      c->warn[c->numWarn].off = pos;
+      c->warn[c->numWarn].len = len;
+      ++c->numWarn;
+    }
+    else
+    {
+      if ( c->counts )
+        c->counts[c->numRec] = parseCount( s, len );
+      ++c->numRec;
+    }
+
+    pos += len;
+  }
+  return 0;
+}
+
+
+/* syncs output and index, then writes position and state into the checkpoint. returns 0 on success */
+static
+int writeCheckpoint( FILE * out, int lineNo, unsigned converted )
+{
+  FILE * f;
+  if ( srdsIoSync( out, outFd ) || ( idxWriter && srdsIoSync( idxWriter->fp, fileno(idxWriter->fp) ) ) )
+    return -1;
+  f = srdsCkptBegin( ckptFn, "hex2rds", (int)rawSize );
+  if ( !f )
+    return -1;
+  fprintf(f, "records=%llu\n", numWritten);
+  fprintf(f, "output=%llu\n", numWritten * rawSize);
+  fprintf(f, "input0=%llu\n", (unsigned long long)inConsumed);
+  fprintf(f, "lines=%d\n", lineNo);
+  fprintf(f, "converted=%u\n", converted);
+  if ( numWritten )
+    srdsCkptPutHex( f, "tail", lastRec, (int)rawSize );
+  if ( numWritten && collectMeta )
+  {
+    srdsCkptPutHex( f, "min", minRec, (int)rawSize );
+    srdsCkptPutHex( f, "max", maxRec, (int)rawSize );
+  }
+  if ( idxWriter )
+    fprintf(f, "indexBucket=%llu\n", (unsigned long long)idxWriter->nextBucket);
+  return srdsCkptCommit( f, ckptFn );
+}
+
+
+/* prints warnings and writes records of a converted chunk. returns -1 on error */
+static
+int writeChunk( FILE * out, const struct Chunk * c, int * lineNo, unsigned * converted )
+{
+  size_t k;
+  for ( k = 0; k < c->numWarn; ++k )
+  {
+    const struct Warning * w = &c->warn[k];
+    fprintf(stderr, "warning: hexadecimal length %d of line %d does not match expected value of %d! skipping line '%.*s'\n",
+            w->bLen, *lineNo + w->lineNo, (int)rawSize, (int)w->len, c->text + w->off);
+  }
+
+  if ( checkOrder || collectMeta || idxWriter || hotHeap || ckptFn )
+  {
+    const unsigned char * prev = numWritten ? lastRec : NULL;
+    for ( k = 0; k < c->numRec; ++k )
+    {
+      const unsigned char * rec = c->bin + k * rawSize;
+      if ( prev && checkOrder && memcmp( prev, rec, rawSize ) > 0 )
+      {
+        fprintf(stderr, "error: data set %llu (from 0) in lines %d .. %d is not in ascending order!\n",
+                numWritten, *lineNo + 1, *lineNo + c->numLines);
+        return -1;
+      }
+      if ( collectMeta && ( !prev || memcmp( rec, minRec, rawSize ) < 0 ) )
+        memcpy( minRec, rec, rawSize );
+      if ( collectMeta && ( !prev || memcmp( rec, maxRec, rawSize ) > 0 ) )
+        memcpy( maxRec, rec, rawSize );
+      if ( idxWriter && srdsIndexAdd( idxWriter, rec, (int)rawSize ) )
+      {
+        fprintf(stderr, "error writing index file!\n");
+        return -1;
+      }
+      if ( hotHeap )
+        hotAdd( rec, c->counts[k] );
+      prev = rec;
+      ++numWritten;
+    }
+    if ( c->numRec )
+      memcpy( lastRec, prev, rawSize );
+  }
+
+  if ( c->numRec )
+  {
+    size_t w = fwrite( c->bin, rawSize, c->numRec, out );
+    if ( w != c->numRec )
+    {
+      int ferr = ferror(out);
+      if (ferr)
+        fprintf(stderr, "error %d writing binary for line %d to output!: %s\n", ferr, *lineNo + c->numLines, strerror(ferr));
+      else
+        fprintf(stderr, "error %d writing binary for line %d to output!\n", ferr, *lineNo + c->numLines);
+      return -1;
+    }
+  }
+  *lineNo += c->numLines;
+  *converted += (unsigned)c->numRec;
+  srdsStatRecords( &telemetry, c->numRec );
+
+  inConsumed += c->textLen;
+  if ( ckptInterval > 0.0 && srdsStatNow() >= nextCkpt )
+  {
+    if ( writeCheckpoint( out, *lineNo, *converted ) )
+    {
+      fprintf(stderr, "error writing checkpoint '%s'!\n", ckptFn);
+      return -1;
+    }
+    nextCkpt = srdsStatNow() + ckptInterval;
+  }
+  return 0;
+}
+
+
+/* shared state of reader, converter and writer threads */
+struct Pipeline {
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  struct Chunk * slots;
+  int numSlots;
+  unsigned long long numFilled;     /* chunks handed over by reader */
+  unsigned long long nextConvert;
+  unsigned long long nextWrite;
+  int readDone;
+  int abort;
+  FILE * out;
+  int lineNo;
+  unsigned converted;
+};
+
+static
+void * converterThread( void * arg )
+{
+  struct Pipeline * p = (struct Pipeline *)arg;
+  char * lineBuf = NULL;
+  size_t lineBufLen = 0;
+
+  pthread_mutex_lock( &p->mutex );
+  while ( 1 )
+  {
+    struct Chunk * c;
+    double t;
+    int r;
+    while ( !p->abort && !p->readDone && p->nextConvert >= p->numFilled )
+      pthread_cond_wait( &p->cond, &p->mutex );
+    if ( p->abort || p->nextConvert >= p->numFilled )
+      break;
+    c = &p->slots[ p->nextConvert++ % p->numSlots ];
+    pthread_mutex_unlock( &p->mutex );
+
+    t = srdsStatNow();
+    r = convertChunk( c, &lineBuf, &lineBufLen );
+    t = srdsStatNow() - t;
+
+    pthread_mutex_lock( &p->mutex );
+    srdsStatAddPhase( &telemetry, SRDSSTAT_PROCESS, t );
+    if ( r )
+      p->abort = 1;
+    c->state = CHUNK_CONVERTED;
+    pthread_cond_broadcast( &p->cond );
+  }
+  pthread_mutex_unlock( &p->mutex );
+  free(lineBuf);
+  return NULL;
+}
+
+static
+void * writerThread( void * arg )
+{
+  struct Pipeline * p = (struct Pipeline *)arg;
+
+  pthread_mutex_lock( &p->mutex );
+  while ( 1 )
+  {
+    struct Chunk * c = &p->slots[ p->nextWrite % p->numSlots ];
+    int r;
+    while ( !p->abort
+            && !( p->nextWrite < p->numFilled && c->state == CHUNK_CONVERTED )
+            && !( p->readDone && p->nextWrite >= p->numFilled ) )
+      pthread_cond_wait( &p->cond, &p->mutex );
+    if ( p->abort || p->nextWrite >= p->numFilled )
+      break;
+    pthread_mutex_unlock( &p->mutex );
+
+    r = writeChunk( p->out, c, &p->lineNo, &p->converted );
+
+    pthread_mutex_lock( &p->mutex );
+    if ( r )
+      p->abort = 1;
+    c->state = CHUNK_FREE;
+    ++p->nextWrite;
+    pthread_cond_broadcast( &p->cond );
+  }
+  pthread_mutex_unlock( &p->mutex );
+  return NULL;
+}
+
+/* writes metadata as 'key=value' lines. returns 0 on success */
+static
+int writeMeta( const char * metaFn, const char * idxFn, int prefixBits, const char * hotFn, uint32_t numHot )
+{
+  char * hex = (char *)malloc( 2 * rawSize + 1 );
+  FILE * f = fopen( metaFn, "w" );
+  int ret = 0;
+  if ( !f || !hex )
+  {
+    free(hex);
+    if (f)
+      fclose(f);
+    return -1;
+  }
+  fprintf(f, "records=%llu\n", numWritten);
+  fprintf(f, "blockSize=%u\n", (unsigned)rawSize);
+  if ( numWritten )
+  {
+    encodeHexScalar( minRec, rawSize, hex, 0 );
+    hex[2 * rawSize] = 0;
+    fprintf(f, "min=%s\n", hex);
+    encodeHexScalar( maxRec, rawSize, hex, 0 );
+    fprintf(f, "max=%s\n", hex);
+  }
+  fprintf(f, "order=%s\n", checkOrder ? "ascending" : "unchecked");
+  if ( idxFn )
+  {
+    fprintf(f, "index=%s\n", idxFn);
+    fprintf(f, "prefixBits=%d\n", prefixBits);
+  }
+  if ( hotFn )
+  {
+    fprintf(f, "hot=%s\n", hotFn);
+    fprintf(f, "hotRecords=%u\n", numHot);
+  }
+  if ( ferror(f) )
+    ret = -1;
+  if ( fclose(f) )
+    ret = -1;
+  free(hex);
+  return ret;
+}
+
 static
 void usage() {
-  fputs("Usage: hex2rds [-h | --help] [-n <rawSize>] [-i <input>] [-o <output>]\n",stderr);
+  fputs("Usage: hex2rds [-h | --help] [-v] [-n <rawSize>] [-B <bufferSize>] [-j <threads>]\n",stderr);
+  fputs("               [-c] [-I <index> [-p <prefixBits>]] [-m <metadata>] [-H <hot> [-t <N>]]\n",stderr);
+  fputs("               [-i <input>] [-o <output>] [-C <sec>] [--resume] [-D <mode>] [-P <sec>] [-J <json>]\n",stderr);
   fputs("  hex2rds converts text files with hexadecimal (hash) codes to raw data set (rds) files\n",stderr);
   fputs("  every input line must have same even length! spaces are ignored.\n",stderr);
   fputs("  -h | --help   print usage\n",stderr);
+  fputs("  -v            verbose output\n",stderr);
   fputs("  -n <rawSize>  tell expected raw length in bytes, e.g. 20 for SHA1\n",stderr);
   fputs("                by default, the 1st line's length will be used\n",stderr);
   fputs("  -B <v>        bufferSize in kBytes\n", stderr);
+  fputs("  -j <v>        number of converter threads. default: 1. 0 for number of online cpus\n", stderr);
   fputs("  -i <input>    use input from file. default: stdin\n",stderr);
   fputs("  -o <output>   output to file. default: stdout\n",stderr);
+  fputs("  -c            check ascending order of converted data sets. stop with error at 1st violation\n",stderr);
+  fputs("  -I <index>    write prefix bucket index (for srdsgrep) to file. implies '-c'\n",stderr);
+  fputs("  -p <bits>     number of key prefix bits for the index. default: 16\n",stderr);
+  fputs("  -m <meta>     write metadata: number of data sets, min and max to file\n",stderr);
+  fputs("  -H <hot>      write hot hash sidecar (for srdsgrep -H): the top N records by ':COUNT' to file\n",stderr);
+  fputs("  -t <N>        number of records in the hot hash sidecar. default: 100000\n",stderr);
+  fputs("  -C <sec>      write checkpoint '<output>.ckpt' every sec seconds. requires '-i' and '-o' - without '-H'\n",stderr);
+  fputs("  --resume      continue an interrupted run - with the same options - from its last checkpoint\n",stderr);
+  fputs("  -D <mode>     I/O mode of regular files: 'cache' (default), 'dontneed' drops the pages behind\n",stderr);
+  fputs("                or 'direct' for O_DIRECT - leaving the page cache to the lookups\n",stderr);
+  fputs("  -P <sec>      print progress to stderr every sec seconds\n",stderr);
+  fputs("  -J <json>     write summary with timing of read/process/write phases as JSON to file. '-' for stderr\n",stderr);
 }
 
 
@@ -127,17 +706,41 @@ int main(int argc, char *argv[])
 {
   FILE * inp = stdin;
   FILE * out = stdout;
-  size_t rawSize = 0;
   int printUsage = 0;
   int ret = 0;  /* default: no error */
   int i = 0;
   unsigned converted = 0;
 
   char * lineBuf = NULL;
-  unsigned char * binBuf = NULL;
+  size_t lineBufLen = 0;
+  char * carry = NULL;
+  size_t carryLen = 0;
+  size_t chunkSize = 0;
+  struct Chunk * slots = NULL;
+  int numSlots = 0;
+  int numThreads = 1;
+  int atEof = 0;
+  int k;
   size_t vBufSize = 0;
-  void * rdBuffer = NULL;
   void * wrBuffer = NULL;
+  int verboseFlag = 0;
+  const char * idxFn = NULL;
+  const char * metaFn = NULL;
+  int prefixBits = 16;
+  struct SrdsIndexWriter idxWriterMem;
+  const char * hotFn = NULL;
+  long topN = 100000;
+  struct SrdsHotHeap hotHeapMem;
+  const char * jsonFn = NULL;
+  double progressInterval = 0.0;
+  const char * outFn = NULL;
+  int resumeFlag = 0;
+  int ioMode = SRDSIO_CACHE;
+  struct SrdsCkpt ckpt;
+  int resumeLines = 0;
+  uint64_t resumeVal = 0;
+
+  memset( &ckpt, 0, sizeof(ckpt) );
 
   while (1)
   {
@@ -161,6 +764,11 @@ int main(int argc, char *argv[])
         vBufSize = (size_t)( atol( argv[i+1] ) * 1024L );
         ++i;
       }
+      else if ( !strcmp(argv[i], "-j") && i+1 < argc )
+      {
+        numThreads = atoi( argv[i+1] );
+        ++i;
+      }
       else if ( !strcmp(argv[i], "-i") && i+1 < argc )
       {
         inp = fopen( argv[i+1], "r" );
@@ -174,15 +782,86 @@ int main(int argc, char *argv[])
       }
       else if ( !strcmp(argv[i], "-o") && i+1 < argc )
       {
-        out = fopen( argv[i+1], "wb" );
-        if (!out)
+        outFn = argv[i+1];
+        ++i;
+      }
+      else if ( !strcmp(argv[i], "-C") && i+1 < argc )
+      {
+        ckptInterval = atof( argv[i+1] );
+        ++i;
+      }
+      else if ( !strcmp(argv[i], "--resume") )
+      {
+        resumeFlag = 1;
+      }
+      else if ( !strcmp(argv[i], "-D") && i+1 < argc )
+      {
+        ioMode = srdsIoParseMode( argv[i+1] );
+        if ( ioMode < 0 )
         {
-          fprintf(stderr, "error: output file '%s' could not be opened!\n", argv[i+1]);
+          fprintf(stderr, "error: unknown I/O mode '%s'!\n", argv[i+1]);
           ret = 10;
           break;
         }
         ++i;
       }
+      else if ( !strcmp(argv[i], "-v") )
+      {
+        ++verboseFlag;
+      }
+      else if ( !strcmp(argv[i], "-c") )
+      {
+        checkOrder = 1;
+      }
+      else if ( !strcmp(argv[i], "-I") && i+1 < argc )
+      {
+        idxFn = argv[i+1];
+        checkOrder = 1;
+        ++i;
+      }
+      else if ( !strcmp(argv[i], "-p") && i+1 < argc )
+      {
+        prefixBits = atoi( argv[i+1] );
+        if ( prefixBits <= 0 || prefixBits > SRDSIDX_MAX_BITS )
+        {
+          fprintf(stderr, "error: prefixBits (value for '-p' = '%s') must be 1 .. %d !\n", argv[i+1], SRDSIDX_MAX_BITS);
+          ret = 10;
+          break;
+        }
+        ++i;
+      }
+      else if ( !strcmp(argv[i], "-m") && i+1 < argc )
+      {
+        metaFn = argv[i+1];
+        collectMeta = 1;
+        ++i;
+      }
+      else if ( !strcmp(argv[i], "-H") && i+1 < argc )
+      {
+        hotFn = argv[i+1];
+        ++i;
+      }
+      else if ( !strcmp(argv[i], "-t") && i+1 < argc )
+      {
+        topN = atol( argv[i+1] );
+        if ( topN <= 0 || topN > 0x7FFFFFFFL )
+        {
+          fprintf(stderr, "error: number of hot records (value for '-t' = '%s') must be > 0 !\n", argv[i+1]);
+          ret = 10;
+          break;
+        }
+        ++i;
+      }
+      else if ( !strcmp(argv[i], "-P") && i+1 < argc )
+      {
+        progressInterval = atof( argv[i+1] );
+        ++i;
+      }
+      else if ( !strcmp(argv[i], "-J") && i+1 < argc )
+      {
+        jsonFn = argv[i+1];
+        ++i;
+      }
       else if ( !strcmp(argv[i], "-h") || !strcmp(argv[i], "--help") )
       {
         printUsage = 1;
@@ -204,110 +883,365 @@ int main(int argc, char *argv[])
       break;
     }
 
-    /* assume up to 3 characters (2 nibbles + 1 space) per byte and some extra spaces */
-    const int bufLen = ( rawSize > 0 ) ? (rawSize * 3 + 16) : 1024;
-    free(lineBuf);
-    lineBuf = malloc( bufLen * sizeof(char) );
-    if (!lineBuf)
+    if ( ( ckptInterval > 0.0 || resumeFlag ) && ( !outFn || inp == stdin || hotFn ) )
     {
-      fprintf(stderr, "error allocating line buffer of %u bytes!\n", (unsigned)(bufLen*sizeof(char)) );
+      fprintf(stderr, "error: checkpoints require input and output files - and no hot sidecar!\n");
       ret = 10;
       break;
     }
-    if ( rawSize > 0 )
+    if ( outFn )
     {
-      free(binBuf);
-      binBuf = (unsigned char*)malloc( rawSize * sizeof(unsigned char) );
-      if (!binBuf)
+      FILE * f = fopen( outFn, resumeFlag ? "r+b" : "wb" );
+      if (!f)
+      {
+        fprintf(stderr, "error: output file '%s' could not be opened!\n", outFn);
+        ret = 10;
+        break;
+      }
+      out = f;
+      outFd = fileno(out);
+    }
+    if ( ckptInterval > 0.0 || resumeFlag )
+    {
+      ckptFn = srdsCkptName( outFn );
+      nextCkpt = srdsStatNow() + ckptInterval;
+    }
+    if ( resumeFlag )
+    {
+      uint64_t v;
+      int64_t outOff;
+      if ( !ckptFn || srdsCkptLoad( &ckpt, ckptFn ) || srdsCkptGetU64( &ckpt, "blockSize", &v ) )
+      {
+        fprintf(stderr, "error: no checkpoint '%s' to resume from!\n", ckptFn ? ckptFn : outFn);
+        ret = 10;
+        break;
+      }
+      if ( rawSize && v != rawSize )
       {
-        fprintf(stderr, "error allocating binary buffer of %u bytes!\n", (unsigned)(rawSize*sizeof(unsigned char)) );
+        fprintf(stderr, "error: rawSize %d does not match checkpoint's blockSize %d!\n", (int)rawSize, (int)v);
         ret = 10;
         break;
       }
+      rawSize = (size_t)v;
+      outOff = srdsCkptResumeOutput( &ckpt, "hex2rds", (int)rawSize, out );
+      if ( outOff < 0 || srdsCkptResumeInput( &ckpt, 0, inp, &inConsumed )
+           || srdsCkptGetU64( &ckpt, "records", &v ) || v * rawSize != (uint64_t)outOff )
+      {
+        fprintf(stderr, "error: can not resume from checkpoint '%s'!\n", ckptFn);
+        ret = 10;
+        break;
+      }
+      numWritten = v;
+      if ( !srdsCkptGetU64( &ckpt, "lines", &v ) )
+        resumeLines = (int)v;
+      if ( !srdsCkptGetU64( &ckpt, "converted", &v ) )
+        converted = (unsigned)v;
+      if ( verboseFlag )
+        fprintf(stderr, "info: resuming after %llu records at input offset %llu\n", numWritten, (unsigned long long)inConsumed);
     }
-    int lineNo = 0;
+
+    initHexValues();
+
+    srdsStatInit( &telemetry, "hex2rds", progressInterval, progressInterval > 0.0 || jsonFn );
+    srdsStatInputSize( &telemetry, inp );
+    inp = srdsIoWrap( &telemetry, inp, 0, ioMode );
+    out = srdsIoWrap( &telemetry, out, 1, ioMode );
 
     {
       size_t bufferSize = vBufSize ? vBufSize : 65536;
-      rdBuffer = malloc( bufferSize );
       wrBuffer = malloc( bufferSize );
-      if (rdBuffer) setbuffer( inp, rdBuffer, bufferSize );
       if (wrBuffer) setbuffer( out, wrBuffer, bufferSize );
+      /* input is read in chunks of complete lines - bypassing stdio line reading */
+      chunkSize = ( bufferSize > CHUNK_MIN_SIZE ) ? bufferSize : CHUNK_MIN_SIZE;
     }
 
-    while ( !ret && !feof(inp))
+    if ( numThreads <= 0 )
+      numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    numSlots = ( numThreads > 1 ) ? 2 * numThreads + 2 : 1;
+    slots = (struct Chunk *)calloc( numSlots, sizeof(struct Chunk) );
+    carry = (char *)malloc( chunkSize );
+    for ( k = 0; slots && carry && k < numSlots; ++k )
     {
-      char * r = fgets(lineBuf, bufLen, inp);
-      if (r)
+      slots[k].text = (char *)malloc( chunkSize );
+      if (!slots[k].text)
+        break;
+    }
+    if ( !slots || !carry || k < numSlots )
+    {
+      fprintf(stderr, "error allocating %d input buffers of %u bytes!\n", numSlots, (unsigned)chunkSize );
+      ret = 10;
+      break;
+    }
+
+    /* read 1st chunk - to get rawSize from 1st line */
+    if ( readChunk( inp, &slots[0], chunkSize, carry, &carryLen, &atEof ) )
+    {
+      fprintf(stderr, "error reading input!\n");
+      ret = 10;
+      break;
+    }
+    if ( !slots[0].textLen && !resumeFlag )
+      break;  /* empty input */
+
+    if ( !rawSize )
+    {
+      const char * nl = (const char *)memchr( slots[0].text, '\n', slots[0].textLen );
+      const size_t len = nl ? (size_t)( nl - slots[0].text ) + 1 : slots[0].textLen;
+      lineBufLen = len + 1;
+      lineBuf = (char *)malloc( lineBufLen );
+      if (!lineBuf)
       {
-        ++lineNo;
+        fprintf(stderr, "error allocating line buffer of %u bytes!\n", (unsigned)lineBufLen );
+        ret = 10;
+        break;
+      }
+      memcpy( lineBuf, slots[0].text, len );
+      lineBuf[len] = 0;
+      const int hlen = hashLen(lineBuf);
+      if (hlen <= 0 || (hlen & 1))
+      {
+        fprintf(stderr, "error: hexadecimal length of 1st line (=%d) must be even!\n", hlen);
+        ret = 10;
+        break;
+      }
+      rawSize = hlen / 2;
+      fprintf(stderr, "info: using rawSize %d from 1st line with hexLen %d\n", (int)rawSize, hlen);
+    }
 
-        if ( !rawSize )
-        {
-          const int len = hashLen(lineBuf);
-          if (len <= 0 || (len & 1))
-          {
-            fprintf(stderr, "error: hexadecimal length of 1st line (=%d) must be even!\n", len);
-            ret = 10;
-            break;
-          }
-          rawSize = len / 2;
-          fprintf(stderr, "info: using rawSize %d from 1st line with hexLen %d\n", (int)rawSize, len);
-          free(binBuf);
-          binBuf = (unsigned char*)malloc( rawSize * sizeof(unsigned char) );
-          if (!binBuf)
-          {
-            fprintf(stderr, "error allocating binary buffer of %u bytes!\n", (unsigned)(rawSize*sizeof(unsigned char)) );
-            ret = 10;
-            break;
-          }
-        }
+    decodeFixed = selectDecodeFixed( rawSize, verboseFlag );
 
-        int bLen = convertHash(lineBuf, rawSize, binBuf);
-        if ( ! bLen )
+    if ( checkOrder || collectMeta || idxFn || hotFn || ckptFn )
+    {
+      lastRec = (unsigned char*)malloc( 4 * rawSize );
+      if (!lastRec)
+      {
+        fprintf(stderr, "error allocating record buffers!\n");
+        ret = 10;
+        break;
+      }
+      minRec = lastRec + rawSize;
+      maxRec = lastRec + 2 * rawSize;
+      hotRun = lastRec + 3 * rawSize;
+    }
+    if ( hotFn )
+    {
+      if ( srdsHotHeapInit( &hotHeapMem, (int)rawSize, (uint32_t)topN ) )
+      {
+        fprintf(stderr, "error allocating hot hash heap for %ld records!\n", topN);
+        ret = 10;
+        break;
+      }
+      hotHeap = &hotHeapMem;
+    }
+    if ( resumeFlag && numWritten
+         && ( srdsCkptGetHex( &ckpt, "tail", lastRec, (int)rawSize )
+              || ( collectMeta && ( srdsCkptGetHex( &ckpt, "min", minRec, (int)rawSize )
+                                    || srdsCkptGetHex( &ckpt, "max", maxRec, (int)rawSize ) ) ) ) )
+    {
+      fprintf(stderr, "error: checkpoint '%s' lacks metadata - resume with the same options!\n", ckptFn);
+      ret = 10;
+      break;
+    }
+    if ( idxFn && resumeFlag )
+    {
+      if ( srdsCkptGetU64( &ckpt, "indexBucket", &resumeVal )
+           || srdsIndexResume( &idxWriterMem, idxFn, prefixBits, (int)rawSize, resumeVal, numWritten ) )
+      {
+        fprintf(stderr, "error: index file '%s' can not be continued from checkpoint!\n", idxFn);
+        ret = 10;
+        break;
+      }
+      idxWriter = &idxWriterMem;
+    }
+    else if ( idxFn )
+    {
+      if ( srdsIndexOpen( &idxWriterMem, idxFn, prefixBits, (int)rawSize ) )
+      {
+        fprintf(stderr, "error: index file '%s' could not be opened!\n", idxFn);
+        ret = 10;
+        break;
+      }
+      idxWriter = &idxWriterMem;
+    }
+
+    /* each record needs 2*rawSize hexadecimal digits */
+    const size_t binSize = ( chunkSize / (2 * rawSize) + 1 ) * rawSize;
+    for ( k = 0; k < numSlots; ++k )
+    {
+      slots[k].bin = (unsigned char*)malloc( binSize * sizeof(unsigned char) );
+      if ( hotHeap )
+        slots[k].counts = (uint64_t *)malloc( ( binSize / rawSize ) * sizeof(uint64_t) );
+      if ( !slots[k].bin || ( hotHeap && !slots[k].counts ) )
+      {
+        fprintf(stderr, "error allocating binary buffer of %u bytes!\n", (unsigned)(binSize*sizeof(unsigned char)) );
+        ret = 10;
+        break;
+      }
+    }
+    if (ret)
+      break;
+
+    if ( numSlots == 1 )
+    {
+      int lineNo = resumeLines;
+      struct Chunk * c = &slots[0];
+      while ( c->textLen )
+      {
+        if ( convertChunk( c, &lineBuf, &lineBufLen ) || writeChunk( out, c, &lineNo, &converted ) )
         {
-          /* empty line */
+          ret = 10;
+          break;
         }
-        else if ( bLen < 0 || (size_t)bLen != rawSize )
+        if ( readChunk( inp, c, chunkSize, carry, &carryLen, &atEof ) )
         {
-          fprintf(stderr, "warning: hexadecimal length %d of line %d does not match expected value of %d! skipping line '%s'\n", bLen, lineNo, (int)rawSize, lineBuf);
+          fprintf(stderr, "error reading input after line %d!\n", lineNo);
+          ret = 10;
+          break;
         }
-        else
+      }
+      break;
+    }
+
+    {
+      struct Pipeline p;
+      pthread_t * threads = (pthread_t *)malloc( (numThreads + 1) * sizeof(pthread_t) );
+      unsigned long long seq;
+
+      memset( &p, 0, sizeof(p) );
+      telemetry.processMeasured = 1;  /* by the converter threads */
+      pthread_mutex_init( &p.mutex, NULL );
+      pthread_cond_init( &p.cond, NULL );
+      p.slots = slots;
+      p.numSlots = numSlots;
+      p.out = out;
+      p.lineNo = resumeLines;
+      p.converted = converted;
+      slots[0].state = CHUNK_FILLED;
+      p.numFilled = 1;
+
+      if ( verboseFlag )
+        fprintf(stderr, "info: converting with %d threads and %d chunks of %u bytes\n", numThreads, numSlots, (unsigned)chunkSize);
+
+      pthread_create( &threads[0], NULL, writerThread, &p );
+      for ( k = 1; k <= numThreads; ++k )
+        pthread_create( &threads[k], NULL, converterThread, &p );
+
+      for ( seq = 1; ; ++seq )
+      {
+        struct Chunk * c = &slots[ seq % numSlots ];
+        int abortFlag;
+        pthread_mutex_lock( &p.mutex );
+        while ( c->state != CHUNK_FREE && !p.abort )
+          pthread_cond_wait( &p.cond, &p.mutex );
+        abortFlag = p.abort;
+        pthread_mutex_unlock( &p.mutex );
+        if ( abortFlag )
+          break;
+
+        if ( readChunk( inp, c, chunkSize, carry, &carryLen, &atEof ) )
         {
-          size_t w = fwrite( binBuf, rawSize, 1, out );
-          if ( w != 1 )
-          {
-            int ferr = ferror(out);
-            if (ferr)
-              fprintf(stderr, "error %d writing binary for line %d to output!: %s\n", ferr, lineNo, strerror(ferr));
-            else
-              fprintf(stderr, "error %d writing binary for line %d to output!\n", ferr, lineNo);
-            ret = 10;
-            break;
-          }
-          ++converted;
+          fprintf(stderr, "error reading input!\n");
+          pthread_mutex_lock( &p.mutex );
+          p.abort = 1;
+          pthread_mutex_unlock( &p.mutex );
+          break;
         }
+        if ( !c->textLen )
+          break;
+
+        pthread_mutex_lock( &p.mutex );
+        c->state = CHUNK_FILLED;
+        ++p.numFilled;
+        pthread_cond_broadcast( &p.cond );
+        pthread_mutex_unlock( &p.mutex );
       }
+
+      pthread_mutex_lock( &p.mutex );
+      p.readDone = 1;
+      pthread_cond_broadcast( &p.cond );
+      pthread_mutex_unlock( &p.mutex );
+
+      for ( k = 0; k <= numThreads; ++k )
+        pthread_join( threads[k], NULL );
+      free( threads );
+
+      if ( p.abort )
+        ret = 10;
+      converted = p.converted;
+      pthread_cond_destroy( &p.cond );
+      pthread_mutex_destroy( &p.mutex );
     }
 
     break;
   }
 
   free(lineBuf);
-  free(binBuf);
+  free(carry);
+  for ( k = 0; slots && k < numSlots; ++k )
+  {
+    free(slots[k].text);
+    free(slots[k].bin);
+    free(slots[k].counts);
+    free(slots[k].warn);
+  }
+  free(slots);
+
+  if ( idxWriter )
+  {
+    if ( srdsIndexClose( idxWriter ) && !ret )
+    {
+      fprintf(stderr, "error writing index file '%s'!\n", idxFn);
+      ret = 10;
+    }
+    if ( ret && !ckptFn )
+      remove( idxFn );  /* don't leave an index of an unverified database - except for resuming */
+  }
+  if ( hotHeap )
+  {
+    if ( hotRunOcc )
+      srdsHotHeapAdd( hotHeap, hotRun, hotRunCount, hotRunOcc );
+    if ( !ret && srdsHotWrite( hotHeap, hotFn, numWritten ) )
+    {
+      fprintf(stderr, "error writing hot hash sidecar '%s'!\n", hotFn);
+      ret = 10;
+    }
+    else if ( !ret && verboseFlag )
+      fprintf(stderr, "info: wrote %u hot records to '%s'\n", hotHeap->n, hotFn);
+  }
+  if ( metaFn && !ret && writeMeta( metaFn, idxFn, prefixBits, hotFn, hotHeap ? hotHeap->n : 0 ) )
+  {
+    fprintf(stderr, "error writing metadata file '%s'!\n", metaFn);
+    ret = 10;
+  }
+  if ( hotHeap )
+    srdsHotHeapFree( hotHeap );
+  free(lastRec);
 
   if ( converted )
     fprintf(stderr, "successfully converted %u hexadecimal lines.\n", converted);
 
   if ( out != stdout ) {
-    fclose(out);
+    if ( fclose(out) && !ret )
+    {
+      fprintf(stderr, "error writing to output file '%s'!\n", outFn);
+      ret = 10;
+    }
     free( wrBuffer );
   }
-  if ( inp != stdin ) {
+  if ( inp != stdin )
     fclose(inp);
-    free( rdBuffer );
-  }
 
+  /* the checkpoint is kept for '--resume' - only a complete run removes it */
+  if ( ckptFn && !ret )
+    remove( ckptFn );
+  free( ckptFn );
+  srdsCkptFree( &ckpt );
+
+  if ( srdsStatSummary( &telemetry, jsonFn, ret ) && !ret )
+  {
+    fprintf(stderr, "error writing summary file '%s'!\n", jsonFn);
+    ret = 10;
+  }
   return ret;
 }
 
@@ -0,0 +1,104 @@
+/*
+ * hexcodec.h
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * encoding of raw bytes to hexadecimal text - shared by the rds tools.
+ * the SSE2 / AVX2 kernels are selected at runtime with selectEncodeHex().
+ *
+ * Author:  Hayati Ayguen
+ */
+
+#ifndef HEXCODEC_H
+#define HEXCODEC_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/* converts n bytes from bin into 2*n hexadecimal characters at txt - without termination */
+typedef void (*EncodeHexFunc)( const unsigned char * bin, size_t n, char * txt, int lowerCase );
+
+static const char hexDigitsUpper[] = "0123456789ABCDEF";
+static const char hexDigitsLower[] = "0123456789abcdef";
+
+static inline
+void encodeHexScalar( const unsigned char * bin, size_t n, char * txt, int lowerCase )
+{
+  const char * digits = lowerCase ? hexDigitsLower : hexDigitsUpper;
+  size_t k;
+  for ( k = 0; k < n; ++k ) {
+    txt[2*k]   = digits[ bin[k] >> 4 ];
+    txt[2*k+1] = digits[ bin[k] & 15 ];
+  }
+}
+
+#if defined(__GNUC__) && defined(__SSE2__) && ( defined(__x86_64__) || defined(__i386__) )
+#define HEXCODEC_SSE2  1
+#include <x86intrin.h>
+
+/* nibbles 0..15 to ASCII: '0' + v, plus alphaOff for v > 9 */
+static inline
+__m128i nibblesToHex_sse2( __m128i v, __m128i alphaOff )
+{
+  const __m128i gt9 = _mm_cmpgt_epi8( v, _mm_set1_epi8(9) );
+  return _mm_add_epi8( _mm_add_epi8( v, _mm_set1_epi8('0') ), _mm_and_si128( gt9, alphaOff ) );
+}
+
+static inline
+void encodeHexSSE2( const unsigned char * bin, size_t n, char * txt, int lowerCase )
+{
+  const __m128i alphaOff = _mm_set1_epi8( lowerCase ? ('a' - '0' - 10) : ('A' - '0' - 10) );
+  const __m128i mask = _mm_set1_epi8(0x0F);
+  size_t k;
+  for ( k = 0; k + 8 <= n; k += 8 ) {
+    const __m128i b = _mm_loadl_epi64( (const __m128i *)( bin + k ) );
+    const __m128i hi = _mm_and_si128( _mm_srli_epi16( b, 4 ), mask );
+    const __m128i lo = _mm_and_si128( b, mask );
+    _mm_storeu_si128( (__m128i *)( txt + 2*k ), nibblesToHex_sse2( _mm_unpacklo_epi8( hi, lo ), alphaOff ) );
+  }
+  encodeHexScalar( bin + k, n - k, txt + 2*k, lowerCase );
+}
+
+__attribute__((target("avx2")))
+static void encodeHexAVX2( const unsigned char * bin, size_t n, char * txt, int lowerCase )
+{
+  const __m256i alphaOff = _mm256_set1_epi8( lowerCase ? ('a' - '0' - 10) : ('A' - '0' - 10) );
+  const __m256i mask = _mm256_set1_epi8(0x0F);
+  size_t k;
+  for ( k = 0; k + 16 <= n; k += 16 ) {
+    /* bytes 0..7 in lower, 8..15 in upper lane - for the in-lane unpack */
+    const __m256i b = _mm256_permute4x64_epi64(
+                        _mm256_castsi128_si256( _mm_loadu_si128( (const __m128i *)( bin + k ) ) ), 0x50 );
+    const __m256i hi = _mm256_and_si256( _mm256_srli_epi16( b, 4 ), mask );
+    const __m256i lo = _mm256_and_si256( b, mask );
+    const __m256i v = _mm256_unpacklo_epi8( hi, lo );
+    const __m256i gt9 = _mm256_cmpgt_epi8( v, _mm256_set1_epi8(9) );
+    const __m256i c = _mm256_add_epi8( _mm256_add_epi8( v, _mm256_set1_epi8('0') ), _mm256_and_si256( gt9, alphaOff ) );
+    _mm256_storeu_si256( (__m256i *)( txt + 2*k ), c );
+  }
+  encodeHexSSE2( bin + k, n - k, txt + 2*k, lowerCase );
+}
+#endif
+
+static
+EncodeHexFunc selectEncodeHex( int verboseFlag )
+{
+#if defined(HEXCODEC_SSE2)
+  __builtin_cpu_init();
+  if ( __builtin_cpu_supports("avx2") ) {
+    if ( verboseFlag )
+      fprintf(stderr, "info: using AVX2 hex encoding\n");
+    return encodeHexAVX2;
+  }
+  if ( verboseFlag )
+    fprintf(stderr, "info: using SSE2 hex encoding\n");
+  return encodeHexSSE2;
+#else
+  if ( verboseFlag )
+    fprintf(stderr, "info: using scalar hex encoding\n");
+  return encodeHexScalar;
+#endif
+}
+
+#endif /* HEXCODEC_H */
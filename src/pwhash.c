@@ -0,0 +1,453 @@
+/*
+ * pwhash (password hash)
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * pwhash calculates the hashes of passwords - as used by the HIBP databases:
+ *   SHA-1 of the password bytes (default) - as 'echo -n password | sha1sum'
+ *   NTLM = MD4 of the UTF-16LE encoded password (option -N)
+ * output is one hexadecimal hash per line, for srdsgrep -x or srdsgrep -x -f.
+ *
+ * passwords are taken from the command line - or one per line from input (bulk mode).
+ * in bulk mode, NTLM hashes of passwords up to 27 characters (a single MD4 block)
+ * are calculated multi-buffer: 4, 8 or 16 passwords in parallel with SSE2, AVX2 or AVX-512,
+ * selected at runtime.
+ *
+ * Usage: see below at usage()
+ *
+ * Author:  Hayati Ayguen
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include "hexcodec.h"
+
+#define MAX_LANES   16
+#define MAX_PWLEN   4096   /* maximum bytes per password line */
+
+
+/* MD4 - RFC 1320. the same code for scalar and GCC vector types */
+
+#define MD4_F(x, y, z)  ( ( (x) & (y) ) | ( ~(x) & (z) ) )
+#define MD4_G(x, y, z)  ( ( (x) & (y) ) | ( (x) & (z) ) | ( (y) & (z) ) )
+#define MD4_H(x, y, z)  ( (x) ^ (y) ^ (z) )
+#define ROTL32(v, s)    ( ( (v) << (s) ) | ( (v) >> ( 32 - (s) ) ) )
+#define MD4_STEP(f, a, b, c, d, x, k, s)  a = ROTL32( a + f(b, c, d) + (x) + (k), s )
+
+#define MD4_COMPRESS(T, st, X) do {                                      \
+    T a = st[0], b = st[1], c = st[2], d = st[3];                        \
+    int r;                                                               \
+    for ( r = 0; r < 16; r += 4 ) {                                      \
+      MD4_STEP( MD4_F, a, b, c, d, X[r+0], 0, 3 );                       \
+      MD4_STEP( MD4_F, d, a, b, c, X[r+1], 0, 7 );                       \
+      MD4_STEP( MD4_F, c, d, a, b, X[r+2], 0, 11 );                      \
+      MD4_STEP( MD4_F, b, c, d, a, X[r+3], 0, 19 );                      \
+    }                                                                    \
+    for ( r = 0; r < 4; ++r ) {                                          \
+      MD4_STEP( MD4_G, a, b, c, d, X[r+0],  0x5A827999, 3 );             \
+      MD4_STEP( MD4_G, d, a, b, c, X[r+4],  0x5A827999, 5 );             \
+      MD4_STEP( MD4_G, c, d, a, b, X[r+8],  0x5A827999, 9 );             \
+      MD4_STEP( MD4_G, b, c, d, a, X[r+12], 0x5A827999, 13 );            \
+    }                                                                    \
+    for ( r = 0; r < 4; ++r ) {                                          \
+      static const int o[4] = { 0, 2, 1, 3 };                            \
+      MD4_STEP( MD4_H, a, b, c, d, X[o[r]+0],  0x6ED9EBA1, 3 );          \
+      MD4_STEP( MD4_H, d, a, b, c, X[o[r]+8],  0x6ED9EBA1, 9 );          \
+      MD4_STEP( MD4_H, c, d, a, b, X[o[r]+4],  0x6ED9EBA1, 11 );         \
+      MD4_STEP( MD4_H, b, c, d, a, X[o[r]+12], 0x6ED9EBA1, 15 );         \
+    }                                                                    \
+    st[0] += a;  st[1] += b;  st[2] += c;  st[3] += d;                   \
+  } while (0)
+
+static const uint32_t md4Init[4] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476 };
+
+static inline
+uint32_t getLE32w( const unsigned char * p )
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* MD4 of any length message */
+static
+void md4( const unsigned char * msg, size_t len, unsigned char * digest )
+{
+  uint32_t st[4], X[16];
+  unsigned char blk[64];
+  size_t off = 0;
+  int k, last = 0;
+  memcpy( st, md4Init, sizeof(st) );
+  while ( !last ) {
+    if ( off + 64 <= len )
+      memcpy( blk, msg + off, 64 );
+    else {
+      /* final block(s): 0x80 after the message, length in bits at the end */
+      memset( blk, 0, 64 );
+      if ( off <= len ) {
+        memcpy( blk, msg + off, len - off );
+        blk[len - off] = 0x80;
+      }
+      if ( off > len || len - off < 56 ) {
+        for ( k = 0; k < 8; ++k )
+          blk[56 + k] = (unsigned char)( ( (uint64_t)len * 8 ) >> ( 8 * k ) );
+        last = 1;
+      }
+    }
+    off += 64;
+    for ( k = 0; k < 16; ++k )
+      X[k] = getLE32w( blk + 4 * k );
+    MD4_COMPRESS( uint32_t, st, X );
+  }
+  for ( k = 0; k < 16; ++k )
+    digest[k] = (unsigned char)( st[k / 4] >> ( 8 * ( k % 4 ) ) );
+}
+
+
+/*
+ * multi-buffer MD4 of single block messages: X[16][lanes] holds
+ * the padded blocks transposed - word k of lane j at X[k * lanes + j].
+ * digest words are written to D[4 * lanes] in the same layout.
+ */
+typedef void (*MD4MultiFunc)( const uint32_t * X, uint32_t * D );
+
+#define MD4_MULTI(NAME, LANES)                                           \
+  static void NAME( const uint32_t * X, uint32_t * D ) {                 \
+    typedef uint32_t V __attribute__((vector_size(4 * LANES)));          \
+    V W[16], st[4];                                                      \
+    int k;                                                               \
+    for ( k = 0; k < 16; ++k )                                           \
+      memcpy( &W[k], X + k * LANES, sizeof(V) );                         \
+    for ( k = 0; k < 4; ++k )                                            \
+      st[k] = (V){ 0 } + md4Init[k];                                     \
+    MD4_COMPRESS( V, st, W );                                            \
+    for ( k = 0; k < 4; ++k )                                            \
+      memcpy( D + k * LANES, &st[k], sizeof(V) );                        \
+  }
+
+MD4_MULTI( md4Multi4, 4 )
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+  #define MULTI_DISPATCH  1
+__attribute__((target("avx2")))
+MD4_MULTI( md4Multi8, 8 )
+__attribute__((target("avx512f")))
+MD4_MULTI( md4Multi16, 16 )
+#endif
+
+/* returns number of lanes */
+static
+int selectMD4Multi( MD4MultiFunc * f, int verboseFlag )
+{
+  *f = md4Multi4;
+#if defined(MULTI_DISPATCH)
+  __builtin_cpu_init();
+  if ( __builtin_cpu_supports("avx512f") ) {
+    *f = md4Multi16;
+    if (verboseFlag >= 2)
+      fprintf(stderr, "using AVX-512 for multi-buffer MD4\n");
+    return 16;
+  }
+  if ( __builtin_cpu_supports("avx2") ) {
+    *f = md4Multi8;
+    if (verboseFlag >= 2)
+      fprintf(stderr, "using AVX2 for multi-buffer MD4\n");
+    return 8;
+  }
+#endif
+  if (verboseFlag >= 2)
+    fprintf(stderr, "using 4 lanes for multi-buffer MD4\n");
+  return 4;
+}
+
+
+/* SHA-1 - RFC 3174 */
+
+static inline
+uint32_t getBE32w( const unsigned char * p )
+{
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static
+void sha1Block( uint32_t * h, const unsigned char * blk )
+{
+  uint32_t w[80], a, b, c, d, e, t;
+  int k;
+  for ( k = 0; k < 16; ++k )
+    w[k] = getBE32w( blk + 4 * k );
+  for ( ; k < 80; ++k )
+    w[k] = ROTL32( w[k-3] ^ w[k-8] ^ w[k-14] ^ w[k-16], 1 );
+  a = h[0];  b = h[1];  c = h[2];  d = h[3];  e = h[4];
+  for ( k = 0; k < 80; ++k ) {
+    if ( k < 20 )       t = ( ( b & c ) | ( ~b & d ) ) + 0x5A827999;
+    else if ( k < 40 )  t = ( b ^ c ^ d ) + 0x6ED9EBA1;
+    else if ( k < 60 )  t = ( ( b & c ) | ( b & d ) | ( c & d ) ) + 0x8F1BBCDC;
+    else                t = ( b ^ c ^ d ) + 0xCA62C1D6;
+    t += ROTL32( a, 5 ) + e + w[k];
+    e = d;  d = c;  c = ROTL32( b, 30 );  b = a;  a = t;
+  }
+  h[0] += a;  h[1] += b;  h[2] += c;  h[3] += d;  h[4] += e;
+}
+
+static
+void sha1( const unsigned char * msg, size_t len, unsigned char * digest )
+{
+  uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+  unsigned char blk[128];
+  size_t off, n;
+  int k;
+  for ( off = 0; off + 64 <= len; off += 64 )
+    sha1Block( h, msg + off );
+  n = len - off;
+  memset( blk, 0, sizeof(blk) );
+  memcpy( blk, msg + off, n );
+  blk[n] = 0x80;
+  n = ( n < 56 ) ? 64 : 128;
+  for ( k = 0; k < 8; ++k )
+    blk[n - 1 - k] = (unsigned char)( ( (uint64_t)len * 8 ) >> ( 8 * k ) );
+  sha1Block( h, blk );
+  if ( n == 128 )
+    sha1Block( h, blk + 64 );
+  for ( k = 0; k < 20; ++k )
+    digest[k] = (unsigned char)( h[k / 4] >> ( 24 - 8 * ( k % 4 ) ) );
+}
+
+
+/*
+ * UTF-8 to UTF-16LE - as Windows does for the NT hash.
+ * invalid UTF-8 sequences are taken bytewise as Latin-1.
+ * returns number of output bytes
+ */
+static
+size_t utf8ToUtf16LE( const unsigned char * s, size_t len, unsigned char * out )
+{
+  size_t i = 0, o = 0;
+  while ( i < len ) {
+    uint32_t c = s[i];
+    int n = 0, k;
+    if ( c >= 0xF0 && c < 0xF5 )       { n = 3; c &= 0x07; }
+    else if ( c >= 0xE0 && c < 0xF0 )  { n = 2; c &= 0x0F; }
+    else if ( c >= 0xC2 && c < 0xE0 )  { n = 1; c &= 0x1F; }
+    for ( k = 1; k <= n; ++k ) {
+      if ( i + k >= len || ( s[i + k] & 0xC0 ) != 0x80 )
+        break;
+      c = ( c << 6 ) | ( s[i + k] & 0x3F );
+    }
+    if ( k <= n || ( n == 2 && ( c < 0x800 || ( c >= 0xD800 && c < 0xE000 ) ) )
+         || ( n == 3 && ( c < 0x10000 || c > 0x10FFFF ) ) ) {
+      c = s[i];   /* invalid: Latin-1 */
+      n = 0;
+    }
+    i += n + 1;
+    if ( c >= 0x10000 ) {
+      const uint32_t hi = 0xD800 + ( ( c - 0x10000 ) >> 10 );
+      const uint32_t lo = 0xDC00 + ( ( c - 0x10000 ) & 0x3FF );
+      out[o++] = (unsigned char)hi;  out[o++] = (unsigned char)( hi >> 8 );
+      out[o++] = (unsigned char)lo;  out[o++] = (unsigned char)( lo >> 8 );
+    }
+    else {
+      out[o++] = (unsigned char)c;  out[o++] = (unsigned char)( c >> 8 );
+    }
+  }
+  return o;
+}
+
+
+static int ntlmFlag = 0;
+static int lowerFlag = 0;
+static EncodeHexFunc encodeHex = NULL;
+
+static
+int writeHash( FILE * out, const unsigned char * digest )
+{
+  char txt[41];
+  const int len = ntlmFlag ? 16 : 20;
+  encodeHex( digest, len, txt, lowerFlag );
+  txt[2 * len] = '\n';
+  return fwrite( txt, 2 * len + 1, 1, out ) == 1 ? 0 : -1;
+}
+
+static
+int hashOne( FILE * out, const unsigned char * pw, size_t len )
+{
+  unsigned char digest[20];
+  if ( ntlmFlag ) {
+    unsigned char * u = (unsigned char *)malloc( 4 * len + 1 );
+    if ( !u )
+      return -1;
+    md4( u, utf8ToUtf16LE( pw, len, u ), digest );
+    free( u );
+  }
+  else
+    sha1( pw, len, digest );
+  return writeHash( out, digest );
+}
+
+
+/* multi-buffer NTLM of up to 'lanes' queued single block passwords */
+struct Batch {
+  int lanes;
+  int num;
+  MD4MultiFunc md4Multi;
+  uint32_t X[16 * MAX_LANES];
+  uint32_t D[4 * MAX_LANES];
+};
+
+static
+int flushBatch( FILE * out, struct Batch * b )
+{
+  unsigned char digest[16];
+  int j, k;
+  if ( !b->num )
+    return 0;
+  b->md4Multi( b->X, b->D );
+  for ( j = 0; j < b->num; ++j ) {
+    for ( k = 0; k < 16; ++k )
+      digest[k] = (unsigned char)( b->D[ ( k / 4 ) * b->lanes + j ] >> ( 8 * ( k % 4 ) ) );
+    if ( writeHash( out, digest ) )
+      return -1;
+  }
+  b->num = 0;
+  return 0;
+}
+
+/* UTF-16LE password u with ulen <= 55 bytes into next lane */
+static
+void addToBatch( struct Batch * b, const unsigned char * u, size_t ulen )
+{
+  unsigned char blk[64];
+  int k;
+  memset( blk, 0, sizeof(blk) );
+  memcpy( blk, u, ulen );
+  blk[ulen] = 0x80;
+  blk[56] = (unsigned char)( ulen * 8 );
+  blk[57] = (unsigned char)( ( ulen * 8 ) >> 8 );
+  for ( k = 0; k < 16; ++k )
+    b->X[ k * b->lanes + b->num ] = getLE32w( blk + 4 * k );
+  ++b->num;
+}
+
+
+static
+void usage() {
+  fputs("Usage: pwhash [-h][-v][-N][-x][-i <input>][-o <output>] [password ...]\n", stderr);
+  fputs("  pwhash calculates SHA-1 or NTLM hashes of passwords as hexadecimal lines, e.g. for srdsgrep -x -f\n", stderr);
+  fputs("  -h     print usage\n", stderr);
+  fputs("  -v     verbose output\n", stderr);
+  fputs("  -N     NTLM hash: MD4 of UTF-16LE encoded password. default: SHA-1\n", stderr);
+  fputs("  -x     lower case hexadecimal. default: upper case - as HIBP\n", stderr);
+  fputs("  -i <f> read passwords - one per line - from file. '-' for stdin\n", stderr);
+  fputs("  -o <f> output to file. default: stdout\n", stderr);
+  fputs("  password  hash given password(s). without any password, stdin is read\n", stderr);
+}
+
+
+int main(int argc, char *argv[])
+{
+  FILE * inp = NULL;
+  FILE * out = stdout;
+  const char * outfn = NULL;
+  int helpFlag = 0, verboseFlag = 0;
+  int optFlag, ret = 0;
+  unsigned long long numHashed = 0;
+  char line[MAX_PWLEN + 2];
+  unsigned char u[4 * MAX_PWLEN];
+  struct Batch batch;
+  extern int optind;
+
+  /* parse command line options */
+  while ((optFlag = getopt(argc, argv, "hvNxi:o:")) > 0 && optFlag != '?') {
+    switch(optFlag) {
+    case 'h': ++helpFlag; break;
+    case 'v': ++verboseFlag; break;
+    case 'N': ++ntlmFlag; break;
+    case 'x': ++lowerFlag; break;
+    case 'i':
+      inp = strcmp(optarg, "-") ? fopen(optarg, "rb") : stdin;
+      if (!inp) {
+        fprintf(stderr, "error opening input file '%s'\n", optarg);
+        return 10;
+      }
+      break;
+    case 'o':
+      outfn = optarg;
+      break;
+    }
+  }
+  if (optFlag == '?' || helpFlag) {
+    usage();
+    exit(2);
+  }
+  if ( !inp && optind >= argc )
+    inp = stdin;
+
+  if ( outfn )
+  {
+    out = fopen(outfn, "wb");
+    if (!out) {
+      fprintf(stderr, "error opening output file '%s'\n", outfn);
+      return 10;
+    }
+  }
+
+  encodeHex = selectEncodeHex( verboseFlag >= 2 );
+  memset( &batch, 0, sizeof(batch) );
+  batch.lanes = selectMD4Multi( &batch.md4Multi, verboseFlag );
+
+  for ( ; optind < argc && !ret; ++optind, ++numHashed )
+    if ( hashOne( out, (const unsigned char *)argv[optind], strlen(argv[optind]) ) )
+      ret = 8;
+
+  while ( inp && !ret && fgets( line, sizeof(line), inp ) ) {
+    size_t len = strlen( line );
+    if ( len && line[len - 1] == '\n' )
+      line[--len] = 0;
+    else if ( len > MAX_PWLEN ) {
+      fprintf(stderr, "error: password line %llu is longer than %d bytes!\n", numHashed + 1, MAX_PWLEN);
+      ret = 9;
+      break;
+    }
+    if ( len && line[len - 1] == '\r' )
+      line[--len] = 0;
+    ++numHashed;
+
+    if ( ntlmFlag ) {
+      const size_t ulen = utf8ToUtf16LE( (const unsigned char *)line, len, u );
+      if ( ulen <= 55 ) {
+        addToBatch( &batch, u, ulen );
+        if ( batch.num == batch.lanes && flushBatch( out, &batch ) )
+          ret = 8;
+        continue;
+      }
+      /* keep output order */
+      if ( flushBatch( out, &batch ) )
+        ret = 8;
+    }
+    if ( !ret && hashOne( out, (const unsigned char *)line, len ) )
+      ret = 8;
+  }
+  if ( !ret && flushBatch( out, &batch ) )
+    ret = 8;
+  if ( ret == 8 )
+    fprintf(stderr, "error writing to output!\n");
+
+  if ( !ret && inp && ferror(inp) ) {
+    fprintf(stderr, "error reading from input!\n");
+    ret = 9;
+  }
+
+  if (verboseFlag)
+    fprintf(stderr, "hashed %llu passwords with %s.\n", numHashed, ntlmFlag ? "NTLM" : "SHA-1");
+
+  if ( out != stdout && fclose(out) && !ret )
+    ret = 8;
+  if ( inp && inp != stdin )
+    fclose(inp);
+
+  return ret;
+}
@@ -0,0 +1,240 @@
+/*
+ * rds2hex
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * rds2hex converts raw data set (rds) files to text files with hexadecimal (hash) lines,
+ * the reverse of hex2rds.
+ * optionally, bytes following the hash are formatted as decimal ':COUNT' - as in the HIBP text files.
+ *
+ * Usage: see below at usage()
+ *
+ * Author:  Hayati Ayguen
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include "hexcodec.h"
+
+#define REC_BATCH  16384    /* number of records per fread() / fwrite() */
+
+
+/* parses separator with escapes \n, \r, \t, \0 and \\ - returns length */
+static
+size_t parseSeparator( const char * s, char * sep )
+{
+  size_t len = 0;
+  for ( ; *s; ++s ) {
+    if ( *s == '\\' && s[1] ) {
+      ++s;
+      switch ( *s ) {
+      case 'n': sep[len++] = '\n'; break;
+      case 'r': sep[len++] = '\r'; break;
+      case 't': sep[len++] = '\t'; break;
+      case '0': sep[len++] = '\0'; break;
+      default:  sep[len++] = *s; break;
+      }
+    }
+    else
+      sep[len++] = *s;
+  }
+  return len;
+}
+
+
+/* writes ':' and decimal number of big endian count bytes. returns number of characters */
+static inline
+size_t formatCount( const unsigned char * b, int countLen, char * txt )
+{
+  char tmp[24];
+  uint64_t v = 0;
+  size_t n = 0, k = 0;
+  int i;
+  for ( i = 0; i < countLen; ++i )
+    v = ( v << 8 ) | b[i];
+  do {
+    tmp[n++] = (char)( '0' + ( v % 10 ) );
+    v /= 10;
+  } while ( v );
+  txt[k++] = ':';
+  while ( n )
+    txt[k++] = tmp[--n];
+  return k;
+}
+
+
+static
+void usage() {
+  fputs("Usage: rds2hex [-h][-v][-x][-c][-l <blockLength>][-n <hashLength>][-s <separator>][-B <bufferSize>] [-i <input>] [-o <output>]\n",stderr);
+  fputs("  rds2hex converts raw data set (rds) files to text files with hexadecimal (hash) codes\n",stderr);
+  fputs("  -h     print usage\n",stderr);
+  fputs("  -v     verbose output\n",stderr);
+  fputs("  -x     lower case hexadecimal. default: upper case - as HIBP\n",stderr);
+  fputs("  -c     append remaining bytes of block after hash as (big endian) decimal ':COUNT'\n",stderr);
+  fputs("  -l <v> length of each raw data set block in bytes. default: 20\n",stderr);
+  fputs("  -n <v> length of hash in bytes, converted to hexadecimal. default: blockLength\n",stderr);
+  fputs("  -s <s> separator after each record. escapes \\n \\r \\t \\0 are allowed. default: '\\n'\n",stderr);
+  fputs("  -B <v> bufferSize in kBytes\n", stderr);
+  fputs("  -i <f> input from file. default: stdin\n",stderr);
+  fputs("  -o <f> output to file. default: stdout\n",stderr);
+}
+
+
+int main(int argc, char *argv[])
+{
+  FILE * inp = stdin;
+  FILE * out = stdout;
+  const char * outfn = NULL;
+  int blockSize = 20;
+  int hashSize = -1;
+  int countLen = 0;
+  int countFlag = 0, lowerFlag = 0, helpFlag = 0, verboseFlag = 0;
+  int optFlag, ret = 0;
+  char sep[256] = "\n";
+  size_t sepLen = 1;
+  size_t vBufSize = 0;
+  size_t recTxtMax, rd, k;
+  unsigned long long converted = 0;
+  unsigned char * binBuf = NULL;
+  char * txtBuf = NULL;
+  void * rdBuffer = NULL;
+  void * wrBuffer = NULL;
+  EncodeHexFunc encodeHex;
+  extern int optind;
+
+  /* parse command line options */
+  while ((optFlag = getopt(argc, argv, "hvxcl:n:s:B:i:o:")) > 0 && optFlag != '?') {
+    switch(optFlag) {
+    case 'h': ++helpFlag; break;
+    case 'v': ++verboseFlag; break;
+    case 'x': ++lowerFlag; break;
+    case 'c': ++countFlag; break;
+    case 'l': blockSize = atoi(optarg); break;
+    case 'n': hashSize = atoi(optarg); break;
+    case 's':
+      if ( strlen(optarg) >= sizeof(sep) ) {
+        fprintf(stderr, "error: separator is too long!\n");
+        return 10;
+      }
+      sepLen = parseSeparator( optarg, sep );
+      break;
+    case 'B': vBufSize = (size_t)( atol(optarg) * 1024 ); break;
+    case 'i':
+      inp = fopen(optarg, "rb");
+      if (!inp) {
+        fprintf(stderr, "error opening input file '%s'\n", optarg);
+        return 10;
+      }
+      break;
+    case 'o':
+      outfn = optarg;
+      break;
+    }
+  }
+  if (optFlag == '?' || helpFlag) {
+    usage();
+    exit(2);
+  }
+
+  if ( hashSize < 0 )
+    hashSize = blockSize;
+  if ( blockSize <= 0 || hashSize <= 0 || hashSize > blockSize ) {
+    fprintf(stderr, "error: blockSize %d and hashLength %d must be > 0 and hashLength <= blockSize!\n", blockSize, hashSize);
+    return 10;
+  }
+  if ( countFlag ) {
+    countLen = blockSize - hashSize;
+    if ( countLen <= 0 || countLen > 8 ) {
+      fprintf(stderr, "error: count length %d (= blockSize - hashLength) must be 1 .. 8 bytes for option '-c'!\n", countLen);
+      return 10;
+    }
+  }
+
+  if ( outfn )
+  {
+    out = fopen(outfn, "wb");
+    if (!out) {
+      fprintf(stderr, "error opening output file '%s'\n", outfn);
+      return 10;
+    }
+  }
+
+  if (verboseFlag)
+    fprintf(stderr, "using blockSize %d, hashLength %d, count length %d\n", blockSize, hashSize, countLen);
+
+  encodeHex = selectEncodeHex( verboseFlag );
+
+  {
+    size_t bufferSize = vBufSize ? vBufSize : 65536;
+    rdBuffer = malloc( bufferSize );
+    wrBuffer = malloc( bufferSize );
+    if (rdBuffer) setbuffer( inp, rdBuffer, bufferSize );
+    if (wrBuffer) setbuffer( out, wrBuffer, bufferSize );
+  }
+
+  /* ':' + up to 20 decimal digits */
+  recTxtMax = 2 * hashSize + ( countLen ? 21 : 0 ) + sepLen;
+  binBuf = (unsigned char *)malloc( REC_BATCH * blockSize );
+  txtBuf = (char *)malloc( REC_BATCH * recTxtMax );
+  if ( !binBuf || !txtBuf ) {
+    fprintf(stderr, "error allocating buffers!\n");
+    return 10;
+  }
+
+  while ( (rd = fread( binBuf, 1, REC_BATCH * blockSize, inp )) > 0 ) {
+    const size_t partial = rd % blockSize;
+    rd /= blockSize;
+    char * t = txtBuf;
+    const unsigned char * b = binBuf;
+    for ( k = 0; k < rd; ++k, b += blockSize ) {
+      encodeHex( b, hashSize, t, lowerFlag );
+      t += 2 * hashSize;
+      if ( countLen )
+        t += formatCount( b + hashSize, countLen, t );
+      memcpy( t, sep, sepLen );
+      t += sepLen;
+    }
+    if ( fwrite( txtBuf, 1, t - txtBuf, out ) != (size_t)( t - txtBuf ) ) {
+      int ferr = ferror(out);
+      if (ferr)
+        fprintf(stderr, "error %d writing to output!: %s\n", ferr, strerror(ferr));
+      else
+        fprintf(stderr, "error %d writing to output!\n", ferr);
+      ret = 8;
+      break;
+    }
+    converted += rd;
+    if ( partial ) {
+      fprintf(stderr, "warning: input has %u trailing bytes - not a multiple of blockSize %d!\n", (unsigned)partial, blockSize);
+      break;
+    }
+  }
+
+  if ( !ret && ferror(inp) ) {
+    fprintf(stderr, "error reading from input!\n");
+    ret = 9;
+  }
+
+  if (verboseFlag)
+    fprintf(stderr, "converted %llu raw data sets.\n", converted);
+
+  free(binBuf);
+  free(txtBuf);
+
+  if ( out != stdout ) {
+    fclose(out);
+    free( wrBuffer );
+  }
+  if ( inp != stdin ) {
+    fclose(inp);
+    free( rdBuffer );
+  }
+
+  return ret;
+}
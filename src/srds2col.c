@@ -0,0 +1,185 @@
+/*
+ * srds2col (sorted raw data set to key prefix column)
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * srds2col extracts the leading 8 bytes of every (sample-th) record of a
+ * sorted raw data set (srds) into a contiguous column of big endian
+ * uint64 - see srdscol.h. srdsgrep -K binary searches the column
+ * and reads only the few records of the remaining window.
+ * the key must start at offset 0 of each block.
+ *
+ * output must be seekable: the header is rewritten at the end.
+ *
+ * Usage: see below at usage()
+ *
+ * Author:  Hayati Ayguen
+ */
+
+/* large file support */
+
+#ifdef _AIX
+#define _LARGE_FILES
+#else
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "srdscol.h"
+
+#define REC_BATCH  16384    /* number of records per fread() */
+
+
+static
+void usage() {
+  fputs("Usage: srds2col [-v][-h][-l <blockLength>][-s <sample>][-B <bufferSize>] [-i <input>] -o <output>\n", stderr);
+  fputs("  extracts the leading 8 bytes of each record into a key prefix column for srdsgrep -K\n", stderr);
+  fputs("  -v     verbose output\n", stderr);
+  fputs("  -h     print usage\n",stderr);
+  fputs("  -l <v> length of each raw data set block in bytes. default: 20\n", stderr);
+  fputs("  -s <v> store every v-th record's prefix only. 0 for one per 4 kB page. default: 1\n", stderr);
+  fputs("         srdsgrep reads up to v records after the column search\n", stderr);
+  fputs("  -B <v> bufferSize in kBytes\n", stderr);
+  fputs("  -i <f> input from file. default: stdin\n", stderr);
+  fputs("  -o <f> output to file\n", stderr);
+}
+
+
+int main(int argc, char *argv[])
+{
+  FILE * inp = stdin;
+  FILE * out = NULL;
+  const char * outfn = NULL;
+  int blockSize = 20;
+  int sample = 1;
+  int helpFlag = 0, verboseFlag = 0;
+  int optFlag, ret = 0;
+  size_t vBufSize = 0;
+  size_t rd, k, numCol;
+  uint64_t n = 0;
+  uint64_t * colBuf = NULL;
+  unsigned char * recBuf = NULL;
+  unsigned char * lastRec = NULL;
+  void * rdBuffer = NULL;
+  void * wrBuffer = NULL;
+  extern int optind;
+
+  /* parse command line options */
+  while ((optFlag = getopt(argc, argv, "vhl:s:B:i:o:")) > 0 && optFlag != '?') {
+    switch(optFlag) {
+    case 'v': ++verboseFlag; break;
+    case 'h': ++helpFlag; break;
+    case 'l': blockSize = atoi(optarg); break;
+    case 's': sample = atoi(optarg); break;
+    case 'B': vBufSize = (size_t)( atol(optarg) * 1024 ); break;
+    case 'i':
+      inp = fopen(optarg, "rb");
+      if (!inp) {
+        fprintf(stderr, "error opening input file '%s'\n", optarg);
+        return 10;
+      }
+      break;
+    case 'o':
+      outfn = optarg;
+      break;
+    }
+  }
+  if (optFlag == '?' || helpFlag || !outfn) {
+    usage();
+    exit(2);
+  }
+
+  if ( blockSize <= 0 ) {
+    fprintf(stderr, "error: blockSize %d is <= 0 !\n", blockSize);
+    return 10;
+  }
+  if ( sample < 0 ) {
+    fprintf(stderr, "error: sample %d is < 0 !\n", sample);
+    return 10;
+  }
+  if ( !sample )
+    sample = ( blockSize < 4096 ) ? 4096 / blockSize : 1;
+
+  out = fopen(outfn, "wb");
+  if (!out) {
+    fprintf(stderr, "error opening output file '%s'\n", outfn);
+    return 10;
+  }
+
+  {
+    size_t bufferSize = vBufSize ? vBufSize : 65536;
+    rdBuffer = malloc( bufferSize );
+    wrBuffer = malloc( bufferSize );
+    if (rdBuffer) setbuffer( inp, rdBuffer, bufferSize );
+    if (wrBuffer) setbuffer( out, wrBuffer, bufferSize );
+  }
+
+  recBuf = (unsigned char *)malloc( REC_BATCH * blockSize );
+  lastRec = (unsigned char *)calloc( 1, blockSize );
+  colBuf = (uint64_t *)malloc( REC_BATCH * sizeof(uint64_t) );
+  if ( !recBuf || !lastRec || !colBuf ) {
+    fprintf(stderr, "error allocating record buffer!\n");
+    return 10;
+  }
+
+  /* header with final number of records is written at the end */
+  if ( srdsColWriteHeader( out, blockSize, sample, 0 ) ) {
+    fprintf(stderr, "error writing to output!\n");
+    ret = 8;
+  }
+
+  while ( !ret && ( rd = fread( recBuf, blockSize, REC_BATCH, inp ) ) > 0 ) {
+    for ( k = 0, numCol = 0; k < rd; ++k, ++n ) {
+      const unsigned char * r = recBuf + k * blockSize;
+      if ( n && memcmp( lastRec, r, blockSize ) > 0 ) {
+        fprintf(stderr, "error: data set %llu (from 0) is not in ascending order!\n", (unsigned long long)n);
+        ret = 1;
+        break;
+      }
+      memcpy( lastRec, r, blockSize );
+      if ( n % sample == 0 )
+        colBuf[ numCol++ ] = keyPrefix64( r, blockSize, 0 );
+    }
+    if ( !ret && fwrite( colBuf, sizeof(uint64_t), numCol, out ) != numCol ) {
+      fprintf(stderr, "error writing to output!\n");
+      ret = 8;
+    }
+  }
+  if ( !ret && ferror(inp) ) {
+    fprintf(stderr, "error reading from input!\n");
+    ret = 9;
+  }
+
+  if ( !ret && ( fseeko( out, 0, SEEK_SET ) || srdsColWriteHeader( out, blockSize, sample, n ) ) ) {
+    fprintf(stderr, "error writing to output!\n");
+    ret = 8;
+  }
+  if ( fclose(out) && !ret ) {
+    fprintf(stderr, "error writing to output!\n");
+    ret = 8;
+  }
+  if ( ret )
+    remove( outfn );
+  else if (verboseFlag)
+    fprintf(stderr, "%llu records: wrote %llu prefixes of every %d-th record => %llu bytes to '%s'\n",
+            (unsigned long long)n, (unsigned long long)srdsColNumEntries( n, sample ), sample,
+            (unsigned long long)( SRDSCOL_HEADER_SIZE + 8 * srdsColNumEntries( n, sample ) ), outfn);
+
+  free( recBuf );
+  free( lastRec );
+  free( colBuf );
+  free( wrBuffer );
+  if ( inp != stdin ) {
+    fclose(inp);
+    free( rdBuffer );
+  }
+
+  return ret;
+}
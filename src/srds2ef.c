@@ -0,0 +1,259 @@
+/*
+ * srds2ef (sorted raw data set to Elias-Fano)
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * srds2ef converts a sorted raw data set (srds) file into a succinct
+ * Elias-Fano representation of the leading 64 bits of each record,
+ * optionally with residual bytes for exact verification - see srdsef.h.
+ * the result is searched in memory with srdsgrep -E.
+ *
+ * the number of records is taken from the input file size,
+ * so input must be a regular file. output must be seekable:
+ * residual bytes are written while reading, the (in memory built)
+ * upper and low parts at the end.
+ *
+ * Usage: see below at usage()
+ *
+ * Author:  Hayati Ayguen
+ */
+
+/* large file support */
+
+#ifdef _AIX
+#define _LARGE_FILES
+#else
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include <sys/stat.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "srdsef.h"
+
+#define REC_BATCH  16384    /* number of records per fread() */
+
+
+static
+void usage() {
+  fputs("Usage: srds2ef [-v][-h][-l <blockLength>][-r <residualBytes>][-B <bufferSize>] [-i <input>] -o <output>\n", stderr);
+  fputs("  converts a sorted raw data set into a succinct Elias-Fano representation for srdsgrep -E\n", stderr);
+  fputs("  of the leading 64 bits of each record\n", stderr);
+  fputs("  -v     verbose output\n", stderr);
+  fputs("  -h     print usage\n",stderr);
+  fputs("  -l <v> length of each raw data set block in bytes. default: 20\n", stderr);
+  fputs("  -r <v> number of residual bytes following the 64 bits, stored for exact verification.\n", stderr);
+  fputs("         default: 0. maximum: blockLength - 8\n", stderr);
+  fputs("  -B <v> bufferSize in kBytes\n", stderr);
+  fputs("  -i <f> input from file. default: stdin - which must be a regular file\n", stderr);
+  fputs("  -o <f> output to file\n", stderr);
+}
+
+
+static inline
+void setLow( uint64_t * lows, uint64_t i, int lowBits, uint64_t v )
+{
+  const uint64_t bit = i * lowBits;
+  const int sh = (int)( bit % 64 );
+  lows[ bit / 64 ] |= v << sh;
+  if ( sh + lowBits > 64 )
+    lows[ bit / 64 + 1 ] |= v >> ( 64 - sh );
+}
+
+
+int main(int argc, char *argv[])
+{
+  FILE * inp = stdin;
+  FILE * out = NULL;
+  const char * outfn = NULL;
+  int blockSize = 20;
+  int residualBytes = 0;
+  int helpFlag = 0, verboseFlag = 0;
+  int optFlag, ret = 0;
+  int lowBits;
+  size_t vBufSize = 0;
+  size_t rd, k;
+  uint64_t n, i, upperBits, numSamples, numWords, z, pos;
+  uint64_t * upper = NULL;
+  uint64_t * samples = NULL;
+  uint64_t * lows = NULL;
+  unsigned char * recBuf = NULL;
+  unsigned char * lastRec = NULL;
+  unsigned char * residBuf = NULL;
+  unsigned char h[SRDSEF_HEADER_SIZE];
+  void * rdBuffer = NULL;
+  void * wrBuffer = NULL;
+  struct stat st;
+  extern int optind;
+
+  /* parse command line options */
+  while ((optFlag = getopt(argc, argv, "vhl:r:B:i:o:")) > 0 && optFlag != '?') {
+    switch(optFlag) {
+    case 'v': ++verboseFlag; break;
+    case 'h': ++helpFlag; break;
+    case 'l': blockSize = atoi(optarg); break;
+    case 'r': residualBytes = atoi(optarg); break;
+    case 'B': vBufSize = (size_t)( atol(optarg) * 1024 ); break;
+    case 'i':
+      inp = fopen(optarg, "rb");
+      if (!inp) {
+        fprintf(stderr, "error opening input file '%s'\n", optarg);
+        return 10;
+      }
+      break;
+    case 'o':
+      outfn = optarg;
+      break;
+    }
+  }
+  if (optFlag == '?' || helpFlag || !outfn) {
+    usage();
+    exit(2);
+  }
+
+  if ( blockSize < 8 || residualBytes < 0 || residualBytes > blockSize - 8 ) {
+    fprintf(stderr, "error: blockSize %d must be >= 8 and residualBytes %d must be 0 .. blockSize - 8 !\n", blockSize, residualBytes);
+    return 10;
+  }
+
+  if ( fstat( fileno(inp), &st ) || !S_ISREG(st.st_mode) ) {
+    fprintf(stderr, "error: input must be a regular file!\n");
+    return 10;
+  }
+  if ( st.st_size % blockSize )
+    fprintf(stderr, "warning: input has %u trailing bytes - not a multiple of blockSize %d!\n", (unsigned)( st.st_size % blockSize ), blockSize);
+
+  n = (uint64_t)st.st_size / blockSize;
+  lowBits = srdsEFLowBits( n );
+  upperBits = srdsEFUpperBits( n, lowBits );
+  numSamples = srdsEFNumSamples( lowBits );
+  numWords = srdsEFUpperWords( upperBits );
+
+  if (verboseFlag)
+    fprintf(stderr, "%llu records: using %d low bits, %llu upper bits, %d residual bytes => %.2f bits per record\n",
+            (unsigned long long)n, lowBits, (unsigned long long)upperBits, residualBytes,
+            n ? (double)( 64 * ( numWords + numSamples + srdsEFLowWords( n, lowBits ) ) ) / n + 8 * residualBytes : 0.0 );
+
+  out = fopen(outfn, "wb");
+  if (!out) {
+    fprintf(stderr, "error opening output file '%s'\n", outfn);
+    return 10;
+  }
+
+  {
+    size_t bufferSize = vBufSize ? vBufSize : 65536;
+    rdBuffer = malloc( bufferSize );
+    wrBuffer = malloc( bufferSize );
+    if (rdBuffer) setbuffer( inp, rdBuffer, bufferSize );
+    if (wrBuffer) setbuffer( out, wrBuffer, bufferSize );
+  }
+
+  upper = (uint64_t *)calloc( numWords, sizeof(uint64_t) );
+  samples = (uint64_t *)calloc( numSamples, sizeof(uint64_t) );
+  lows = (uint64_t *)calloc( srdsEFLowWords( n, lowBits ), sizeof(uint64_t) );
+  recBuf = (unsigned char *)malloc( REC_BATCH * blockSize );
+  lastRec = (unsigned char *)calloc( 1, blockSize );
+  residBuf = (unsigned char *)malloc( REC_BATCH * residualBytes + 1 );
+  if ( !upper || !samples || !lows || !recBuf || !lastRec || !residBuf ) {
+    fprintf(stderr, "error allocating memory for %llu records!\n", (unsigned long long)n);
+    return 10;
+  }
+
+  /* residual bytes go behind all other sections */
+  if ( fseeko( out, SRDSEF_HEADER_SIZE + 8 * (off_t)( numWords + numSamples + srdsEFLowWords( n, lowBits ) ), SEEK_SET ) ) {
+    fprintf(stderr, "error: output file '%s' is not seekable!\n", outfn);
+    return 10;
+  }
+
+  for ( i = 0; i < n && !ret; ) {
+    size_t want = ( n - i < REC_BATCH ) ? (size_t)( n - i ) : REC_BATCH;
+    rd = fread( recBuf, blockSize, want, inp );
+    if ( rd != want ) {
+      fprintf(stderr, "error reading from input!\n");
+      ret = 9;
+      break;
+    }
+    for ( k = 0; k < rd; ++k, ++i ) {
+      const unsigned char * r = recBuf + k * blockSize;
+      const uint64_t v = keyPrefix64( r, 8, 0 );
+      if ( i && memcmp( lastRec, r, 8 + residualBytes ) > 0 ) {
+        fprintf(stderr, "error: data set %llu (from 0) is not in ascending order!\n", (unsigned long long)i);
+        ret = 1;
+        break;
+      }
+      memcpy( lastRec, r, 8 + residualBytes );
+      pos = ( v >> lowBits ) + i;
+      upper[ pos / 64 ] |= (uint64_t)1 << ( pos % 64 );
+      if ( lowBits )
+        setLow( lows, i, lowBits, v & ( ( (uint64_t)1 << lowBits ) - 1 ) );
+      if ( residualBytes )
+        memcpy( residBuf + k * residualBytes, r + 8, residualBytes );
+    }
+    if ( residualBytes && fwrite( residBuf, residualBytes, k, out ) != k ) {
+      fprintf(stderr, "error writing to output!\n");
+      ret = 8;
+    }
+  }
+
+  /* sample every SRDSEF_SAMPLE-th '0' bit */
+  for ( pos = 0, z = 0, i = 0; !ret && pos < numWords; ++pos ) {
+    uint64_t w = ~upper[pos];
+    uint64_t c;
+    if ( pos == numWords - 1 && upperBits % 64 )
+      w &= ( (uint64_t)1 << ( upperBits % 64 ) ) - 1;
+    c = (uint64_t)__builtin_popcountll( w );
+    for ( ; i * SRDSEF_SAMPLE < z + c; ++i ) {
+      uint64_t t = w, r = i * SRDSEF_SAMPLE - z;
+      while ( r-- )
+        t &= t - 1;
+      samples[i] = pos * 64 + __builtin_ctzll( t );
+    }
+    z += c;
+  }
+
+  if ( !ret ) {
+    memcpy( h, SRDSEF_MAGIC, 8 );
+    putLE32( h + 8, (uint32_t)lowBits );
+    putLE32( h + 12, (uint32_t)residualBytes );
+    putLE64( h + 16, n );
+    putLE64( h + 24, upperBits );
+    putLE64( h + 32, numSamples );
+    if ( fseeko( out, 0, SEEK_SET )
+         || fwrite( h, SRDSEF_HEADER_SIZE, 1, out ) != 1
+         || fwrite( upper, sizeof(uint64_t), numWords, out ) != numWords
+         || fwrite( samples, sizeof(uint64_t), numSamples, out ) != numSamples
+         || fwrite( lows, sizeof(uint64_t), srdsEFLowWords( n, lowBits ), out ) != srdsEFLowWords( n, lowBits ) ) {
+      fprintf(stderr, "error writing to output!\n");
+      ret = 8;
+    }
+  }
+
+  if ( fclose(out) && !ret ) {
+    fprintf(stderr, "error writing to output!\n");
+    ret = 8;
+  }
+  if ( ret )
+    remove( outfn );
+  else if (verboseFlag)
+    fprintf(stderr, "wrote %llu records to '%s'\n", (unsigned long long)n, outfn);
+
+  free( upper );
+  free( samples );
+  free( lows );
+  free( recBuf );
+  free( lastRec );
+  free( residBuf );
+  free( wrBuffer );
+  if ( inp != stdin ) {
+    fclose(inp);
+    free( rdBuffer );
+  }
+
+  return ret;
+}
@@ -0,0 +1,150 @@
+/*
+ * srds2pgm (sorted raw data set to piecewise linear model)
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * srds2pgm fits a learned index - a piecewise linear model of
+ * position over key with a maximum error of epsilon records -
+ * to a sorted raw data set (srds) in one streaming pass, see srdspgm.h.
+ * srdsgrep -P uses it to search only the predicted window.
+ * the key must start at offset 0 of each block.
+ *
+ * Usage: see below at usage()
+ *
+ * Author:  Hayati Ayguen
+ */
+
+/* large file support */
+
+#ifdef _AIX
+#define _LARGE_FILES
+#else
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "srdspgm.h"
+
+#define REC_BATCH  16384    /* number of records per fread() */
+
+
+static
+void usage() {
+  fputs("Usage: srds2pgm [-v][-h][-l <blockLength>][-e <epsilon>][-B <bufferSize>] [-i <input>] -o <output>\n", stderr);
+  fputs("  fits a piecewise linear model of position over key (learned index) for srdsgrep -P\n", stderr);
+  fputs("  -v     verbose output\n", stderr);
+  fputs("  -h     print usage\n",stderr);
+  fputs("  -l <v> length of each raw data set block in bytes. default: 20\n", stderr);
+  fputs("  -e <v> maximum error of the predicted position in records. default: 64\n", stderr);
+  fputs("         srdsgrep searches a window of 2 * epsilon records\n", stderr);
+  fputs("  -B <v> bufferSize in kBytes\n", stderr);
+  fputs("  -i <f> input from file. default: stdin\n", stderr);
+  fputs("  -o <f> output to file\n", stderr);
+}
+
+
+int main(int argc, char *argv[])
+{
+  FILE * inp = stdin;
+  const char * outfn = NULL;
+  int blockSize = 20;
+  int epsilon = 64;
+  int helpFlag = 0, verboseFlag = 0;
+  int optFlag, ret = 0, r = 0;
+  size_t vBufSize = 0;
+  size_t rd, k;
+  unsigned char * recBuf = NULL;
+  void * rdBuffer = NULL;
+  struct SrdsPgmWriter w;
+  extern int optind;
+
+  /* parse command line options */
+  while ((optFlag = getopt(argc, argv, "vhl:e:B:i:o:")) > 0 && optFlag != '?') {
+    switch(optFlag) {
+    case 'v': ++verboseFlag; break;
+    case 'h': ++helpFlag; break;
+    case 'l': blockSize = atoi(optarg); break;
+    case 'e': epsilon = atoi(optarg); break;
+    case 'B': vBufSize = (size_t)( atol(optarg) * 1024 ); break;
+    case 'i':
+      inp = fopen(optarg, "rb");
+      if (!inp) {
+        fprintf(stderr, "error opening input file '%s'\n", optarg);
+        return 10;
+      }
+      break;
+    case 'o':
+      outfn = optarg;
+      break;
+    }
+  }
+  if (optFlag == '?' || helpFlag || !outfn) {
+    usage();
+    exit(2);
+  }
+  if ( blockSize <= 0 ) {
+    fprintf(stderr, "error: blockSize %d is <= 0 !\n", blockSize);
+    return 10;
+  }
+  if ( epsilon <= 0 ) {
+    fprintf(stderr, "error: epsilon %d must be >= 1 !\n", epsilon);
+    return 10;
+  }
+
+  rdBuffer = malloc( vBufSize ? vBufSize : 65536 );
+  if (rdBuffer) setbuffer( inp, rdBuffer, vBufSize ? vBufSize : 65536 );
+  recBuf = (unsigned char *)malloc( REC_BATCH * blockSize );
+  if ( !recBuf ) {
+    fprintf(stderr, "error allocating record buffer!\n");
+    return 10;
+  }
+
+  if ( srdsPgmOpen( &w, outfn, blockSize, epsilon ) ) {
+    fprintf(stderr, "error opening output file '%s'\n", outfn);
+    return 10;
+  }
+
+  while ( !ret && ( rd = fread( recBuf, blockSize, REC_BATCH, inp ) ) > 0 ) {
+    for ( k = 0; k < rd; ++k ) {
+      r = srdsPgmAdd( &w, recBuf + k * blockSize );
+      if ( r == -2 ) {
+        fprintf(stderr, "error: data set %llu (from 0) is not in ascending order!\n", (unsigned long long)w.numRecords);
+        ret = 1;
+        break;
+      }
+      if ( r ) {
+        fprintf(stderr, "error writing to output!\n");
+        ret = 8;
+        break;
+      }
+    }
+  }
+  if ( !ret && ferror(inp) ) {
+    fprintf(stderr, "error reading from input!\n");
+    ret = 9;
+  }
+
+  if ( srdsPgmClose( &w ) && !ret ) {
+    fprintf(stderr, "error writing to output!\n");
+    ret = 8;
+  }
+  if ( ret )
+    remove( outfn );  /* don't leave a model of unverified data */
+  else if ( verboseFlag )
+    fprintf(stderr, "%llu records: %llu segments at epsilon %d => %.1f records per segment, %llu bytes. max. %llu equal keys\n",
+            (unsigned long long)w.numRecords, (unsigned long long)w.numSegments, epsilon,
+            w.numSegments ? (double)w.numRecords / w.numSegments : 0.0,
+            (unsigned long long)( SRDSPGM_HEADER_SIZE + 24 * w.numSegments ), (unsigned long long)w.maxRun);
+
+  free( recBuf );
+  if ( inp != stdin )
+    fclose(inp);
+  return ret;
+}
@@ -0,0 +1,460 @@
+/*
+ * srds2range (sorted raw data set to range API files)
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * srds2range exports a sorted raw data set of hashes into the 16^5 = 1048576
+ * prefix files '00000' .. 'FFFFF' of the HIBP range API, see
+ *   https://haveibeenpwned.com/API/v3#SearchingPwnedPasswordsByRange
+ * each file holds the lines 'SUFFIX:COUNT' of all hashes starting with the
+ * prefix of 5 hexadecimal digits - e.g. for serving an offline mirror from a static web server.
+ * COUNT is taken from the (big endian) bytes following the hash in each record -
+ * or is the number of (duplicate) records, when the records hold the hash only.
+ *
+ * the input is mapped into memory and read once, sequentially:
+ * the prefix range is split over the threads, each thread starts at its
+ * first prefix (found by binary search) and creates its files.
+ * each file is formatted in memory and written with a single write().
+ * alternatively, all files are written into a single (ustar) tar file.
+ *
+ * Usage: see below at usage()
+ *
+ * Author:  Hayati Ayguen
+ */
+
+/* large file support */
+
+#ifdef _AIX
+#define _LARGE_FILES
+#else
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "hexcodec.h"
+
+#define PREFIX_DIGITS  5
+#define NUM_PREFIXES   ( 1U << ( 4 * PREFIX_DIGITS ) )
+#define MAXTHREADS     256
+
+static int blockSize = 20;
+static int hashLen = -1;
+static int countLen = 0;
+static int dirDigits = 0;
+static int lowerFlag = 0;
+static int lfFlag = 0;
+static int verboseFlag = 0;
+
+static const unsigned char * data = NULL;
+static uint64_t numRecs = 0;
+static EncodeHexFunc encodeHex = NULL;
+
+
+static inline
+uint32_t prefixOf( const unsigned char * r )
+{
+  return ( (uint32_t)r[0] << 12 ) | ( (uint32_t)r[1] << 4 ) | ( r[2] >> 4 );
+}
+
+/* number of the first record with prefix >= p */
+static
+uint64_t lowerBound( uint32_t p )
+{
+  uint64_t lo = 0, hi = numRecs;
+  while ( lo < hi ) {
+    const uint64_t mid = lo + ( hi - lo ) / 2;
+    if ( prefixOf( data + mid * blockSize ) < p )
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+static inline
+uint64_t countOf( const unsigned char * r )
+{
+  uint64_t v = 0;
+  int k;
+  if ( !countLen )
+    return 1;
+  for ( k = 0; k < countLen; ++k )
+    v = ( v << 8 ) | r[hashLen + k];
+  return v;
+}
+
+/*
+ * formats the lines of all records with prefix p into *buf, starting at record *idx.
+ * advances *idx behind these records. returns the length
+ */
+static
+size_t formatPrefix( uint32_t p, uint64_t * idx, char ** buf, size_t * cap )
+{
+  const size_t lineMax = 2 * hashLen - PREFIX_DIGITS + 1 + 20 + 2;
+  size_t len = 0;
+  char hex[512];
+
+  while ( *idx < numRecs ) {
+    const unsigned char * r = data + *idx * blockSize;
+    uint64_t cnt;
+    char tmp[24];
+    int n = 0;
+    if ( prefixOf( r ) != p )
+      break;
+    /* duplicate hashes are output once - with the sum of their counts */
+    for ( cnt = countOf( r ), ++*idx; *idx < numRecs && !memcmp( r, data + *idx * blockSize, hashLen ); ++*idx )
+      cnt += countOf( data + *idx * blockSize );
+    if ( len + lineMax > *cap ) {
+      char * q = (char *)realloc( *buf, 2 * *cap + lineMax );
+      if ( !q )
+        return (size_t)-1;
+      *buf = q;
+      *cap = 2 * *cap + lineMax;
+    }
+    /* hash bytes from the one with the 5th hex digit - without that byte's 1st digit */
+    encodeHex( r + 2, hashLen - 2, hex, lowerFlag );
+    memcpy( *buf + len, hex + 1, 2 * ( hashLen - 2 ) - 1 );
+    len += 2 * ( hashLen - 2 ) - 1;
+    (*buf)[len++] = ':';
+    do {
+      tmp[n++] = (char)( '0' + cnt % 10 );
+      cnt /= 10;
+    } while ( cnt );
+    while ( n )
+      (*buf)[len++] = tmp[--n];
+    if ( !lfFlag )
+      (*buf)[len++] = '\r';
+    (*buf)[len++] = '\n';
+  }
+  return len;
+}
+
+/* relative path of prefix p's file: optionally in a sub directory of the leading dirDigits digits */
+static
+void prefixName( uint32_t p, char * name )
+{
+  static const char fmtU[] = "%05X", fmtL[] = "%05x";
+  char pfx[8];
+  sprintf( pfx, lowerFlag ? fmtL : fmtU, p );
+  if ( dirDigits )
+    sprintf( name, "%.*s/%s", dirDigits, pfx, pfx );
+  else
+    strcpy( name, pfx );
+}
+
+
+struct Worker {
+  pthread_t thread;
+  int started;         /* thread is running - else the range was written inline */
+  uint32_t first;      /* prefix range [ first, last ) */
+  uint32_t last;
+  int dirFd;
+  int ret;
+  unsigned long long bytes;
+};
+
+static
+void * workerThread( void * arg )
+{
+  struct Worker * w = (struct Worker *)arg;
+  uint64_t idx = lowerBound( w->first );
+  size_t cap = 65536, len;
+  char * buf = (char *)malloc( cap );
+  char name[32];
+  uint32_t p;
+
+  if ( !buf ) {
+    w->ret = 10;
+    return NULL;
+  }
+  for ( p = w->first; p < w->last && !w->ret; ++p ) {
+    int fd;
+    size_t off = 0;
+    len = formatPrefix( p, &idx, &buf, &cap );
+    if ( len == (size_t)-1 ) {
+      fprintf(stderr, "error allocating memory!\n");
+      w->ret = 10;
+      break;
+    }
+    prefixName( p, name );
+    fd = openat( w->dirFd, name, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+    if ( fd < 0 ) {
+      fprintf(stderr, "error creating file '%s': %s\n", name, strerror(errno));
+      w->ret = 8;
+      break;
+    }
+    while ( off < len ) {
+      ssize_t wr = write( fd, buf + off, len - off );
+      if ( wr <= 0 ) {
+        fprintf(stderr, "error writing file '%s': %s\n", name, strerror(errno));
+        w->ret = 8;
+        break;
+      }
+      off += (size_t)wr;
+    }
+    if ( close( fd ) && !w->ret ) {
+      fprintf(stderr, "error writing file '%s': %s\n", name, strerror(errno));
+      w->ret = 8;
+    }
+    w->bytes += len;
+  }
+  free( buf );
+  return NULL;
+}
+
+
+/* ustar header for a file or directory */
+static
+void tarHeader( unsigned char * h, const char * name, uint64_t size, int isDir, time_t mtime )
+{
+  unsigned sum = 0;
+  int k;
+  memset( h, 0, 512 );
+  snprintf( (char *)h, 100, "%s", name );
+  memcpy( h + 100, isDir ? "0000755" : "0000644", 8 );
+  memcpy( h + 108, "0000000", 8 );
+  memcpy( h + 116, "0000000", 8 );
+  snprintf( (char *)h + 124, 12, "%011llo", (unsigned long long)size );
+  snprintf( (char *)h + 136, 12, "%011llo", (unsigned long long)mtime );
+  memset( h + 148, ' ', 8 );
+  h[156] = isDir ? '5' : '0';
+  memcpy( h + 257, "ustar", 6 );
+  memcpy( h + 263, "00", 2 );
+  for ( k = 0; k < 512; ++k )
+    sum += h[k];
+  snprintf( (char *)h + 148, 8, "%06o", sum );
+  h[155] = ' ';
+}
+
+/* writes all prefix files into tar file. returns exit code */
+static
+int writeTar( FILE * out, unsigned long long * bytes )
+{
+  const time_t now = time( NULL );
+  unsigned char h[512], zero[1024];
+  size_t cap = 65536, len;
+  char * buf = (char *)malloc( cap );
+  char name[32];
+  uint64_t idx = 0;
+  uint32_t p;
+
+  memset( zero, 0, sizeof(zero) );
+  if ( !buf )
+    return 10;
+  for ( p = 0; p < NUM_PREFIXES; ++p ) {
+    if ( dirDigits && !( p & ( ( 1U << ( 4 * ( PREFIX_DIGITS - dirDigits ) ) ) - 1 ) ) ) {
+      prefixName( p, name );
+      name[dirDigits + 1] = 0;
+      tarHeader( h, name, 0, 1, now );
+      if ( fwrite( h, 512, 1, out ) != 1 )
+        break;
+    }
+    len = formatPrefix( p, &idx, &buf, &cap );
+    if ( len == (size_t)-1 ) {
+      fprintf(stderr, "error allocating memory!\n");
+      free( buf );
+      return 10;
+    }
+    prefixName( p, name );
+    tarHeader( h, name, len, 0, now );
+    if ( fwrite( h, 512, 1, out ) != 1 || fwrite( buf, 1, len, out ) != len
+         || fwrite( zero, 1, ( 512 - len % 512 ) % 512, out ) != ( 512 - len % 512 ) % 512 )
+      break;
+    *bytes += len;
+  }
+  free( buf );
+  if ( p < NUM_PREFIXES || fwrite( zero, 1024, 1, out ) != 1 ) {
+    fprintf(stderr, "error writing to tar file!\n");
+    return 8;
+  }
+  return 0;
+}
+
+
+static
+void usage() {
+  fputs("Usage: srds2range [-h][-v][-l <blockLength>][-n <hashLength>][-j <threads>][-d <digits>][-x][-L]\n", stderr);
+  fputs("                  [-i <input>] ( -o <directory> | -t <tarfile> )\n", stderr);
+  fputs("  exports a sorted raw data set of hashes to the 16^5 prefix files of the HIBP range API\n", stderr);
+  fputs("  each with the lines 'SUFFIX:COUNT'\n", stderr);
+  fputs("  -h     print usage\n", stderr);
+  fputs("  -v     verbose output\n", stderr);
+  fputs("  -l <v> length of each raw data set block in bytes. default: 20\n", stderr);
+  fputs("  -n <v> length of hash in bytes. default: blockLength\n", stderr);
+  fputs("         COUNT is read from the remaining (big endian) bytes - or is the number of duplicates\n", stderr);
+  fputs("  -j <v> number of threads writing files. default: 1. 0 for number of online cpus\n", stderr);
+  fputs("  -d <v> put files into sub directories named by the leading 1 .. 4 digits. default: 0\n", stderr);
+  fputs("  -x     lower case hexadecimal. default: upper case - as HIBP\n", stderr);
+  fputs("  -L     terminate lines with '\\n'. default: '\\r\\n' - as the range API\n", stderr);
+  fputs("  -i <f> input from file. default: stdin - which must be a regular file\n", stderr);
+  fputs("  -o <d> output directory - created if not existing\n", stderr);
+  fputs("  -t <f> output into single tar file. '-' for stdout\n", stderr);
+}
+
+
+int main(int argc, char *argv[])
+{
+  const char * outDir = NULL;
+  const char * tarFn = NULL;
+  int inpFd = 0;
+  int numThreads = 1;
+  int helpFlag = 0;
+  int optFlag, ret = 0, k;
+  unsigned long long bytes = 0;
+  struct stat st;
+  extern int optind;
+
+  /* parse command line options */
+  while ((optFlag = getopt(argc, argv, "hvl:n:j:d:xLi:o:t:")) > 0 && optFlag != '?') {
+    switch(optFlag) {
+    case 'h': ++helpFlag; break;
+    case 'v': ++verboseFlag; break;
+    case 'l': blockSize = atoi(optarg); break;
+    case 'n': hashLen = atoi(optarg); break;
+    case 'j': numThreads = atoi(optarg); break;
+    case 'd': dirDigits = atoi(optarg); break;
+    case 'x': ++lowerFlag; break;
+    case 'L': ++lfFlag; break;
+    case 'i':
+      inpFd = open(optarg, O_RDONLY);
+      if (inpFd < 0) {
+        fprintf(stderr, "error opening input file '%s'\n", optarg);
+        return 10;
+      }
+      break;
+    case 'o': outDir = optarg; break;
+    case 't': tarFn = optarg; break;
+    }
+  }
+  if (optFlag == '?' || helpFlag || ( !outDir == !tarFn )) {
+    usage();
+    exit(2);
+  }
+
+  if ( hashLen < 0 )
+    hashLen = blockSize;
+  countLen = blockSize - hashLen;
+  if ( hashLen < 3 || hashLen > 200 || countLen < 0 || countLen > 8 ) {
+    fprintf(stderr, "error: hashLength %d must be 3 .. 200 and blockSize - hashLength must be 0 .. 8 !\n", hashLen);
+    return 10;
+  }
+  if ( dirDigits < 0 || dirDigits >= PREFIX_DIGITS ) {
+    fprintf(stderr, "error: sub directory digits %d must be 0 .. %d !\n", dirDigits, PREFIX_DIGITS - 1);
+    return 10;
+  }
+  if ( numThreads <= 0 )
+    numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if ( numThreads > MAXTHREADS )
+    numThreads = MAXTHREADS;
+
+  if ( fstat( inpFd, &st ) || !S_ISREG(st.st_mode) ) {
+    fprintf(stderr, "error: input must be a regular file!\n");
+    return 10;
+  }
+  if ( st.st_size % blockSize )
+    fprintf(stderr, "warning: input has %u trailing bytes - not a multiple of blockSize %d!\n", (unsigned)( st.st_size % blockSize ), blockSize);
+  numRecs = (uint64_t)st.st_size / blockSize;
+  if ( numRecs ) {
+    data = (const unsigned char *)mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, inpFd, 0 );
+    if ( data == MAP_FAILED ) {
+      fprintf(stderr, "error mapping input into memory!\n");
+      return 10;
+    }
+    madvise( (void *)data, st.st_size, MADV_SEQUENTIAL );
+  }
+
+  encodeHex = selectEncodeHex( verboseFlag >= 2 );
+
+  if ( tarFn ) {
+    FILE * out = strcmp( tarFn, "-" ) ? fopen( tarFn, "wb" ) : stdout;
+    void * wrBuffer = malloc( 1 << 20 );
+    if ( !out ) {
+      fprintf(stderr, "error opening output file '%s'\n", tarFn);
+      return 10;
+    }
+    if ( wrBuffer )
+      setbuffer( out, wrBuffer, 1 << 20 );
+    ret = writeTar( out, &bytes );
+    if ( out != stdout ) {
+      if ( fclose( out ) && !ret ) {
+        fprintf(stderr, "error writing to tar file!\n");
+        ret = 8;
+      }
+      free( wrBuffer );
+    }
+    else if ( fflush( out ) && !ret )
+      ret = 8;
+  }
+  else {
+    struct Worker * w = (struct Worker *)calloc( numThreads, sizeof(struct Worker) );
+    int dirFd;
+    if ( mkdir( outDir, 0755 ) && errno != EEXIST ) {
+      fprintf(stderr, "error creating directory '%s': %s\n", outDir, strerror(errno));
+      return 10;
+    }
+    dirFd = open( outDir, O_RDONLY | O_DIRECTORY );
+    if ( dirFd < 0 || !w ) {
+      fprintf(stderr, "error opening directory '%s'\n", outDir);
+      return 10;
+    }
+    if ( dirDigits ) {
+      uint32_t d;
+      char name[32];
+      for ( d = 0; d < NUM_PREFIXES; d += 1U << ( 4 * ( PREFIX_DIGITS - dirDigits ) ) ) {
+        prefixName( d, name );
+        name[dirDigits] = 0;
+        if ( mkdirat( dirFd, name, 0755 ) && errno != EEXIST ) {
+          fprintf(stderr, "error creating directory '%s': %s\n", name, strerror(errno));
+          return 10;
+        }
+      }
+    }
+    if (verboseFlag)
+      fprintf(stderr, "info: writing %u files with %d threads\n", NUM_PREFIXES, numThreads);
+    for ( k = 0; k < numThreads; ++k ) {
+      w[k].first = (uint32_t)( (uint64_t)NUM_PREFIXES * k / numThreads );
+      w[k].last = (uint32_t)( (uint64_t)NUM_PREFIXES * ( k + 1 ) / numThreads );
+      w[k].dirFd = dirFd;
+      if ( numThreads > 1 && !pthread_create( &w[k].thread, NULL, workerThread, &w[k] ) )
+        w[k].started = 1;
+      else {
+        if ( numThreads > 1 )
+          fprintf(stderr, "warning: could not create thread %d - writing its prefix range inline\n", k);
+        workerThread( &w[k] );
+      }
+    }
+    for ( k = 0; k < numThreads; ++k ) {
+      if ( w[k].started )
+        pthread_join( w[k].thread, NULL );
+      if ( w[k].ret && !ret )
+        ret = w[k].ret;
+      bytes += w[k].bytes;
+    }
+    close( dirFd );
+    free( w );
+  }
+
+  if (verboseFlag)
+    fprintf(stderr, "exported %llu records into %u prefix files with %llu bytes.\n",
+            (unsigned long long)numRecs, NUM_PREFIXES, bytes);
+
+  if ( numRecs )
+    munmap( (void *)data, st.st_size );
+  if ( inpFd )
+    close( inpFd );
+  return ret;
+}
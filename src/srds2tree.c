@@ -0,0 +1,222 @@
+/*
+ * srds2tree (sorted raw data set to static search tree layout)
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * srds2tree converts a sorted raw data set (srds) file into the static
+ * search tree layout - see srdstree.h: the records in unchanged order,
+ * preceded by a static B+ tree over the leading 64 bits of the first
+ * record of each page sized leaf.
+ * srdsgrep detects the layout and searches the tree instead of
+ * bisecting the records.
+ *
+ * the number of records is taken from the input file size,
+ * so input must be a regular file. output must be seekable:
+ * records are copied while reading, the (in memory built) tree
+ * is written at the end.
+ *
+ * Usage: see below at usage()
+ *
+ * Author:  Hayati Ayguen
+ */
+
+/* large file support */
+
+#ifdef _AIX
+#define _LARGE_FILES
+#else
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include <sys/stat.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "srdstree.h"
+
+#define REC_BATCH  16384    /* number of records per fread() */
+
+
+static
+void usage() {
+  fputs("Usage: srds2tree [-v][-h][-l <blockLength>][-k <nodeKeys>][-B <bufferSize>] [-i <input>] -o <output>\n", stderr);
+  fputs("  converts a sorted raw data set into a static search tree layout for srdsgrep\n", stderr);
+  fputs("  -v     verbose output\n", stderr);
+  fputs("  -h     print usage\n",stderr);
+  fputs("  -l <v> length of each raw data set block in bytes. default: 20\n", stderr);
+  fputs("  -k <v> keys per tree node: multiple of 8 - up to 512. default: 16\n", stderr);
+  fputs("         8 = one cache line, 16 = two cache lines, 512 = one 4 kB page - for data on disk\n", stderr);
+  fputs("  -B <v> bufferSize in kBytes\n", stderr);
+  fputs("  -i <f> input from file. default: stdin - which must be a regular file\n", stderr);
+  fputs("  -o <f> output to file\n", stderr);
+}
+
+
+int main(int argc, char *argv[])
+{
+  FILE * inp = stdin;
+  FILE * out = NULL;
+  const char * outfn = NULL;
+  int helpFlag = 0, verboseFlag = 0;
+  int optFlag, ret = 0;
+  size_t vBufSize = 0;
+  size_t rd, k;
+  uint64_t i;
+  uint64_t * nodes = NULL;
+  unsigned char * recBuf = NULL;
+  unsigned char * lastRec = NULL;
+  void * rdBuffer = NULL;
+  void * wrBuffer = NULL;
+  struct SrdsTree t;
+  struct stat st;
+  extern int optind;
+
+  memset( &t, 0, sizeof(t) );
+  t.blockSize = 20;
+  t.nodeKeys = 16;
+
+  /* parse command line options */
+  while ((optFlag = getopt(argc, argv, "vhl:k:B:i:o:")) > 0 && optFlag != '?') {
+    switch(optFlag) {
+    case 'v': ++verboseFlag; break;
+    case 'h': ++helpFlag; break;
+    case 'l': t.blockSize = atoi(optarg); break;
+    case 'k': t.nodeKeys = atoi(optarg); break;
+    case 'B': vBufSize = (size_t)( atol(optarg) * 1024 ); break;
+    case 'i':
+      inp = fopen(optarg, "rb");
+      if (!inp) {
+        fprintf(stderr, "error opening input file '%s'\n", optarg);
+        return 10;
+      }
+      break;
+    case 'o':
+      outfn = optarg;
+      break;
+    }
+  }
+  if (optFlag == '?' || helpFlag || !outfn) {
+    usage();
+    exit(2);
+  }
+
+  if ( t.blockSize <= 0 ) {
+    fprintf(stderr, "error: blockSize %d is <= 0 !\n", t.blockSize);
+    return 10;
+  }
+  if ( t.nodeKeys < 8 || t.nodeKeys > 512 || t.nodeKeys % 8 ) {
+    fprintf(stderr, "error: nodeKeys %d must be a multiple of 8 - up to 512 !\n", t.nodeKeys);
+    return 10;
+  }
+
+  if ( fstat( fileno(inp), &st ) || !S_ISREG(st.st_mode) ) {
+    fprintf(stderr, "error: input must be a regular file!\n");
+    return 10;
+  }
+  if ( st.st_size % t.blockSize )
+    fprintf(stderr, "warning: input has %u trailing bytes - not a multiple of blockSize %d!\n", (unsigned)( st.st_size % t.blockSize ), t.blockSize);
+
+  t.numRecords = (uint64_t)st.st_size / t.blockSize;
+  t.leafRecords = srdsTreeLeafRecords( t.blockSize );
+  if ( srdsTreeLayout( &t ) ) {
+    fprintf(stderr, "error: tree for %llu records is too high!\n", (unsigned long long)t.numRecords);
+    return 10;
+  }
+  t.dataOffset = srdsTreeDataOffset( &t );
+
+  if (verboseFlag)
+    fprintf(stderr, "%llu records: %llu leaves of %llu records, %d layers of nodes with %d keys => %llu bytes before the records\n",
+            (unsigned long long)t.numRecords, (unsigned long long)( t.numKeys + ( t.numRecords ? 1 : 0 ) ),
+            (unsigned long long)t.leafRecords, t.height, t.nodeKeys, (unsigned long long)t.dataOffset);
+
+  out = fopen(outfn, "wb");
+  if (!out) {
+    fprintf(stderr, "error opening output file '%s'\n", outfn);
+    return 10;
+  }
+
+  {
+    size_t bufferSize = vBufSize ? vBufSize : 65536;
+    rdBuffer = malloc( bufferSize );
+    wrBuffer = malloc( bufferSize );
+    if (rdBuffer) setbuffer( inp, rdBuffer, bufferSize );
+    if (wrBuffer) setbuffer( out, wrBuffer, bufferSize );
+  }
+
+  nodes = (uint64_t *)calloc( t.layer[t.height] + 1, sizeof(uint64_t) );
+  recBuf = (unsigned char *)malloc( REC_BATCH * t.blockSize );
+  lastRec = (unsigned char *)calloc( 1, t.blockSize );
+  if ( !nodes || !recBuf || !lastRec ) {
+    fprintf(stderr, "error allocating memory for %llu records!\n", (unsigned long long)t.numRecords);
+    return 10;
+  }
+
+  /* records go behind the tree */
+  if ( fseeko( out, (off_t)t.dataOffset, SEEK_SET ) ) {
+    fprintf(stderr, "error: output file '%s' is not seekable!\n", outfn);
+    return 10;
+  }
+
+  for ( i = 0; i < t.numRecords && !ret; ) {
+    size_t want = ( t.numRecords - i < REC_BATCH ) ? (size_t)( t.numRecords - i ) : REC_BATCH;
+    rd = fread( recBuf, t.blockSize, want, inp );
+    if ( rd != want ) {
+      fprintf(stderr, "error reading from input!\n");
+      ret = 9;
+      break;
+    }
+    for ( k = 0; k < rd; ++k, ++i ) {
+      const unsigned char * r = recBuf + k * t.blockSize;
+      if ( i && memcmp( lastRec, r, t.blockSize ) > 0 ) {
+        fprintf(stderr, "error: data set %llu (from 0) is not in ascending order!\n", (unsigned long long)i);
+        ret = 1;
+        break;
+      }
+      memcpy( lastRec, r, t.blockSize );
+      /* first record of each leaf - except the first leaf */
+      if ( i && i % t.leafRecords == 0 )
+        nodes[ i / t.leafRecords - 1 ] = keyPrefix64( r, t.blockSize, 0 );
+    }
+    if ( !ret && fwrite( recBuf, t.blockSize, rd, out ) != rd ) {
+      fprintf(stderr, "error writing to output!\n");
+      ret = 8;
+    }
+  }
+
+  if ( !ret ) {
+    srdsTreeBuild( &t, nodes );
+    if ( fseeko( out, 0, SEEK_SET )
+         || srdsTreeWriteHeader( &t, out )
+         || fwrite( nodes, sizeof(uint64_t), t.layer[t.height], out ) != t.layer[t.height]
+         || fflush( out )
+         || ( !t.numRecords && ftruncate( fileno(out), (off_t)t.dataOffset ) ) ) {
+      fprintf(stderr, "error writing to output!\n");
+      ret = 8;
+    }
+  }
+
+  if ( fclose(out) && !ret ) {
+    fprintf(stderr, "error writing to output!\n");
+    ret = 8;
+  }
+  if ( ret )
+    remove( outfn );
+  else if (verboseFlag)
+    fprintf(stderr, "wrote %llu records to '%s'\n", (unsigned long long)t.numRecords, outfn);
+
+  free( nodes );
+  free( recBuf );
+  free( lastRec );
+  free( wrBuffer );
+  if ( inp != stdin ) {
+    fclose(inp);
+    free( rdBuffer );
+  }
+
+  return ret;
+}
@@ -0,0 +1,325 @@
+/*
+ * srdsaio.h
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * asynchronous reads for batch lookups: many independent reads in flight -
+ * instead of queue depth 1 with a synchronous read per binary search step.
+ * NVMe devices need 32 - 128 requests in flight for their IOPS.
+ *
+ * backends:
+ *   io_uring - with the raw system calls: no liburing needed
+ *   a pool of threads, each with synchronous pread() - where io_uring is not available
+ *
+ * usage: srdsAioRead() queues a read with a tag, srdsAioWait() submits the
+ * queued reads and returns one completion. at most 'depth' reads may be
+ * outstanding.
+ *
+ * Author:  Hayati Ayguen
+ */
+
+#ifndef SRDSAIO_H
+#define SRDSAIO_H
+
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+#if defined(__linux__) && defined(__NR_io_uring_setup) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define SRDSAIO_URING  1
+#endif
+#endif
+
+#define SRDSAIO_MAX_THREADS  64
+
+struct SrdsAioReq {
+  int fd;
+  void * buf;
+  size_t len;
+  off_t off;
+  void * tag;
+  ssize_t res;
+  struct iovec iov;
+};
+
+struct SrdsAio {
+  int depth;
+  int numThreads;         /* 0 with io_uring */
+  struct SrdsAioReq * reqs;
+  int * freeReqs;         /* stack of unused reqs */
+  int numFree;
+
+  /* pread thread pool: ring buffers of req indices */
+  pthread_t threads[SRDSAIO_MAX_THREADS];
+  pthread_mutex_t mtx;
+  pthread_cond_t cvReq, cvDone;
+  int * reqQ, reqHead, reqCount;
+  int * doneQ, doneHead, doneCount;
+  int quit;
+
+#if defined(SRDSAIO_URING)
+  int ringFd;
+  unsigned toSubmit;
+  void * sqRing;  size_t sqRingSize;
+  void * cqRing;  size_t cqRingSize;
+  struct io_uring_sqe * sqes;  size_t sqesSize;
+  unsigned * sqHead, * sqTail, * sqMask, * sqArray;
+  unsigned * cqHead, * cqTail, * cqMask;
+  struct io_uring_cqe * cqes;
+#endif
+};
+
+
+static void *
+srdsAioWorker( void * arg )
+{
+  struct SrdsAio * a = (struct SrdsAio *)arg;
+  for (;;) {
+    struct SrdsAioReq * r;
+    int i;
+    pthread_mutex_lock( &a->mtx );
+    while ( !a->reqCount && !a->quit )
+      pthread_cond_wait( &a->cvReq, &a->mtx );
+    if ( !a->reqCount ) {
+      pthread_mutex_unlock( &a->mtx );
+      return NULL;
+    }
+    i = a->reqQ[ a->reqHead ];
+    a->reqHead = ( a->reqHead + 1 ) % a->depth;
+    --a->reqCount;
+    pthread_mutex_unlock( &a->mtx );
+
+    r = &a->reqs[i];
+    r->res = pread( r->fd, r->buf, r->len, r->off );
+    if ( r->res < 0 )
+      r->res = -errno;
+
+    pthread_mutex_lock( &a->mtx );
+    a->doneQ[ ( a->doneHead + a->doneCount ) % a->depth ] = i;
+    ++a->doneCount;
+    pthread_cond_signal( &a->cvDone );
+    pthread_mutex_unlock( &a->mtx );
+  }
+}
+
+#if defined(SRDSAIO_URING)
+static
+int srdsAioUringInit( struct SrdsAio * a )
+{
+  struct io_uring_params p;
+  unsigned char * sq, * cq;
+
+  memset( &p, 0, sizeof(p) );
+  a->ringFd = (int)syscall( __NR_io_uring_setup, (unsigned)a->depth, &p );
+  if ( a->ringFd < 0 )
+    return -1;
+  a->sqRingSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  a->cqRingSize = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  a->sqesSize = p.sq_entries * sizeof(struct io_uring_sqe);
+  a->sqRing = mmap( NULL, a->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, a->ringFd, IORING_OFF_SQ_RING );
+  a->cqRing = mmap( NULL, a->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, a->ringFd, IORING_OFF_CQ_RING );
+  a->sqes = (struct io_uring_sqe *)mmap( NULL, a->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, a->ringFd, IORING_OFF_SQES );
+  if ( a->sqRing == MAP_FAILED || a->cqRing == MAP_FAILED || a->sqes == (struct io_uring_sqe *)MAP_FAILED ) {
+    if ( a->sqRing != MAP_FAILED ) munmap( a->sqRing, a->sqRingSize );
+    if ( a->cqRing != MAP_FAILED ) munmap( a->cqRing, a->cqRingSize );
+    if ( a->sqes != (struct io_uring_sqe *)MAP_FAILED ) munmap( a->sqes, a->sqesSize );
+    close( a->ringFd );
+    a->ringFd = -1;
+    return -1;
+  }
+  sq = (unsigned char *)a->sqRing;
+  cq = (unsigned char *)a->cqRing;
+  a->sqHead = (unsigned *)( sq + p.sq_off.head );
+  a->sqTail = (unsigned *)( sq + p.sq_off.tail );
+  a->sqMask = (unsigned *)( sq + p.sq_off.ring_mask );
+  a->sqArray = (unsigned *)( sq + p.sq_off.array );
+  a->cqHead = (unsigned *)( cq + p.cq_off.head );
+  a->cqTail = (unsigned *)( cq + p.cq_off.tail );
+  a->cqMask = (unsigned *)( cq + p.cq_off.ring_mask );
+  a->cqes = (struct io_uring_cqe *)( cq + p.cq_off.cqes );
+  a->toSubmit = 0;
+  return 0;
+}
+#endif
+
+/*
+ * depth: maximum number of outstanding reads.
+ * threadsFlag forces the pread thread pool.
+ * returns 0 on success
+ */
+static
+int srdsAioInit( struct SrdsAio * a, int depth, int threadsFlag )
+{
+  int k;
+  memset( a, 0, sizeof(*a) );
+  a->depth = depth;
+  a->reqs = (struct SrdsAioReq *)calloc( depth, sizeof(struct SrdsAioReq) );
+  a->freeReqs = (int *)malloc( depth * sizeof(int) );
+  if ( !a->reqs || !a->freeReqs )
+    return -1;
+  for ( k = 0; k < depth; ++k )
+    a->freeReqs[k] = k;
+  a->numFree = depth;
+
+#if defined(SRDSAIO_URING)
+  a->ringFd = -1;
+  if ( !threadsFlag && !srdsAioUringInit( a ) )
+    return 0;
+#endif
+
+  a->reqQ = (int *)malloc( depth * sizeof(int) );
+  a->doneQ = (int *)malloc( depth * sizeof(int) );
+  if ( !a->reqQ || !a->doneQ )
+    return -1;
+  pthread_mutex_init( &a->mtx, NULL );
+  pthread_cond_init( &a->cvReq, NULL );
+  pthread_cond_init( &a->cvDone, NULL );
+  for ( k = 0; k < depth && k < SRDSAIO_MAX_THREADS; ++k ) {
+    if ( pthread_create( &a->threads[k], NULL, srdsAioWorker, a ) )
+      break;
+    ++a->numThreads;
+  }
+  return a->numThreads ? 0 : -1;
+}
+
+static
+void srdsAioFree( struct SrdsAio * a )
+{
+  int k;
+  if ( a->numThreads ) {
+    pthread_mutex_lock( &a->mtx );
+    a->quit = 1;
+    pthread_cond_broadcast( &a->cvReq );
+    pthread_mutex_unlock( &a->mtx );
+    for ( k = 0; k < a->numThreads; ++k )
+      pthread_join( a->threads[k], NULL );
+    pthread_mutex_destroy( &a->mtx );
+    pthread_cond_destroy( &a->cvReq );
+    pthread_cond_destroy( &a->cvDone );
+  }
+#if defined(SRDSAIO_URING)
+  if ( a->ringFd >= 0 ) {
+    munmap( a->sqes, a->sqesSize );
+    munmap( a->cqRing, a->cqRingSize );
+    munmap( a->sqRing, a->sqRingSize );
+    close( a->ringFd );
+  }
+#endif
+  free( a->reqs );
+  free( a->freeReqs );
+  free( a->reqQ );
+  free( a->doneQ );
+  memset( a, 0, sizeof(*a) );
+}
+
+static inline
+const char * srdsAioBackend( const struct SrdsAio * a )
+{
+  return a->numThreads ? "pread threads" : "io_uring";
+}
+
+/* queues read of len bytes at off into buf. returns 0 on success, -1 if depth reads are outstanding */
+static
+int srdsAioRead( struct SrdsAio * a, int fd, void * buf, size_t len, off_t off, void * tag )
+{
+  struct SrdsAioReq * r;
+  int i;
+  if ( !a->numFree )
+    return -1;
+  i = a->freeReqs[ --a->numFree ];
+  r = &a->reqs[i];
+  r->fd = fd;
+  r->buf = buf;
+  r->len = len;
+  r->off = off;
+  r->tag = tag;
+
+#if defined(SRDSAIO_URING)
+  if ( !a->numThreads ) {
+    const unsigned tail = *a->sqTail;
+    const unsigned idx = tail & *a->sqMask;
+    struct io_uring_sqe * sqe = &a->sqes[idx];
+    r->iov.iov_base = buf;
+    r->iov.iov_len = len;
+    memset( sqe, 0, sizeof(*sqe) );
+    sqe->opcode = IORING_OP_READV;  /* oldest read opcode: kernel 5.1 */
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)&r->iov;
+    sqe->len = 1;
+    sqe->off = (uint64_t)off;
+    sqe->user_data = (uint64_t)i;
+    a->sqArray[idx] = idx;
+    __atomic_store_n( a->sqTail, tail + 1, __ATOMIC_RELEASE );
+    ++a->toSubmit;
+    return 0;
+  }
+#endif
+
+  pthread_mutex_lock( &a->mtx );
+  a->reqQ[ ( a->reqHead + a->reqCount ) % a->depth ] = i;
+  ++a->reqCount;
+  pthread_cond_signal( &a->cvReq );
+  pthread_mutex_unlock( &a->mtx );
+  return 0;
+}
+
+/*
+ * submits queued reads and waits for one completion.
+ * returns 0 with tag and result (bytes read or -errno) - or -1 on error
+ */
+static
+int srdsAioWait( struct SrdsAio * a, void ** tag, ssize_t * res )
+{
+  int i;
+#if defined(SRDSAIO_URING)
+  if ( !a->numThreads ) {
+    for (;;) {
+      const unsigned head = *a->cqHead;
+      if ( head != __atomic_load_n( a->cqTail, __ATOMIC_ACQUIRE ) ) {
+        const struct io_uring_cqe * cqe = &a->cqes[ head & *a->cqMask ];
+        i = (int)cqe->user_data;
+        *res = cqe->res;
+        __atomic_store_n( a->cqHead, head + 1, __ATOMIC_RELEASE );
+        break;
+      }
+      {
+        /* returns the number of submitted reads */
+        const long n = syscall( __NR_io_uring_enter, a->ringFd, a->toSubmit, 1, IORING_ENTER_GETEVENTS, NULL, 0 );
+        if ( n < 0 ) {
+          if ( errno == EINTR )
+            continue;
+          return -1;
+        }
+        a->toSubmit -= (unsigned)n;
+      }
+    }
+    *tag = a->reqs[i].tag;
+    a->freeReqs[ a->numFree++ ] = i;
+    return 0;
+  }
+#endif
+
+  pthread_mutex_lock( &a->mtx );
+  while ( !a->doneCount )
+    pthread_cond_wait( &a->cvDone, &a->mtx );
+  i = a->doneQ[ a->doneHead ];
+  a->doneHead = ( a->doneHead + 1 ) % a->depth;
+  --a->doneCount;
+  pthread_mutex_unlock( &a->mtx );
+  *tag = a->reqs[i].tag;
+  *res = a->reqs[i].res;
+  a->freeReqs[ a->numFree++ ] = i;
+  return 0;
+}
+
+#endif /* SRDSAIO_H */
@@ -0,0 +1,315 @@
+/*
+ * srdsbench (benchmark runner)
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * srdsbench runs a command several times and appends the best run's
+ * wall time, CPU times, peak RSS, MB/s and records/s to a CSV and/or
+ * JSON lines file - one row per call, keyed by a label - so the results
+ * of different builds can be compared. see test/bench.sh for the suite.
+ * with '-p', hardware counters (cycles, instructions, cache misses)
+ * of the command - including its threads - are read with perf_event_open().
+ * they are left empty, when not permitted (see perf_event_paranoid).
+ *
+ * Usage: see below at usage()
+ *
+ * Author:  Hayati Ayguen
+ */
+
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#define PERF_AVAILABLE  1
+#endif
+
+#define NUM_COUNTERS  3
+
+static int verboseFlag = 0;
+
+struct Run {
+  double wall, user, sys;
+  long maxRss;
+  int status;
+  int haveCounters;
+  unsigned long long counters[NUM_COUNTERS];   /* cycles, instructions, cache misses */
+};
+
+
+static
+double nowSeconds()
+{
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return (double)ts.tv_sec + 1E-9 * (double)ts.tv_nsec;
+}
+
+#ifdef PERF_AVAILABLE
+/* opens disabled counter on pid - enabled at its exec(). returns fd or -1 */
+static
+int openCounter( pid_t pid, uint64_t config )
+{
+  struct perf_event_attr pe;
+  memset( &pe, 0, sizeof(pe) );
+  pe.type = PERF_TYPE_HARDWARE;
+  pe.size = sizeof(pe);
+  pe.config = config;
+  pe.disabled = 1;
+  pe.enable_on_exec = 1;
+  pe.inherit = 1;           /* count threads and child processes */
+  pe.exclude_kernel = 1;
+  pe.exclude_hv = 1;
+  return (int)syscall( __NR_perf_event_open, &pe, pid, -1, -1, 0 );
+}
+#endif
+
+/* runs argv once. stdout of the command is discarded. returns -1 if it could not be started */
+static
+int runOnce( char ** argv, const char * stdinFn, int perfFlag, struct Run * run )
+{
+  static const uint64_t configs[NUM_COUNTERS] = {
+#ifdef PERF_AVAILABLE
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES
+#else
+    0, 0, 0
+#endif
+  };
+  int fds[NUM_COUNTERS] = { -1, -1, -1 };
+  int go[2];
+  struct rusage ru;
+  double t0;
+  pid_t pid;
+  int k, wstatus;
+  char c = 0;
+
+  memset( run, 0, sizeof(*run) );
+  if ( pipe( go ) )
+    return -1;
+  pid = fork();
+  if ( pid < 0 )
+    return -1;
+  if ( !pid ) {
+    /* child: wait until the counters are attached, then exec */
+    const int nul = open( "/dev/null", O_WRONLY );
+    close( go[1] );
+    if ( read( go[0], &c, 1 ) != 1 )
+      _exit( 127 );
+    close( go[0] );
+    if ( stdinFn ) {
+      const int in = open( stdinFn, O_RDONLY );
+      if ( in < 0 )
+        _exit( 127 );
+      dup2( in, 0 );
+      close( in );
+    }
+    if ( nul >= 0 ) {
+      dup2( nul, 1 );
+      close( nul );
+    }
+    execvp( argv[0], argv );
+    _exit( 127 );
+  }
+
+  close( go[0] );
+#ifdef PERF_AVAILABLE
+  for ( k = 0; perfFlag && k < NUM_COUNTERS; ++k ) {
+    fds[k] = openCounter( pid, configs[k] );
+    if ( fds[k] < 0 && verboseFlag )
+      fprintf(stderr, "warning: perf_event_open() of counter %d failed - not permitted or not supported\n", k);
+  }
+#else
+  (void)configs;
+  if ( perfFlag && verboseFlag )
+    fprintf(stderr, "warning: perf_event_open() is not available on this platform\n");
+#endif
+
+  t0 = nowSeconds();
+  if ( write( go[1], &c, 1 ) != 1 ) {
+    close( go[1] );
+    return -1;
+  }
+  close( go[1] );
+  if ( wait4( pid, &wstatus, 0, &ru ) != pid )
+    return -1;
+  run->wall = nowSeconds() - t0;
+  run->user = (double)ru.ru_utime.tv_sec + 1E-6 * (double)ru.ru_utime.tv_usec;
+  run->sys = (double)ru.ru_stime.tv_sec + 1E-6 * (double)ru.ru_stime.tv_usec;
+  run->maxRss = ru.ru_maxrss;
+  run->status = WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : 128 + WTERMSIG(wstatus);
+
+  run->haveCounters = perfFlag;
+  for ( k = 0; k < NUM_COUNTERS; ++k ) {
+    if ( fds[k] < 0 || read( fds[k], &run->counters[k], sizeof(run->counters[k]) ) != (ssize_t)sizeof(run->counters[k]) )
+      run->haveCounters = 0;
+    if ( fds[k] >= 0 )
+      close( fds[k] );
+  }
+  return 0;
+}
+
+/* CSV field: counter or empty */
+static
+void printCounter( FILE * f, const struct Run * run, int k, int json )
+{
+  if ( run->haveCounters )
+    fprintf(f, "%llu", run->counters[k]);
+  else if ( json )
+    fputs("null", f);
+}
+
+static
+void usage() {
+  fputs("Usage: srdsbench [-v][-h][-r <repetitions>][-p][-L <label>][-s <bytes>][-n <records>][-i <stdin>]\n", stderr);
+  fputs("                 [-o <csv>][-J <json>] -- command [args]\n", stderr);
+  fputs("  runs command repeatedly and appends the best run's times and throughput to CSV and/or JSON lines files\n", stderr);
+  fputs("  stdout of the command is discarded\n", stderr);
+  fputs("  -v     verbose output\n", stderr);
+  fputs("  -h     print usage\n",stderr);
+  fputs("  -r <v> number of repetitions. the fastest run is reported. default: 3\n", stderr);
+  fputs("  -p     read hardware counters (cycles, instructions, cache misses) with perf_event_open()\n", stderr);
+  fputs("  -L <s> label of the row, e.g. tool and parameters. default: the command\n", stderr);
+  fputs("  -s <v> number of processed bytes - for MB/s\n", stderr);
+  fputs("  -n <v> number of processed records - for records/s\n", stderr);
+  fputs("  -i <f> redirect stdin of the command from file\n", stderr);
+  fputs("  -o <f> append row to CSV file - with header, if new. '-' for stdout (default)\n", stderr);
+  fputs("  -J <f> append row as JSON line to file. '-' for stdout\n", stderr);
+}
+
+
+int main(int argc, char *argv[])
+{
+  const char * csvFn = NULL;
+  const char * jsonFn = NULL;
+  const char * stdinFn = NULL;
+  const char * label = NULL;
+  char labelBuf[1024];
+  unsigned long long numBytes = 0, numRecords = 0;
+  int numReps = 3, perfFlag = 0, helpFlag = 0;
+  int optFlag, k, ret = 0;
+  struct Run best, run;
+  double mbps, rps;
+  extern int optind;
+
+  /* parse command line options - up to '--' or the command */
+  while ((optFlag = getopt(argc, argv, "+vhr:pL:s:n:i:o:J:")) > 0 && optFlag != '?') {
+    switch(optFlag) {
+    case 'v': ++verboseFlag; break;
+    case 'h': ++helpFlag; break;
+    case 'r': numReps = atoi(optarg); break;
+    case 'p': ++perfFlag; break;
+    case 'L': label = optarg; break;
+    case 's': numBytes = strtoull(optarg, NULL, 10); break;
+    case 'n': numRecords = strtoull(optarg, NULL, 10); break;
+    case 'i': stdinFn = optarg; break;
+    case 'o': csvFn = optarg; break;
+    case 'J': jsonFn = optarg; break;
+    }
+  }
+  if (optFlag == '?' || helpFlag || optind >= argc || numReps <= 0) {
+    usage();
+    exit(2);
+  }
+  if ( !csvFn && !jsonFn )
+    csvFn = "-";
+
+  if ( !label ) {
+    /* default label: the command line */
+    size_t n = 0;
+    labelBuf[0] = 0;
+    for ( k = optind; k < argc && n + strlen(argv[k]) + 2 < sizeof(labelBuf); ++k )
+      n += (size_t)sprintf( labelBuf + n, "%s%s", n ? " " : "", argv[k] );
+    label = labelBuf;
+  }
+
+  memset( &best, 0, sizeof(best) );
+  for ( k = 0; k < numReps; ++k ) {
+    if ( runOnce( argv + optind, stdinFn, perfFlag, &run ) ) {
+      fprintf(stderr, "error starting command '%s'\n", argv[optind]);
+      return 10;
+    }
+    if ( verboseFlag )
+      fprintf(stderr, "run %d of '%s': %.3f s, exit code %d\n", k + 1, label, run.wall, run.status);
+    if ( run.status ) {
+      fprintf(stderr, "error: command '%s' exited with code %d\n", label, run.status);
+      best = run;
+      ret = 1;
+      break;
+    }
+    if ( !k || run.wall < best.wall )
+      best = run;
+  }
+
+  mbps = best.wall > 0.0 ? 1E-6 * (double)numBytes / best.wall : 0.0;
+  rps = best.wall > 0.0 ? (double)numRecords / best.wall : 0.0;
+
+  if ( csvFn ) {
+    FILE * f = strcmp( csvFn, "-" ) ? fopen( csvFn, "a" ) : stdout;
+    if ( !f ) {
+      fprintf(stderr, "error opening CSV file '%s'\n", csvFn);
+      return 8;
+    }
+    if ( f == stdout || ( !fseek( f, 0, SEEK_END ) && !ftell( f ) ) )
+      fputs("label,status,repetitions,bytes,records,wall_s,user_s,sys_s,mb_per_s,records_per_s,peak_rss_kb,cycles,instructions,cache_misses\n", f);
+    /* labels are quoted - they might contain commas */
+    fputc('"', f);
+    for ( k = 0; label[k]; ++k ) {
+      if ( label[k] == '"' )
+        fputc('"', f);
+      fputc(label[k], f);
+    }
+    fprintf(f, "\",%d,%d,%llu,%llu,%.6f,%.6f,%.6f,%.3f,%.1f,%ld,",
+            best.status, numReps, numBytes, numRecords, best.wall, best.user, best.sys, mbps, rps, best.maxRss);
+    for ( k = 0; k < NUM_COUNTERS; ++k ) {
+      printCounter( f, &best, k, 0 );
+      fputc( k + 1 < NUM_COUNTERS ? ',' : '\n', f );
+    }
+    if ( f != stdout && fclose( f ) ) {
+      fprintf(stderr, "error writing CSV file '%s'\n", csvFn);
+      return 8;
+    }
+  }
+
+  if ( jsonFn ) {
+    FILE * f = strcmp( jsonFn, "-" ) ? fopen( jsonFn, "a" ) : stdout;
+    if ( !f ) {
+      fprintf(stderr, "error opening JSON file '%s'\n", jsonFn);
+      return 8;
+    }
+    fputs("{\"label\":\"", f);
+    for ( k = 0; label[k]; ++k ) {
+      if ( label[k] == '"' || label[k] == '\\' )
+        fputc('\\', f);
+      fputc(label[k], f);
+    }
+    fprintf(f, "\",\"status\":%d,\"repetitions\":%d,\"bytes\":%llu,\"records\":%llu,"
+               "\"wall_s\":%.6f,\"user_s\":%.6f,\"sys_s\":%.6f,\"mb_per_s\":%.3f,\"records_per_s\":%.1f,\"peak_rss_kb\":%ld",
+            best.status, numReps, numBytes, numRecords, best.wall, best.user, best.sys, mbps, rps, best.maxRss);
+    fputs(",\"cycles\":", f);
+    printCounter( f, &best, 0, 1 );
+    fputs(",\"instructions\":", f);
+    printCounter( f, &best, 1, 1 );
+    fputs(",\"cache_misses\":", f);
+    printCounter( f, &best, 2, 1 );
+    fputs("}\n", f);
+    if ( f != stdout && fclose( f ) ) {
+      fprintf(stderr, "error writing JSON file '%s'\n", jsonFn);
+      return 8;
+    }
+  }
+
+  return ret;
+}
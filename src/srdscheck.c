@@ -7,14 +7,20 @@
  * srdscheck (check if raw data is sorted) is an alternative to traditional Unix
  * sort with option "-c", for sorted raw data set files.
  * Limitations / requirements:
- * 1) input fils must be sorted regular file
+ * 1) input file must be sorted. regular files, pipes or stdin ('-') are accepted
  * 2) every 'line' is a raw data set (block) - all with same fixed length
  *
+ * with option '-p' (pass-through), the input is copied to the output
+ * while checking, so srdscheck can sit inline in a pipeline, e.g.
+ *   hex2rds -i input.txt | srdscheck -l 20 -p -o output.srds
+ *
  * Usage: see below at usage()
  *
  * Author:  Hayati Ayguen
  */
 
+/* fopencookie() for the telemetry */
+#define _GNU_SOURCE
 
 #include <stddef.h>
 #include <stdlib.h>
@@ -22,6 +28,9 @@
 #include <string.h>
 #include <stdio.h>
 
+#include "srdsstat.h"
+#include "srdsio.h"
+
 static int blockSize = -1;
 static int keyBeg = 0;
 static int keyEnd = -1;
@@ -32,10 +41,11 @@ static FILE * input = NULL;
 static void * rdBuffer = NULL;
 static size_t readBlockBuf = 0;
 static unsigned char * blockBuf[2];
+static struct SrdsStat telemetry;
 
 static
 void usage() {
-  fputs("Usage: srdscheck [-v][-h][-r][-l <blockLength>][-b <keyBegin>][-e <keyEnd>] <file>\n", stderr);
+  fputs("Usage: srdscheck [-v][-h][-r][-p][-l <blockLength>][-b <keyBegin>][-e <keyEnd>][-o <output>][-D <mode>][-P <sec>][-J <json>] [<file>]\n", stderr);
   fputs("  check if raw data set is sorted\n", stderr);
   fputs("  -v     verbose output\n", stderr);
   fputs("  -h     print usage\n",stderr);
@@ -44,30 +54,53 @@ void usage() {
   fputs("  -l <v> length of each raw data set block in bytes\n", stderr);
   fputs("  -b <v> key's begin offset inside block\n", stderr);
   fputs("  -e <v> key's end offset inside block\n", stderr);
-  fputs("  file  filename required\n", stderr);
+  fputs("  -p     pass-through: copy input to output while checking\n", stderr);
+  fputs("  -o <f> output to file (in pass-through mode). default is stdout\n", stderr);
+  fputs("  -D <m> I/O mode of regular files: 'cache' (default), 'dontneed' drops the pages behind\n", stderr);
+  fputs("         or 'direct' for O_DIRECT - leaving the page cache to the lookups\n", stderr);
+  fputs("  -P <v> print progress to stderr every v seconds\n", stderr);
+  fputs("  -J <f> write summary with timing of read/process/write phases as JSON to file. '-' for stderr\n", stderr);
+  fputs("  file  input filename. '-' or no file reads stdin\n", stderr);
 }
 
 
 int main(int argc, char *argv[]) {
   FILE * out = stdout;
+  const char * outfn = NULL;
+  const char * jsonFn = NULL;
   unsigned long long dataSetNo = 0;
+  double progressInterval = 0.0;
   int optFlag;
-  int numAvailable = 0;
   int readIdx = 0;
   int helpFlag = 0;
   int revFlag = 0;
+  int passFlag = 0;
+  int ioMode = SRDSIO_CACHE;
   int cmp;
+  int ret = 0;
   size_t vBufSize = 0;
   size_t bufferSize = 0;
+  void * wrBuffer = NULL;
   extern int optind;
 
   /* parse command line options */
-  while ((optFlag = getopt(argc, argv, "vhB:rl:b:e:")) > 0 && optFlag != '?') {
+  while ((optFlag = getopt(argc, argv, "vhB:rpl:b:e:o:D:P:J:")) > 0 && optFlag != '?') {
     switch(optFlag) {
     case 'v': ++verboseFlag; break;
     case 'h': ++helpFlag; break;
     case 'B': vBufSize = (size_t)( atol(optarg) * 1024 ); break;
     case 'r': ++revFlag; break;
+    case 'p': ++passFlag; break;
+    case 'o': outfn = optarg; break;
+    case 'D':
+      ioMode = srdsIoParseMode(optarg);
+      if ( ioMode < 0 ) {
+        fprintf(stderr, "error: unknown I/O mode '%s'!\n", optarg);
+        return 10;
+      }
+      break;
+    case 'P': progressInterval = atof(optarg); break;
+    case 'J': jsonFn = optarg; break;
     case 'l':
       blockSize = atoi(optarg);
       if ( verboseFlag >= 2 )
@@ -126,30 +159,51 @@ int main(int argc, char *argv[]) {
   }
 
   bufferSize = vBufSize ? vBufSize : 65536;
+  srdsStatInit( &telemetry, "srdscheck", progressInterval, progressInterval > 0.0 || jsonFn );
 
-  /* search each input file */
-  if (optFlag < argc) {
+  /* open input file - or use stdin */
+  if (optFlag < argc && strcmp(argv[optFlag], "-")) {
     input = fopen(argv[optFlag], "rb");
     if (!input) {
         fprintf(stderr, "srdscheck:  could not open %s\n", argv[optFlag]);
         exit(2);
     }
+  }
+  else
+    input = stdin;
 
-    rdBuffer = malloc( bufferSize );
-    if (rdBuffer) setbuffer(input, rdBuffer, bufferSize);
-    blockBuf[0] = (unsigned char *)malloc( blockSize * sizeof(unsigned char) );
-    blockBuf[1] = (unsigned char *)malloc( blockSize * sizeof(unsigned char) );
-    readBlockBuf = fread(blockBuf[readIdx], blockSize, 1, input);
-    if (readBlockBuf)
-      ++dataSetNo;
-    readIdx = 1 - readIdx;
+  if ( passFlag && outfn )
+  {
+    out = fopen(outfn, "wb");
+    if (!out) {
+      fprintf(stderr, "error opening output file '%s'\n", outfn);
+      exit(8);
+    }
+  }
+
+  srdsStatInputSize( &telemetry, input );
+  input = srdsIoWrap( &telemetry, input, 0, ioMode );
+  if (passFlag)
+    out = srdsIoWrap( &telemetry, out, 1, ioMode );
+
+  rdBuffer = malloc( bufferSize );
+  if (rdBuffer) setbuffer(input, rdBuffer, bufferSize);
+  if (passFlag) {
+    wrBuffer = malloc( bufferSize );
+    if (wrBuffer) setbuffer(out, wrBuffer, bufferSize);
   }
+  blockBuf[0] = (unsigned char *)malloc( blockSize * sizeof(unsigned char) );
+  blockBuf[1] = (unsigned char *)malloc( blockSize * sizeof(unsigned char) );
 
-  /* if no input files? */
-  if (!input) {
-    fputs("srdscheck: STDIN is not accepted. input filenames required at command line!\n", stderr);
-    exit(10);
+  readBlockBuf = fread(blockBuf[readIdx], blockSize, 1, input);
+  if (readBlockBuf) {
+    if ( passFlag && !fwrite(blockBuf[readIdx], blockSize, 1, out) ) {
+      fputs("error writing to output file!\n", stderr);
+      return 7;
+    }
+    ++dataSetNo;
   }
+  readIdx = 1 - readIdx;
 
   while ( readBlockBuf )
   {
@@ -162,25 +216,60 @@ int main(int argc, char *argv[]) {
     if (!revFlag)
     {
       if (cmp > 0) {
-        if (verboseFlag)
+        if (verboseFlag || passFlag)
           fprintf(stderr, "raw data set %lu (from 0) is not in ascending order!\n", (unsigned long)dataSetNo);
-        return 1;
+        ret = 1;
+        break;
       }
     }
     else
     {
       if (cmp < 0) {
-        if (verboseFlag)
+        if (verboseFlag || passFlag)
           fprintf(stderr, "raw data set %lu (from 0) is not in descending order!\n", (unsigned long)dataSetNo);
-        return 1;
+        ret = 1;
+        break;
       }
     }
 
-    ++dataSetNo;
+    if ( passFlag && !fwrite(blockBuf[readIdx], blockSize, 1, out) ) {
+      fputs("error writing to output file!\n", stderr);
+      return 7;
+    }
+
+    readIdx = 1 - readIdx;
+    if ( !( ++dataSetNo & 0xFFFF ) )
+      srdsStatRecords( &telemetry, 65536 );
+  }
+  srdsStatRecords( &telemetry, dataSetNo & 0xFFFF );
+
+  if ( ret ) {
+    srdsStatSummary( &telemetry, jsonFn, ret );
+    return ret;
+  }
+
+  if ( ferror(input) ) {
+    fputs("error reading from input!\n", stderr);
+    return 9;
+  }
+
+  if ( passFlag ) {
+    if ( fflush(out) ) {
+      fputs("error writing to output file!\n", stderr);
+      return 7;
+    }
+    if ( out != stdout && fclose(out) ) {
+      fputs("error writing to output file!\n", stderr);
+      return 7;
+    }
   }
 
   if (verboseFlag)
     fprintf(stderr, "%lu raw data sets are order.\n", (unsigned long)dataSetNo);
 
+  if ( srdsStatSummary( &telemetry, jsonFn, 0 ) ) {
+    fprintf(stderr, "error writing summary to '%s'\n", jsonFn);
+    return 8;
+  }
   return 0;
 }
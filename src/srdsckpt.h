@@ -0,0 +1,232 @@
+/*
+ * srdsckpt.h
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * checkpoints of long running conversions and merges (hex2rds, srdsmerge):
+ * periodically, the output is flushed with fdatasync() and the position
+ * in all files is written to '<output>.ckpt' - as 'key=value' lines:
+ *   tool=<name>
+ *   blockSize=<bytes per record>
+ *   records=<number of records in output>
+ *   output=<output offset in bytes>
+ *   tail=<hexadecimal of the last blockSize bytes of the output>
+ *   input<k>=<offset in input k>
+ * plus tool specific keys.
+ * the checkpoint is written into a temporary file, which is renamed:
+ * a crash leaves the previous or the new checkpoint - never a partial one.
+ * with '--resume', the output is truncated to the checkpoint's offset,
+ * its tail is validated and all inputs continue from their offsets.
+ *
+ * Author:  Hayati Ayguen
+ */
+
+#ifndef SRDSCKPT_H
+#define SRDSCKPT_H
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+
+#define SRDSCKPT_SUFFIX   ".ckpt"
+#define SRDSCKPT_MAXKEYS  64
+
+struct SrdsCkpt {
+  int n;
+  char * key[SRDSCKPT_MAXKEYS];
+  char * val[SRDSCKPT_MAXKEYS];
+};
+
+
+/* returns malloc()ed '<outFn>.ckpt' */
+static
+char * srdsCkptName( const char * outFn )
+{
+  char * fn = (char *)malloc( strlen( outFn ) + sizeof(SRDSCKPT_SUFFIX) );
+  if ( fn ) {
+    strcpy( fn, outFn );
+    strcat( fn, SRDSCKPT_SUFFIX );
+  }
+  return fn;
+}
+
+static
+void srdsCkptPutHex( FILE * f, const char * key, const unsigned char * p, int n )
+{
+  int k;
+  fprintf(f, "%s=", key);
+  for ( k = 0; k < n; ++k )
+    fprintf(f, "%02x", p[k]);
+  fputc('\n', f);
+}
+
+/* starts writing a new checkpoint into the temporary file. returns NULL on error */
+static
+FILE * srdsCkptBegin( const char * fn, const char * tool, int blockSize )
+{
+  char tmp[4096];
+  FILE * f;
+  if ( snprintf( tmp, sizeof(tmp), "%s.tmp", fn ) >= (int)sizeof(tmp) )
+    return NULL;
+  f = fopen( tmp, "w" );
+  if ( f ) {
+    fprintf(f, "tool=%s\n", tool);
+    fprintf(f, "blockSize=%d\n", blockSize);
+  }
+  return f;
+}
+
+/* syncs and closes the temporary file, then replaces the checkpoint. returns 0 on success */
+static
+int srdsCkptCommit( FILE * f, const char * fn )
+{
+  char tmp[4096];
+  int ret = 0;
+  snprintf( tmp, sizeof(tmp), "%s.tmp", fn );
+  if ( fflush( f ) || ferror( f ) || fdatasync( fileno( f ) ) )
+    ret = -1;
+  if ( fclose( f ) )
+    ret = -1;
+  if ( !ret && rename( tmp, fn ) )
+    ret = -1;
+  if ( ret )
+    remove( tmp );
+  return ret;
+}
+
+
+static
+void srdsCkptFree( struct SrdsCkpt * c )
+{
+  int k;
+  for ( k = 0; k < c->n; ++k )
+    free( c->key[k] );   /* val points into the same allocation */
+  c->n = 0;
+}
+
+/* reads checkpoint file fn. returns 0 on success */
+static
+int srdsCkptLoad( struct SrdsCkpt * c, const char * fn )
+{
+  char line[8192];
+  FILE * f = fopen( fn, "r" );
+  memset( c, 0, sizeof(*c) );
+  if ( !f )
+    return -1;
+  while ( c->n < SRDSCKPT_MAXKEYS && fgets( line, sizeof(line), f ) ) {
+    char * eq = strchr( line, '=' );
+    char * e = line + strlen( line );
+    while ( e > line && ( e[-1] == '\n' || e[-1] == '\r' ) )
+      *--e = 0;
+    if ( !eq )
+      continue;
+    c->key[c->n] = strdup( line );
+    if ( !c->key[c->n] )
+      break;
+    c->key[c->n][ eq - line ] = 0;
+    c->val[c->n] = c->key[c->n] + ( eq - line ) + 1;
+    ++c->n;
+  }
+  fclose( f );
+  return 0;
+}
+
+/* value of key - or NULL */
+static
+const char * srdsCkptGet( const struct SrdsCkpt * c, const char * key )
+{
+  int k;
+  for ( k = 0; k < c->n; ++k )
+    if ( !strcmp( c->key[k], key ) )
+      return c->val[k];
+  return NULL;
+}
+
+/* returns 0 on success */
+static
+int srdsCkptGetU64( const struct SrdsCkpt * c, const char * key, uint64_t * v )
+{
+  const char * s = srdsCkptGet( c, key );
+  char * e;
+  if ( !s || !*s )
+    return -1;
+  *v = (uint64_t)strtoull( s, &e, 10 );
+  return *e ? -1 : 0;
+}
+
+/* decodes exactly n bytes. returns 0 on success */
+static
+int srdsCkptGetHex( const struct SrdsCkpt * c, const char * key, unsigned char * p, int n )
+{
+  const char * s = srdsCkptGet( c, key );
+  int k;
+  if ( !s || strlen( s ) != 2 * (size_t)n )
+    return -1;
+  for ( k = 0; k < n; ++k ) {
+    unsigned v;
+    if ( sscanf( s + 2 * k, "%2x", &v ) != 1 )
+      return -1;
+    p[k] = (unsigned char)v;
+  }
+  return 0;
+}
+
+/*
+ * checks tool and blockSize of the checkpoint and the output's tail at the checkpoint's offset -
+ * then truncates the output (opened for update) behind it.
+ * returns output offset - or -1 with message on stderr
+ */
+static
+int64_t srdsCkptResumeOutput( const struct SrdsCkpt * c, const char * tool, int blockSize, FILE * out )
+{
+  const char * t = srdsCkptGet( c, "tool" );
+  uint64_t bs, off;
+  unsigned char * tail = (unsigned char *)malloc( 2 * (size_t)blockSize );
+  struct stat st;
+  int64_t ret = -1;
+
+  if ( !tail )
+    return -1;
+  if ( !t || strcmp( t, tool ) || srdsCkptGetU64( c, "blockSize", &bs ) || srdsCkptGetU64( c, "output", &off ) )
+    fprintf(stderr, "error: checkpoint is not from %s!\n", tool);
+  else if ( bs != (uint64_t)blockSize )
+    fprintf(stderr, "error: checkpoint has blockSize %" PRIu64 " - not %d!\n", bs, blockSize);
+  else if ( off % blockSize || fstat( fileno( out ), &st ) || (uint64_t)st.st_size < off )
+    fprintf(stderr, "error: output is shorter than the checkpoint's offset %" PRIu64 "!\n", off);
+  else if ( off && ( srdsCkptGetHex( c, "tail", tail, blockSize )
+                     || pread( fileno( out ), tail + blockSize, blockSize, (off_t)( off - blockSize ) ) != blockSize
+                     || memcmp( tail, tail + blockSize, blockSize ) ) )
+    fprintf(stderr, "error: output's last record at offset %" PRIu64 " does not match the checkpoint!\n", off - blockSize);
+  else if ( ftruncate( fileno( out ), (off_t)off ) || fseeko( out, (off_t)off, SEEK_SET ) )
+    fprintf(stderr, "error: output could not be truncated to the checkpoint's offset %" PRIu64 "!\n", off);
+  else
+    ret = (int64_t)off;
+  free( tail );
+  return ret;
+}
+
+/* positions input fp at the checkpoint's offset of input k. returns 0 on success - or -1 with message */
+static
+int srdsCkptResumeInput( const struct SrdsCkpt * c, int k, FILE * fp, uint64_t * off )
+{
+  char key[32];
+  struct stat st;
+  snprintf( key, sizeof(key), "input%d", k );
+  if ( srdsCkptGetU64( c, key, off ) ) {
+    fprintf(stderr, "error: checkpoint has no offset for input %d!\n", k);
+    return -1;
+  }
+  if ( fstat( fileno( fp ), &st ) || !S_ISREG(st.st_mode) || (uint64_t)st.st_size < *off
+       || fseeko( fp, (off_t)*off, SEEK_SET ) ) {
+    fprintf(stderr, "error: input %d can not be positioned at the checkpoint's offset %" PRIu64 "!\n", k, *off);
+    return -1;
+  }
+  return 0;
+}
+
+#endif /* SRDSCKPT_H */
@@ -0,0 +1,211 @@
+/*
+ * srdscol.h
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * key prefix column of a sorted raw data set (srds) - from srds2col:
+ * the leading 8 bytes of every sample-th record as big endian uint64 -
+ * in one contiguous array. a binary search over the column touches
+ * 8 instead of blockSize bytes per record: the column of the full
+ * HIBP list is ~ 6.8 GB - or ~ 33 MB with one sample per 4 kB page.
+ * the last SRDSCOL_SCAN entries of the search are compared at once -
+ * with AVX2 4 entries per instruction, selected at runtime with selectColCount().
+ *
+ * file format - header little endian, column as uint64 in host byte order (little endian):
+ *   8 bytes   magic "SRDSCOL1"
+ *   4 bytes   blockSize
+ *   4 bytes   sample: number of records per entry
+ *   8 bytes   number of records
+ *   8 bytes   number of entries
+ *   uint64    column[ number of entries ]
+ *
+ * the file is mmap()ed for lookups.
+ *
+ * Author:  Hayati Ayguen
+ */
+
+#ifndef SRDSCOL_H
+#define SRDSCOL_H
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "srdsindex.h"
+
+#define SRDSCOL_MAGIC        "SRDSCOL1"
+#define SRDSCOL_HEADER_SIZE  32
+#define SRDSCOL_SCAN         32    /* entries compared at the end of the binary search */
+
+/* number of entries < x in v[0 .. n-1] */
+typedef uint64_t (*SrdsColCountFunc)( const uint64_t * v, uint64_t n, uint64_t x );
+
+struct SrdsCol {
+  void * base;
+  size_t size;
+  int blockSize;
+  int sample;
+  uint64_t numRecords;
+  uint64_t numEntries;
+  const uint64_t * col;
+  SrdsColCountFunc count;
+};
+
+
+static inline
+uint64_t srdsColNumEntries( uint64_t numRecords, int sample )
+{
+  return ( numRecords + sample - 1 ) / sample;
+}
+
+static
+uint64_t srdsColCountScalar( const uint64_t * v, uint64_t n, uint64_t x )
+{
+  uint64_t k, c = 0;
+  for ( k = 0; k < n; ++k )
+    c += ( v[k] < x );
+  return c;
+}
+
+#if defined(__GNUC__) && defined(__SSE2__) && ( defined(__x86_64__) || defined(__i386__) )
+#define SRDSCOL_AVX2  1
+#include <x86intrin.h>
+
+__attribute__((target("avx2,popcnt")))
+static uint64_t srdsColCountAVX2( const uint64_t * v, uint64_t n, uint64_t x )
+{
+  /* AVX2 compares signed: flip the sign bits for the unsigned order */
+  const __m256i sign = _mm256_set1_epi64x( (long long)UINT64_C(0x8000000000000000) );
+  const __m256i xs = _mm256_xor_si256( _mm256_set1_epi64x( (long long)x ), sign );
+  uint64_t k, c = 0;
+  for ( k = 0; k + 4 <= n; k += 4 ) {
+    const __m256i vs = _mm256_xor_si256( _mm256_loadu_si256( (const __m256i *)( v + k ) ), sign );
+    const __m256i lt = _mm256_cmpgt_epi64( xs, vs );
+    c += (uint64_t)__builtin_popcount( _mm256_movemask_pd( _mm256_castsi256_pd( lt ) ) );
+  }
+  return c + srdsColCountScalar( v + k, n - k, x );
+}
+#endif
+
+static
+SrdsColCountFunc selectColCount( int verboseFlag )
+{
+#if defined(SRDSCOL_AVX2)
+  __builtin_cpu_init();
+  if ( __builtin_cpu_supports("avx2") ) {
+    if ( verboseFlag )
+      fprintf(stderr, "info: using AVX2 key column compare\n");
+    return srdsColCountAVX2;
+  }
+#endif
+  if ( verboseFlag )
+    fprintf(stderr, "info: using scalar key column compare\n");
+  return srdsColCountScalar;
+}
+
+static
+int srdsColWriteHeader( FILE * fp, int blockSize, int sample, uint64_t numRecords )
+{
+  unsigned char h[SRDSCOL_HEADER_SIZE];
+  memcpy( h, SRDSCOL_MAGIC, 8 );
+  putLE32( h + 8, (uint32_t)blockSize );
+  putLE32( h + 12, (uint32_t)sample );
+  putLE64( h + 16, numRecords );
+  putLE64( h + 24, srdsColNumEntries( numRecords, sample ) );
+  return fwrite( h, SRDSCOL_HEADER_SIZE, 1, fp ) == 1 ? 0 : -1;
+}
+
+/* maps file. returns 0 on success */
+static
+int srdsColOpen( struct SrdsCol * c, const char * fn, int verboseFlag )
+{
+  const unsigned char * h;
+  struct stat st;
+  int fd;
+
+  memset( c, 0, sizeof(*c) );
+  fd = open( fn, O_RDONLY );
+  if ( fd < 0 )
+    return -1;
+  if ( fstat( fd, &st ) || st.st_size < SRDSCOL_HEADER_SIZE ) {
+    close( fd );
+    return -1;
+  }
+  c->size = (size_t)st.st_size;
+  c->base = mmap( NULL, c->size, PROT_READ, MAP_SHARED, fd, 0 );
+  close( fd );
+  if ( c->base == MAP_FAILED ) {
+    c->base = NULL;
+    return -1;
+  }
+  h = (const unsigned char *)c->base;
+  c->blockSize = (int)getLE32( h + 8 );
+  c->sample = (int)getLE32( h + 12 );
+  c->numRecords = getLE64( h + 16 );
+  c->numEntries = getLE64( h + 24 );
+  if ( memcmp( h, SRDSCOL_MAGIC, 8 ) || c->blockSize <= 0 || c->sample <= 0
+       || c->numEntries != srdsColNumEntries( c->numRecords, c->sample )
+       || c->size != SRDSCOL_HEADER_SIZE + 8 * c->numEntries ) {
+    munmap( c->base, c->size );
+    c->base = NULL;
+    return -1;
+  }
+  c->col = (const uint64_t *)( h + SRDSCOL_HEADER_SIZE );
+  c->count = selectColCount( verboseFlag );
+  return 0;
+}
+
+static
+void srdsColClose( struct SrdsCol * c )
+{
+  if ( c->base )
+    munmap( c->base, c->size );
+  c->base = NULL;
+}
+
+/* number of entries < x: binary search down to SRDSCOL_SCAN entries, then compare these at once */
+static inline
+uint64_t srdsColRank( const struct SrdsCol * c, uint64_t x )
+{
+  uint64_t lo = 0, n = c->numEntries;
+  while ( n > SRDSCOL_SCAN ) {
+    const uint64_t half = n / 2;
+    if ( c->col[ lo + half ] < x ) {
+      lo += half + 1;
+      n -= half + 1;
+    }
+    else
+      n = half;
+  }
+  return lo + c->count( c->col + lo, n, x );
+}
+
+/*
+ * range of records [ *first, *last ), which holds all records starting with key.
+ * keyLen might be shorter than 8 bytes
+ */
+static
+void srdsColLookup( const struct SrdsCol * c, const unsigned char * key, int keyLen,
+                    uint64_t * first, uint64_t * last )
+{
+  const uint64_t lo = keyPrefix64( key, keyLen, 0x00 );
+  const uint64_t hi = keyPrefix64( key, keyLen, 0xFF );
+  const uint64_t S = (uint64_t)c->sample;
+  /* entries 0 .. p-1 are below lo: so is their record - the first match is behind */
+  const uint64_t p = srdsColRank( c, lo );
+  /* entries q .. are above hi: so are all records from their record */
+  const uint64_t q = ( hi == UINT64_MAX ) ? c->numEntries : srdsColRank( c, hi + 1 );
+  *first = p ? ( p - 1 ) * S + 1 : 0;
+  *last = q * S;
+  if ( *last > c->numRecords )
+    *last = c->numRecords;
+  if ( *first > *last )
+    *first = *last;
+}
+
+#endif /* SRDSCOL_H */
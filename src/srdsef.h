@@ -0,0 +1,220 @@
+/*
+ * srdsef.h
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * Elias-Fano representation of a sorted raw data set (srds) - from srds2ef:
+ * the leading 64 bits of each (big endian) record are split into
+ *   'upper' = value >> lowBits  and  'low' = the lowBits remaining bits,
+ * with lowBits ~ log2( 2^64 / n ).
+ * the upper parts are unary coded into a bit vector: element i sets bit ( upper_i + i ).
+ * so bucket h (all elements with upper == h) follows the h-th '0' bit.
+ * the low parts are packed with lowBits bits each.
+ * in total ~ 2 + lowBits bits per record, e.g. ~ 36 bits with 850 million SHA-1s.
+ * optionally, the following residualBytes bytes of each record are stored for exact verification.
+ *
+ * every SRDSEF_SAMPLE-th '0' bit position is sampled, so that the successor
+ * query - the number of elements < x - needs to scan only a few words.
+ *
+ * file format - header little endian, arrays of uint64 in host byte order (little endian):
+ *   8 bytes   magic "SRDSEF01"
+ *   4 bytes   lowBits
+ *   4 bytes   residualBytes
+ *   8 bytes   number of records n
+ *   8 bytes   number of bits in upper bit vector
+ *   8 bytes   number of samples
+ *   uint64    upper[ ( upperBits + 63 ) / 64 ]
+ *   uint64    samples[ numSamples ]
+ *   uint64    lows[ ( n * lowBits + 63 ) / 64 + 1 ]
+ *   n * residualBytes bytes
+ *
+ * the file is mmap()ed for lookups.
+ *
+ * Author:  Hayati Ayguen
+ */
+
+#ifndef SRDSEF_H
+#define SRDSEF_H
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "srdsindex.h"
+
+#define SRDSEF_MAGIC        "SRDSEF01"
+#define SRDSEF_HEADER_SIZE  40
+#define SRDSEF_SAMPLE       256
+#define SRDSEF_MAX_LOWBITS  56
+
+/* sizes of the sections in uint64 words */
+static inline
+uint64_t srdsEFUpperWords( uint64_t upperBits )  { return ( upperBits + 63 ) / 64; }
+
+static inline
+uint64_t srdsEFLowWords( uint64_t n, int lowBits )  { return ( n * lowBits + 63 ) / 64 + 1; }
+
+/* number of upper bits for n elements */
+static inline
+uint64_t srdsEFUpperBits( uint64_t n, int lowBits )  { return n + ( (uint64_t)1 << ( 64 - lowBits ) ); }
+
+static inline
+uint64_t srdsEFNumSamples( int lowBits )
+{
+  return ( ( (uint64_t)1 << ( 64 - lowBits ) ) + SRDSEF_SAMPLE - 1 ) / SRDSEF_SAMPLE;
+}
+
+/* lowBits ~ floor( log2( 2^64 / n ) ) */
+static inline
+int srdsEFLowBits( uint64_t n )
+{
+  int L = ( n > 1 ) ? 64 - ( 64 - __builtin_clzll( n - 1 ) ) : 64;
+  return ( L > SRDSEF_MAX_LOWBITS ) ? SRDSEF_MAX_LOWBITS : L;
+}
+
+
+struct SrdsEF {
+  void * base;
+  size_t size;
+  uint64_t n;
+  int lowBits;
+  int residualBytes;
+  uint64_t upperBits;
+  uint64_t numSamples;
+  const uint64_t * upper;
+  const uint64_t * samples;
+  const uint64_t * lows;
+  const unsigned char * resid;
+};
+
+/* maps file. returns 0 on success */
+static
+int srdsEFOpen( struct SrdsEF * ef, const char * fn )
+{
+  const unsigned char * h;
+  struct stat st;
+  uint64_t expSize;
+  int fd;
+
+  memset( ef, 0, sizeof(*ef) );
+  fd = open( fn, O_RDONLY );
+  if ( fd < 0 )
+    return -1;
+  if ( fstat( fd, &st ) || st.st_size < SRDSEF_HEADER_SIZE ) {
+    close( fd );
+    return -1;
+  }
+  ef->size = (size_t)st.st_size;
+  ef->base = mmap( NULL, ef->size, PROT_READ, MAP_SHARED, fd, 0 );
+  close( fd );
+  if ( ef->base == MAP_FAILED ) {
+    ef->base = NULL;
+    return -1;
+  }
+  h = (const unsigned char *)ef->base;
+  ef->lowBits = (int)getLE32( h + 8 );
+  ef->residualBytes = (int)getLE32( h + 12 );
+  ef->n = getLE64( h + 16 );
+  ef->upperBits = getLE64( h + 24 );
+  ef->numSamples = getLE64( h + 32 );
+  if ( memcmp( h, SRDSEF_MAGIC, 8 ) || ef->lowBits < 0 || ef->lowBits > SRDSEF_MAX_LOWBITS
+       || ef->upperBits != srdsEFUpperBits( ef->n, ef->lowBits )
+       || ef->numSamples != srdsEFNumSamples( ef->lowBits ) )
+    return -1;
+  expSize = SRDSEF_HEADER_SIZE + 8 * ( srdsEFUpperWords( ef->upperBits ) + ef->numSamples
+                                       + srdsEFLowWords( ef->n, ef->lowBits ) )
+            + ef->n * ef->residualBytes;
+  if ( expSize != ef->size )
+    return -1;
+  ef->upper = (const uint64_t *)( h + SRDSEF_HEADER_SIZE );
+  ef->samples = ef->upper + srdsEFUpperWords( ef->upperBits );
+  ef->lows = ef->samples + ef->numSamples;
+  ef->resid = (const unsigned char *)( ef->lows + srdsEFLowWords( ef->n, ef->lowBits ) );
+  return 0;
+}
+
+static
+void srdsEFClose( struct SrdsEF * ef )
+{
+  if ( ef->base )
+    munmap( ef->base, ef->size );
+  ef->base = NULL;
+}
+
+/* low bits of element i */
+static inline
+uint64_t srdsEFLow( const struct SrdsEF * ef, uint64_t i )
+{
+  const uint64_t bit = i * ef->lowBits;
+  uint64_t v;
+  if ( !ef->lowBits )
+    return 0;
+  memcpy( &v, (const unsigned char *)ef->lows + bit / 8, 8 );
+  return ( v >> ( bit % 8 ) ) & ( ( (uint64_t)1 << ef->lowBits ) - 1 );
+}
+
+static inline
+int srdsEFBit( const struct SrdsEF * ef, uint64_t pos )
+{
+  return (int)( ( ef->upper[ pos / 64 ] >> ( pos % 64 ) ) & 1 );
+}
+
+/* bit position of the z-th '0' bit (counted from 0) in the upper bit vector */
+static inline
+uint64_t srdsEFSelect0( const struct SrdsEF * ef, uint64_t z )
+{
+  uint64_t pos = ef->samples[ z / SRDSEF_SAMPLE ];
+  uint64_t rem = z % SRDSEF_SAMPLE;
+  uint64_t w = ~ef->upper[ pos / 64 ] & ( ~(uint64_t)0 << ( pos % 64 ) );
+  uint64_t wi = pos / 64;
+  int c;
+  while ( ( c = __builtin_popcountll( w ) ) <= (int)rem ) {
+    rem -= c;
+    w = ~ef->upper[ ++wi ];
+  }
+  while ( rem-- )
+    w &= w - 1;
+  return wi * 64 + __builtin_ctzll( w );
+}
+
+/*
+ * successor query: the number of elements < x.
+ * *pos receives the upper bit position of that element
+ */
+static inline
+uint64_t srdsEFRank( const struct SrdsEF * ef, uint64_t x, uint64_t * pos )
+{
+  const uint64_t h = x >> ef->lowBits;
+  const uint64_t lowx = ef->lowBits ? ( x & ( ( (uint64_t)1 << ef->lowBits ) - 1 ) ) : 0;
+  uint64_t p = h ? srdsEFSelect0( ef, h - 1 ) + 1 : 0;
+  uint64_t i = p - h;
+  while ( srdsEFBit( ef, p ) && srdsEFLow( ef, i ) < lowx ) {
+    ++p;
+    ++i;
+  }
+  if ( pos )
+    *pos = p;
+  return i;
+}
+
+/*
+ * element at upper bit position *pos / index *idx - and advance both to the next element.
+ * *pos may point to '0' bits before the element.
+ */
+static inline
+uint64_t srdsEFNext( const struct SrdsEF * ef, uint64_t * pos, uint64_t * idx )
+{
+  uint64_t v;
+  while ( !srdsEFBit( ef, *pos ) )
+    ++*pos;
+  v = ( ( *pos - *idx ) << ef->lowBits ) | srdsEFLow( ef, *idx );
+  ++*pos;
+  ++*idx;
+  return v;
+}
+
+#endif /* SRDSEF_H */
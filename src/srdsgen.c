@@ -0,0 +1,169 @@
+/*
+ * srdsgen (sorted raw data set generator)
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * srdsgen writes deterministic synthetic data for the benchmarks (see test/bench.sh):
+ * N records of fixed length - binary or as hexadecimal text lines,
+ * optionally with a skewed ':COUNT' column like the HIBP lists.
+ * sorted records are generated in order - without sorting: the leading
+ * 64 bits grow by random gaps, spread uniformly over the key space.
+ * the same seed always produces the same data.
+ *
+ * Usage: see below at usage()
+ *
+ * Author:  Hayati Ayguen
+ */
+
+/* large file support */
+
+#ifdef _AIX
+#define _LARGE_FILES
+#else
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#define MAXBLOCKSIZE  4096
+
+static int blockSize = 20;
+static uint64_t rngState = 1;
+
+
+/* splitmix64 */
+static inline
+uint64_t rnd64()
+{
+  uint64_t z = ( rngState += UINT64_C(0x9E3779B97F4A7C15) );
+  z = ( z ^ ( z >> 30 ) ) * UINT64_C(0xBF58476D1CE4E5B9);
+  z = ( z ^ ( z >> 27 ) ) * UINT64_C(0x94D049BB133111EB);
+  return z ^ ( z >> 31 );
+}
+
+/* heavy tailed count: most are small, few are huge - as the HIBP prevalence */
+static inline
+uint64_t rndCount()
+{
+  const int bits = (int)( rnd64() % 25 );
+  return 1 + ( bits ? ( rnd64() >> ( 64 - bits ) ) >> ( rnd64() % ( bits + 1 ) ) : 0 );
+}
+
+static
+void usage() {
+  fputs("Usage: srdsgen [-v][-h][-n <records>][-l <blockLength>][-s <seed>][-u][-x][-c][-B <bufferSize>] [-o <output>]\n", stderr);
+  fputs("  generates deterministic synthetic raw data sets - for benchmarks\n", stderr);
+  fputs("  -v     verbose output\n", stderr);
+  fputs("  -h     print usage\n",stderr);
+  fputs("  -n <v> number of records. default: 1000000\n", stderr);
+  fputs("  -l <v> length of each raw data set block in bytes. default: 20\n", stderr);
+  fputs("  -s <v> seed of the pseudo random generator. default: 1\n", stderr);
+  fputs("  -u     unsorted: random order. default: ascending order\n", stderr);
+  fputs("  -x     output hexadecimal text lines (upper case) - as input for hex2rds\n", stderr);
+  fputs("  -c     append skewed ':COUNT' to each text line. implies '-x'\n", stderr);
+  fputs("  -B <v> bufferSize in kBytes\n", stderr);
+  fputs("  -o <f> output to file. default is stdout\n", stderr);
+}
+
+
+int main(int argc, char *argv[])
+{
+  static const char hexDigits[] = "0123456789ABCDEF";
+  FILE * out = stdout;
+  const char * outfn = NULL;
+  unsigned long long numRecords = 1000000, r;
+  uint64_t prefix = 0, step;
+  int helpFlag = 0, verboseFlag = 0;
+  int unsortedFlag = 0, hexFlag = 0, countFlag = 0;
+  int optFlag, k;
+  size_t vBufSize = 0;
+  void * wrBuffer = NULL;
+  unsigned char rec[MAXBLOCKSIZE];
+  char line[2 * MAXBLOCKSIZE + 32];
+  extern int optind;
+
+  /* parse command line options */
+  while ((optFlag = getopt(argc, argv, "vhn:l:s:uxcB:o:")) > 0 && optFlag != '?') {
+    switch(optFlag) {
+    case 'v': ++verboseFlag; break;
+    case 'h': ++helpFlag; break;
+    case 'n': numRecords = strtoull(optarg, NULL, 10); break;
+    case 'l': blockSize = atoi(optarg); break;
+    case 's': rngState = strtoull(optarg, NULL, 10); break;
+    case 'u': ++unsortedFlag; break;
+    case 'x': ++hexFlag; break;
+    case 'c': ++countFlag; ++hexFlag; break;
+    case 'B': vBufSize = (size_t)( atol(optarg) * 1024 ); break;
+    case 'o': outfn = optarg; break;
+    }
+  }
+  if (optFlag == '?' || helpFlag || optind != argc) {
+    usage();
+    exit(2);
+  }
+  if ( blockSize <= 0 || blockSize > MAXBLOCKSIZE ) {
+    fprintf(stderr, "error: blockSize %d must be 1 .. %d !\n", blockSize, MAXBLOCKSIZE);
+    return 10;
+  }
+
+  if ( outfn ) {
+    out = fopen(outfn, "wb");
+    if (!out) {
+      fprintf(stderr, "error opening output file '%s'\n", outfn);
+      return 10;
+    }
+  }
+  wrBuffer = malloc( vBufSize ? vBufSize : 1024 * 1024 );
+  if (wrBuffer) setbuffer( out, wrBuffer, vBufSize ? vBufSize : 1024 * 1024 );
+
+  /* mean gap between the leading 64 bits. gaps are >= 1: strictly ascending for blockSize >= 8 */
+  step = numRecords ? UINT64_MAX / ( numRecords + numRecords / 16 + 1 ) : 1;
+  if ( !step )
+    step = 1;
+
+  for ( r = 0; r < numRecords; ++r ) {
+    if ( unsortedFlag ) {
+      for ( k = 0; k < blockSize; ++k )
+        rec[k] = (unsigned char)( rnd64() >> 56 );
+    }
+    else {
+      const uint64_t gap = 1 + ( step > 1 ? rnd64() % ( 2 * step - 1 ) : 0 );
+      prefix = ( prefix > UINT64_MAX - gap ) ? UINT64_MAX : prefix + gap;
+      for ( k = 0; k < blockSize; ++k )
+        rec[k] = (unsigned char)( k < 8 ? prefix >> ( 56 - 8 * k ) : rnd64() >> 56 );
+    }
+
+    if ( hexFlag ) {
+      int n = 0;
+      for ( k = 0; k < blockSize; ++k ) {
+        line[n++] = hexDigits[ rec[k] >> 4 ];
+        line[n++] = hexDigits[ rec[k] & 15 ];
+      }
+      if ( countFlag )
+        n += sprintf( line + n, ":%llu", (unsigned long long)rndCount() );
+      line[n++] = '\n';
+      if ( fwrite( line, n, 1, out ) != 1 )
+        break;
+    }
+    else if ( fwrite( rec, blockSize, 1, out ) != 1 )
+      break;
+  }
+
+  if ( r < numRecords || fflush(out) ) {
+    fprintf(stderr, "error writing to output!\n");
+    return 8;
+  }
+  if ( out != stdout ) {
+    fclose(out);
+    free( wrBuffer );
+  }
+  if ( verboseFlag )
+    fprintf(stderr, "generated %llu records of %d bytes\n", numRecords, blockSize);
+  return 0;
+}
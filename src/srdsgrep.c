@@ -55,12 +55,25 @@
 #endif
 
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
 #include <ctype.h>
 #include <stdio.h>
+#include <pthread.h>
+
+#include "hexcodec.h"
+#include "srdsindex.h"
+#include "srdsef.h"
+#include "srdsshard.h"
+#include "srdshot.h"
+#include "srdspgm.h"
+#include "srdstree.h"
+#include "srdscol.h"
+#include "srdsaio.h"
+#include "srdsilv.h"
 
 #define DBGOUT  0
 
@@ -68,11 +81,21 @@ static int blockSize = -1;
 static int keyBeg = 0;
 static int keyEnd = -1;
 static int keyLen = -1;
-static size_t readBlockBuf = 0;
 static int verboseFlag = 0;
+static int hexOutFlag = 0;
+
+/* per thread: several files are searched concurrently - see fileWorker() */
+static __thread size_t readBlockBuf = 0;
+static __thread unsigned char * keyBuf = NULL;
+static __thread unsigned char * blockBuf = NULL;
+static __thread char * hexBuf = NULL;
+static __thread struct SrdsTree * tree = NULL;  /* of the current file */
+static __thread FILE * outFp = NULL;            /* stdout - or the memory stream of the file */
 
-static unsigned char * keyBuf = NULL;
-static unsigned char * blockBuf = NULL;
+static EncodeHexFunc encodeHex = NULL;
+static struct SrdsHotTable * hot = NULL;
+static struct SrdsPgm * pgm = NULL;
+static struct SrdsCol * col = NULL;
 
 /* returns length in number of hexadecimal digits - might be odd! */
 static
@@ -161,6 +184,62 @@ int convertHash( const char * s, size_t maxBinLen, unsigned char * bin )
 }
 
 
+/*
+ * reads all non-empty lines of the key file (option -f).
+ * returns array of lines - or NULL on error
+ */
+static char **
+readKeyFile(const char *fn, int *numKeys)
+{
+  FILE *fp = strcmp(fn, "-") ? fopen(fn, "r") : stdin;
+  char **lines = NULL;
+  char line[4096];
+  int cap = 0;
+
+  *numKeys = 0;
+  if (!fp)
+    return NULL;
+  while (fgets(line, sizeof(line), fp)) {
+    size_t len = strcspn(line, "\r\n");
+    line[len] = 0;
+    if (!len)
+      continue;
+    if (*numKeys == cap) {
+      char **p;
+      cap = cap ? 2 * cap : 1024;
+      p = (char **)realloc(lines, cap * sizeof(char *));
+      if (!p)
+        break;
+      lines = p;
+    }
+    lines[*numKeys] = strdup(line);
+    if (!lines[*numKeys])
+      break;
+    ++*numKeys;
+  }
+  if (ferror(fp) || !feof(fp)) {
+    free(lines);
+    lines = NULL;
+  }
+  if (fp != stdin)
+    fclose(fp);
+  return lines;
+}
+
+/* sets keyBuf from key file line - padded with 0 or cut to keyLen */
+static void
+setKey(const char *line, int hexFlag)
+{
+  memset( keyBuf, 0, keyLen );
+  if (hexFlag)
+    convertHash( line, keyLen, keyBuf );
+  else {
+    size_t len = strlen(line);
+    memcpy( keyBuf, line, ( len < (size_t)keyLen ) ? len : (size_t)keyLen );
+  }
+}
+
+
 static inline
 int compare(FILE *fp)
 {
@@ -174,18 +253,13 @@ int compare(FILE *fp)
 
 /*
  * Use binary search to find the first matching line and return
- * its byte position.
+ * its byte position. search is restricted to blocks at offsets low .. high
  */
 
 static off_t
-binsrch(FILE *fp, int reverse) {
-    off_t low, med, high, prev = -1, ret = -1;
+binsrch(FILE *fp, int reverse, off_t low, off_t high) {
+    off_t med, prev = -1, ret = -1;
     int cmp;
-    struct stat st;
-
-    fstat(fileno(fp), &st);
-    high = st.st_size - blockSize;
-    low = 0;
     while (low <= high) {
         med = (high + low) / 2;
         /* to start of next line if not at beginning of file */
@@ -227,9 +301,97 @@ binsrch(FILE *fp, int reverse) {
     return ret;
 }
 
-/* print all lines that match the key or else just the number of matches */
+/*
+ * offsets of first and last block to search: the whole file -
+ * or the key's leaves from the static search tree of the file
+ * or the key's range from the prefix bucket index idxFp
+ * or the predicted window of the learned index pgm
+ * or the window from the key prefix column col
+ */
+static int
+searchRange(FILE *fp, FILE *idxFp, const char *fname, off_t *low, off_t *high) {
+    struct stat st;
+    uint64_t first, last, numRecords;
+
+    fstat(fileno(fp), &st);
+    *low = 0;
+    *high = st.st_size - blockSize;
+    if (tree) {
+        *low = (off_t)tree->dataOffset;
+        /* tree keys start at offset 0: else bisect all records */
+        if (keyBeg != 0)
+            return 0;
+        srdsTreeLookup(tree, keyBuf, keyLen, &first, &last);
+        *low = (off_t)(tree->dataOffset + first * blockSize);
+        *high = (off_t)(tree->dataOffset + last * blockSize) - blockSize;
+#if DBGOUT
+        fprintf(stderr, "searchRange(): tree leaves hold records %u .. %u\n", (unsigned)first, (unsigned)last);
+#endif
+        return 0;
+    }
+    if (pgm) {
+        if (keyBeg != 0 || (off_t)(pgm->numRecords * blockSize) != st.st_size) {
+            static int warnedPgm = 0;
+            if (!warnedPgm++)
+              fprintf(stderr, "srdsgrep: learned index does not match %s - searching whole file\n", fname ? fname : "STDIN");
+            return -1;
+        }
+        srdsPgmLookup(pgm, keyBuf, keyLen, &first, &last);
+        *low = (off_t)(first * blockSize);
+        *high = (off_t)(last * blockSize) - blockSize;
+#if DBGOUT
+        fprintf(stderr, "searchRange(): predicted records %u .. %u\n", (unsigned)first, (unsigned)last);
+#endif
+        return 0;
+    }
+    if (col) {
+        if (keyBeg != 0 || (off_t)(col->numRecords * blockSize) != st.st_size) {
+            static int warnedCol = 0;
+            if (!warnedCol++)
+              fprintf(stderr, "srdsgrep: key prefix column does not match %s - searching whole file\n", fname ? fname : "STDIN");
+            return -1;
+        }
+        srdsColLookup(col, keyBuf, keyLen, &first, &last);
+        *low = (off_t)(first * blockSize);
+        *high = (off_t)(last * blockSize) - blockSize;
+#if DBGOUT
+        fprintf(stderr, "searchRange(): column window records %u .. %u\n", (unsigned)first, (unsigned)last);
+#endif
+        return 0;
+    }
+    if (!idxFp)
+        return 0;
+    if (keyBeg != 0
+        || srdsIndexLookup(idxFp, blockSize, keyBuf, keyLen, &first, &last, &numRecords)
+        || (off_t)(numRecords * blockSize) != st.st_size) {
+        static int warned = 0;
+        if (!warned++)
+          fprintf(stderr, "srdsgrep: index does not match %s - searching whole file\n", fname ? fname : "STDIN");
+        return -1;
+    }
+    *low = (off_t)(first * blockSize);
+    *high = (off_t)(last * blockSize) - blockSize;
+#if DBGOUT
+    fprintf(stderr, "searchRange(): records %u .. %u\n", (unsigned)first, (unsigned)last);
+#endif
+    return 0;
+}
+
+/* print the number of matches - with label, e.g. the key or the filename */
 
 static void
+printcount(const char *label, int count)
+{
+  if (label) {
+    fputs(label, outFp);
+    fputc(':', outFp);
+  }
+  fprintf(outFp, "%d\n", count);
+}
+
+/* print all lines that match the key. returns number of matches */
+
+static int
 printmatch(FILE *fp, off_t start,
     const char *fname, int cflag, int maxcount)
 {
@@ -242,20 +404,29 @@ printmatch(FILE *fp, off_t start,
       ++count;
 #if 0
       if (!cflag && fname) {
-        fputs(fname, stdout);
-        fputc(':', stdout);
+        fputs(fname, outFp);
+        fputc(':', outFp);
       }
 #endif
       start += blockSize;
-      if (readBlockBuf && !cflag)
+      if (readBlockBuf && !cflag && hexOutFlag)
+      {
+        encodeHex( blockBuf, blockSize, hexBuf, hexOutFlag >= 2 );
+        hexBuf[2*blockSize] = '\n';
+        if ( fwrite( hexBuf, 2*blockSize+1, 1, outFp ) != 1 ) {
+          fprintf(stderr, "Error writing all matches to output!\n");
+          break;
+        }
+      }
+      else if (readBlockBuf && !cflag)
       {
-        size_t w = fwrite( blockBuf, blockSize, 1, stdout );
+        size_t w = fwrite( blockBuf, blockSize, 1, outFp );
         if ( w != 1 ) {
           fprintf(stderr, "Error writing all matches to output!\n");
           break;
         }
 #if DBGOUT
-fprintf(stdout, "\n");
+fprintf(outFp, "\n");
 #endif
       }
       if (feof(fp)) {
@@ -265,30 +436,826 @@ fprintf(stdout, "\n");
     else
       break;
   }
+  return count;
+}
+
+/*
+ * search in the Elias-Fano representation (from srds2ef) - in memory:
+ * the successor query delivers the first record >= key in the leading 64 bits.
+ * key bytes beyond are compared with the residual bytes - as far as stored.
+ * matching records are output with 8 + residualBytes bytes.
+ * returns number of matches or -1 on error
+ */
+static int
+efgrep(const char *efFn, int cflag, int maxcount, const char *label)
+{
+  struct SrdsEF ef;
+  uint64_t lo, hi, pos, idx;
+  unsigned char * rec;
+  char * hex;
+  int recLen, cmpLen, count = 0;
+
+  if (srdsEFOpen(&ef, efFn)) {
+    fprintf(stderr, "srdsgrep: could not open Elias-Fano file %s\n", efFn);
+    srdsEFClose(&ef);
+    return -1;
+  }
+  recLen = 8 + ef.residualBytes;
+  cmpLen = ( keyLen < recLen ) ? keyLen : recLen;
+  if (keyLen > recLen && verboseFlag)
+    fprintf(stderr, "srdsgrep: key bytes beyond %d are not stored in %s - matches are not verified\n", recLen, efFn);
+  rec = (unsigned char *)malloc( recLen );
+  hex = (char *)malloc( 2 * recLen + 1 );
+
+  lo = keyPrefix64( keyBuf, keyLen, 0x00 );
+  hi = keyPrefix64( keyBuf, keyLen, 0xFF );
+  idx = srdsEFRank( &ef, lo, &pos );
+  for ( ; idx < ef.n && ( maxcount < 0 || count < maxcount ); ) {
+    const uint64_t v = srdsEFNext( &ef, &pos, &idx );
+    int k, cmp = 0;
+    if ( v > hi )
+      break;
+    for ( k = 0; k < 8; ++k )
+      rec[k] = (unsigned char)( v >> ( 56 - 8 * k ) );
+    memcpy( rec + 8, ef.resid + ( idx - 1 ) * ef.residualBytes, ef.residualBytes );
+    if ( cmpLen > 8 )
+      cmp = memcmp( keyBuf + 8, rec + 8, cmpLen - 8 );
+    if ( cmp < 0 )
+      break;
+    if ( cmp > 0 )
+      continue;
+    ++count;
+    if (cflag)
+      continue;
+    if (hexOutFlag) {
+      encodeHex( rec, recLen, hex, hexOutFlag >= 2 );
+      hex[2*recLen] = '\n';
+      k = ( fwrite( hex, 2*recLen+1, 1, outFp ) == 1 );
+    }
+    else
+      k = ( fwrite( rec, recLen, 1, outFp ) == 1 );
+    if (!k) {
+      fprintf(stderr, "Error writing all matches to output!\n");
+      break;
+    }
+  }
+  if (cflag)
+    printcount(label, count);
+
+  free(rec);
+  free(hex);
+  srdsEFClose(&ef);
+  return count;
+}
+
+/*
+ * search in the shards of a manifest (from srdssplit):
+ * the key's prefix routes directly to the shard - if the key is shorter than
+ * the prefix, all shards of the padded key range are searched.
+ * shard files are opened on first use.
+ * returns number of matches or -1 on error
+ */
+static int
+shardgrep(struct SrdsManifest *m, void **shardBufs, size_t bufferSize,
+    int cflag, int maxcount, const char *label)
+{
+  const int first = srdsManifestFind(m, srdsManifestPrefix(m, keyBuf, keyLen, 0x00));
+  const int last = srdsManifestFind(m, srdsManifestPrefix(m, keyBuf, keyLen, 0xFF));
+  int s, count = 0;
+
+  for (s = first; s >= 0 && s <= last && ( maxcount < 0 || count < maxcount ); ++s) {
+    struct SrdsShard *shard = &m->shards[s];
+    off_t where;
+    if (!shard->numRecords)
+      continue;
+    if (!shard->fp) {
+      shard->fp = fopen(shard->path, "rb");
+      if (!shard->fp) {
+        fprintf(stderr, "srdsgrep: could not open shard %s\n", shard->path);
+        return -1;
+      }
+      shardBufs[s] = malloc( bufferSize );
+      if (shardBufs[s]) setbuffer( shard->fp, (char *)shardBufs[s], bufferSize );
+    }
+    where = binsrch(shard->fp, 0, 0, (off_t)( ( shard->numRecords - 1 ) * blockSize ));
+    count += printmatch(shard->fp, where, label, cflag, ( maxcount < 0 ) ? -1 : maxcount - count);
+  }
+  if (cflag)
+    printcount(label, count);
+  return count;
+}
+
+/*
+ * resolve the key from the hot hash sidecar (from hex2rds -H) - without file access.
+ * only full length keys at offset 0 are in the sidecar.
+ * returns number of matches - or -1, if the key is not in the sidecar
+ */
+static int
+hotgrep(const char *label, int cflag, int maxcount)
+{
+  long idx;
+  int count, k;
+
+  if (!hot || keyBeg != 0 || (idx = srdsHotFind(hot, keyBuf, keyLen)) < 0)
+    return -1;
+  count = (int)srdsHotOccurrences(hot, idx);
+  if (maxcount >= 0 && count > maxcount)
+    count = maxcount;
   if (cflag) {
-    if (fname) {
-      fputs(fname, stdout);
-      fputc(':', stdout);
+    printcount(label, count);
+    return count;
+  }
+  for (k = 0; k < count; ++k) {
+    size_t w;
+    if (hexOutFlag) {
+      encodeHex( keyBuf, blockSize, hexBuf, hexOutFlag >= 2 );
+      hexBuf[2*blockSize] = '\n';
+      w = fwrite( hexBuf, 2*blockSize+1, 1, outFp );
+    }
+    else
+      w = fwrite( keyBuf, blockSize, 1, outFp );
+    if (w != 1) {
+      fprintf(stderr, "Error writing all matches to output!\n");
+      break;
+    }
+  }
+  return count;
+}
+
+/*
+ * detects the static search tree layout (from srds2tree) of the opened file.
+ * returns number of records - or -1 on error
+ */
+static int64_t
+openTree(FILE *fp, const char *fname, struct SrdsTree *t, off_t fileSize)
+{
+  tree = NULL;
+  if (!srdsTreeDetect(fileno(fp)))
+    return (int64_t)( fileSize / blockSize );
+  if (srdsTreeOpen(t, fileno(fp))) {
+    fprintf(stderr, "srdsgrep: invalid search tree layout in %s\n", fname ? fname : "STDIN");
+    srdsTreeClose(t);
+    return -1;
+  }
+  if (t->blockSize != blockSize) {
+    fprintf(stderr, "srdsgrep: blockSize %d does not match %d of search tree layout in %s\n", blockSize, t->blockSize, fname ? fname : "STDIN");
+    srdsTreeClose(t);
+    return -1;
+  }
+  if (verboseFlag)
+    fprintf(stderr, "using search tree of %d layers with %d keys per node in %s\n", t->height, t->nodeKeys, fname ? fname : "STDIN");
+  tree = t;
+  return (int64_t)t->numRecords;
+}
+
+/* sidecar must be from the searched data: else it is not used */
+static void
+checkHot(uint64_t numRecords, const char *fname)
+{
+  if (hot && hot->numRecords != numRecords) {
+    fprintf(stderr, "srdsgrep: hot hash sidecar does not match %s - not using it\n", fname ? fname : "STDIN");
+    srdsHotFree(hot);
+    hot = NULL;
+  }
+}
+
+/*
+ * asynchronous batch lookups (option -q): up to depth binary searches advance
+ * concurrently - each as a state machine. a search queues the read of the page
+ * with its next probe and continues, when the read completes.
+ * all probes inside a read page are resolved without further reads.
+ * results are output in the order of the keys.
+ */
+
+#define ASYNC_PAGE  4096
+
+enum { ASYNC_BISECT, ASYNC_SCAN, ASYNC_DONE, ASYNC_HOT };
+
+struct AsyncSearch {
+  int state;
+  int count;
+  int error;
+  off_t low, high, ret;    /* binary search as in binsrch() */
+  off_t pos;               /* next record in ASYNC_SCAN */
+  off_t bufOff;
+  size_t bufLen, bufCap;
+  unsigned char * buf;
+  unsigned char * key;
+  unsigned char * out;     /* matching records */
+  size_t outLen, outCap;
+};
+
+/* advances binary search with the records in the buffer. returns offset of the next probe - or -1 when done */
+static off_t
+asyncBisect(struct AsyncSearch *s, int reverse)
+{
+  while (s->low <= s->high) {
+    off_t med = (s->high + s->low) / 2;
+    int cmp;
+    med = med / blockSize;
+    med = med * blockSize;
+    if (med < s->bufOff || med + blockSize > s->bufOff + (off_t)s->bufLen)
+      return med;
+    cmp = memcmp(s->key, s->buf + (med - s->bufOff) + keyBeg, keyLen);
+    if (reverse)
+      cmp = -cmp;
+    if (cmp < 0)
+      s->high = med - blockSize;
+    else if (cmp > 0)
+      s->low = med + blockSize;
+    else {
+      s->ret = med;
+      s->high = med - blockSize;
+    }
+  }
+  return -1;
+}
+
+/* collects matching records from the buffer. returns offset to read further - or -1 when done */
+static off_t
+asyncScan(struct AsyncSearch *s, int cflag, int maxcount)
+{
+  while (maxcount < 0 || s->count < maxcount) {
+    const unsigned char *rec;
+    if (s->pos < s->bufOff || s->pos + blockSize > s->bufOff + (off_t)s->bufLen) {
+      /* a short read ended at end of file */
+      if (s->pos >= s->bufOff && s->bufLen < s->bufCap)
+        return -1;
+      return s->pos;
+    }
+    rec = s->buf + (s->pos - s->bufOff);
+    if (memcmp(s->key, rec + keyBeg, keyLen))
+      return -1;
+    ++s->count;
+    s->pos += blockSize;
+    if (cflag)
+      continue;
+    if (s->outLen + (size_t)blockSize > s->outCap) {
+      unsigned char *p = (unsigned char *)realloc(s->out, s->outCap ? 2 * s->outCap : 16 * (size_t)blockSize);
+      if (!p) {
+        s->error = 1;
+        return -1;
+      }
+      s->out = p;
+      s->outCap = s->outCap ? 2 * s->outCap : 16 * (size_t)blockSize;
+    }
+    memcpy(s->out + s->outLen, rec, blockSize);
+    s->outLen += blockSize;
+  }
+  return -1;
+}
+
+/* next state after bisect or scan step. returns offset to read - or -1 when done */
+static off_t
+asyncStep(struct AsyncSearch *s, int reverse, int cflag, int maxcount)
+{
+  off_t next;
+  if (s->state == ASYNC_BISECT) {
+    if ((next = asyncBisect(s, reverse)) >= 0)
+      return next;
+    if (s->ret < 0) {
+      s->state = ASYNC_DONE;
+      return -1;
+    }
+    s->state = ASYNC_SCAN;
+    s->pos = s->ret;
+  }
+  if ((next = asyncScan(s, cflag, maxcount)) >= 0)
+    return next;
+  s->state = ASYNC_DONE;
+  return -1;
+}
+
+/* queues read for the next step: probes read the page, the scan continues at the record */
+static void
+asyncRead(struct SrdsAio *aio, FILE *fp, struct AsyncSearch *s, off_t next)
+{
+  if (s->state == ASYNC_BISECT)
+    next -= next % ASYNC_PAGE;
+  s->bufOff = next;
+  s->bufLen = 0;
+  srdsAioRead(aio, fileno(fp), s->buf, s->bufCap, next, s);
+}
+
+/* outputs result of the finished search. returns its number of matches - or -1 on error */
+static int
+asyncEmit(struct AsyncSearch *s, const char *label, int cflag, int maxcount)
+{
+  size_t k;
+  if (s->error)
+    return -1;
+  if (s->state == ASYNC_HOT) {
+    memcpy(keyBuf, s->key, keyLen);
+    return hotgrep(label, cflag, maxcount);
+  }
+  for (k = 0; k < s->outLen; k += blockSize) {
+    size_t w;
+    if (hexOutFlag) {
+      encodeHex( s->out + k, blockSize, hexBuf, hexOutFlag >= 2 );
+      hexBuf[2*blockSize] = '\n';
+      w = fwrite( hexBuf, 2*blockSize+1, 1, outFp );
+    }
+    else
+      w = fwrite( s->out + k, blockSize, 1, outFp );
+    if (w != 1) {
+      fprintf(stderr, "Error writing all matches to output!\n");
+      break;
+    }
+  }
+  if (cflag)
+    printcount(label, s->count);
+  return s->count;
+}
+
+/*
+ * searches all keys of the key file in the opened file - with depth searches in flight.
+ * returns 0 if any key matched, 1 if none, 2 on error
+ */
+static int
+asyncgrep(FILE *fp, FILE *idxFp, const char *fname, char **keyLines, int numKeys, int hexFlag,
+    int reverse, int cflag, int maxcount, int depth, int threadsFlag)
+{
+  const size_t bufCap = ( ( blockSize + ASYNC_PAGE - 1 ) / ASYNC_PAGE + 1 ) * ASYNC_PAGE;
+  struct AsyncSearch *slots;
+  struct SrdsAio aio;
+  int nextKey = 0, nextEmit = 0, status = 1, k;
+
+  if (depth > numKeys)
+    depth = numKeys;
+  if (srdsAioInit(&aio, depth, threadsFlag)) {
+    fputs("srdsgrep: could not start asynchronous reads\n", stderr);
+    srdsAioFree(&aio);
+    return 2;
+  }
+  if (verboseFlag)
+    fprintf(stderr, "searching %d keys with %d reads in flight - using %s\n", numKeys, depth, srdsAioBackend(&aio));
+  slots = (struct AsyncSearch *)calloc(depth, sizeof(struct AsyncSearch));
+  for (k = 0; slots && k < depth; ++k) {
+    slots[k].bufCap = bufCap;
+    slots[k].buf = (unsigned char *)malloc(bufCap);
+    slots[k].key = (unsigned char *)malloc(keyLen);
+    if (!slots[k].buf || !slots[k].key)
+      break;
+  }
+  if (!slots || k < depth) {
+    fputs("srdsgrep: could not allocate memory for asynchronous searches\n", stderr);
+    status = 2;
+    numKeys = 0;
+  }
+
+  while (nextEmit < numKeys) {
+    /* start searches of the next keys in free slots */
+    for ( ; nextKey < numKeys && nextKey < nextEmit + depth; ++nextKey) {
+      struct AsyncSearch *s = &slots[nextKey % depth];
+      off_t next;
+      setKey(keyLines[nextKey], hexFlag);
+      memcpy(s->key, keyBuf, keyLen);
+      s->count = 0;
+      s->error = 0;
+      s->outLen = 0;
+      s->bufLen = 0;
+      s->bufOff = 0;
+      s->ret = -1;
+      if (hot && keyBeg == 0 && srdsHotFind(hot, keyBuf, keyLen) >= 0) {
+        s->state = ASYNC_HOT;
+        continue;
+      }
+      searchRange(fp, idxFp, fname, &s->low, &s->high);
+      s->state = ASYNC_BISECT;
+      if ((next = asyncStep(s, reverse, cflag, maxcount)) >= 0)
+        asyncRead(&aio, fp, s, next);
+    }
+
+    /* output finished searches in order of the keys */
+    for ( ; nextEmit < nextKey; ++nextEmit) {
+      struct AsyncSearch *s = &slots[nextEmit % depth];
+      int c;
+      if (s->state != ASYNC_DONE && s->state != ASYNC_HOT)
+        break;
+      c = asyncEmit(s, keyLines[nextEmit], cflag, maxcount);
+      if (c < 0)
+        status = 2;
+      else if (c > 0 && status == 1)
+        status = 0;
     }
-    printf("%d\n", count);
+    /* all started searches are output: start next */
+    if (nextEmit == nextKey)
+      continue;
+
+    /* continue the search, whose read completed */
+    {
+      struct AsyncSearch *s;
+      void *tag;
+      ssize_t res;
+      off_t next;
+      if (srdsAioWait(&aio, &tag, &res)) {
+        fputs("srdsgrep: error waiting for asynchronous reads\n", stderr);
+        status = 2;
+        break;
+      }
+      s = (struct AsyncSearch *)tag;
+      if (res < 0) {
+        fprintf(stderr, "srdsgrep: error reading %s: %s\n", fname ? fname : "STDIN", strerror((int)-res));
+        s->error = 1;
+        s->state = ASYNC_DONE;
+        continue;
+      }
+      s->bufLen = (size_t)res;
+      if ((next = asyncStep(s, reverse, cflag, maxcount)) >= 0)
+        asyncRead(&aio, fp, s, next);
+    }
+  }
+
+  for (k = 0; slots && k < depth; ++k) {
+    free(slots[k].buf);
+    free(slots[k].key);
+    free(slots[k].out);
+  }
+  free(slots);
+  srdsAioFree(&aio);
+  return status;
+}
+
+/*
+ * interleaved batch lookups in memory (option -M): the file is mapped and
+ * width binary searches advance alternately on one thread - see srdsilv.h.
+ * for files in the page cache: the cache misses of the searches overlap.
+ * results are output in the order of the keys. *total is the number of matches of all keys.
+ * returns 0 if any key matched, 1 if none, 2 on error
+ */
+static int
+ilvgrep(FILE *fp, FILE *idxFp, const char *fname, char **keyLines, int numKeys, int hexFlag,
+    int reverse, int cflag, int maxcount, int width, off_t fileSize, int *total)
+{
+  const uint64_t numRecords = (uint64_t)fileSize / blockSize;
+  const size_t mapLen = (size_t)( numRecords * blockSize );
+  const unsigned char *data = NULL;
+  unsigned char *keys = (unsigned char *)malloc((size_t)numKeys * keyLen);
+  unsigned char *isHot = (unsigned char *)calloc(numKeys, 1);
+  struct SrdsIlvJob *jobs = (struct SrdsIlvJob *)calloc(numKeys, sizeof(struct SrdsIlvJob));
+  off_t low, high;
+  int k, status = 1;
+
+  *total = 0;
+  if (mapLen) {
+    data = (const unsigned char *)mmap(NULL, mapLen, PROT_READ, MAP_SHARED, fileno(fp), 0);
+    if (data == (const unsigned char *)MAP_FAILED) {
+      fprintf(stderr, "srdsgrep: could not map %s\n", fname ? fname : "STDIN");
+      data = NULL;
+      status = 2;
+    }
+  }
+  if (!keys || !isHot || !jobs) {
+    fputs("srdsgrep: could not allocate memory for interleaved searches\n", stderr);
+    status = 2;
+  }
+  if (status == 2)
+    numKeys = 0;
+  if (verboseFlag && numKeys)
+    fprintf(stderr, "searching %d keys in memory - %d interleaved\n", numKeys, width);
+
+  for (k = 0; k < numKeys; ++k) {
+    struct SrdsIlvJob *j = &jobs[k];
+    setKey(keyLines[k], hexFlag);
+    memcpy(keys + (size_t)k * keyLen, keyBuf, keyLen);
+    j->key = keys + (size_t)k * keyLen;
+    j->keyLen = keyLen;
+    if (hot && keyBeg == 0 && srdsHotFind(hot, keyBuf, keyLen) >= 0) {
+      isHot[k] = 1;
+      continue;
+    }
+    searchRange(fp, idxFp, fname, &low, &high);
+    j->lo = (uint64_t)( low / blockSize );
+    j->hi = ( high >= low ) ? (uint64_t)( high / blockSize ) + 1 : j->lo;
+  }
+  srdsIlvSearch(data, numRecords, blockSize, keyBeg, reverse, jobs, numKeys, width,
+                maxcount < 0 ? UINT64_MAX : (uint64_t)maxcount);
+
+  for (k = 0; k < numKeys; ++k) {
+    const struct SrdsIlvJob *j = &jobs[k];
+    uint64_t r;
+    int c;
+    if (isHot[k]) {
+      memcpy(keyBuf, j->key, keyLen);
+      c = hotgrep(keyLines[k], cflag, maxcount);
+    }
+    else {
+      c = (int)( j->hi - j->lo );
+      for (r = j->lo; !cflag && r < j->hi; ++r) {
+        size_t w;
+        if (hexOutFlag) {
+          encodeHex( data + r * blockSize, blockSize, hexBuf, hexOutFlag >= 2 );
+          hexBuf[2*blockSize] = '\n';
+          w = fwrite( hexBuf, 2*blockSize+1, 1, outFp );
+        }
+        else
+          w = fwrite( data + r * blockSize, blockSize, 1, outFp );
+        if (w != 1) {
+          fprintf(stderr, "Error writing all matches to output!\n");
+          break;
+        }
+      }
+      if (cflag)
+        printcount(keyLines[k], c);
+    }
+    *total += c;
+    if (c > 0 && status == 1)
+      status = 0;
+  }
+
+  if (data)
+    munmap((void *)data, mapLen);
+  free(keys);
+  free(isHot);
+  free(jobs);
+  return status;
+}
+
+/*
+ * searches all keys in the sorted file fname. label is the filename for the output - or NULL.
+ * *total is the number of matches of all keys.
+ * returns 0 if any key matched, 1 if none, 2 on error
+ */
+static int
+grepFile(const char *fname, const char *label, FILE *idxFp, char **keyLines, int numKeys, int hexFlag,
+    int revFlag, int countFlag, int maxcount, int asyncDepth, int threadsFlag, int ilvWidth,
+    void *rdBuffer, size_t bufferSize, int *total)
+{
+  struct SrdsTree treeMem;
+  struct stat st;
+  off_t where, low, high;
+  int64_t numRecords;
+  int k, c, status = 1;
+  FILE *fp = fopen(fname, "rb");
+
+  *total = 0;
+  if ( !fp ) {
+    fprintf(stderr, "srdsgrep: could not open %s\n", fname);
+    return 2;
   }
+  fstat(fileno(fp), &st);
+  if ((st.st_mode & S_IFREG) == 0) {
+    fprintf(stderr, "srdsgrep: %s is not a regular file\n", fname);
+    fclose(fp);
+    return 2;
+  }
+
+  if ((numRecords = openTree(fp, fname, &treeMem, st.st_size)) < 0) {
+    fclose(fp);
+    return 2;
+  }
+  if (rdBuffer) setbuffer( fp, (char *)rdBuffer, bufferSize );
+  checkHot((uint64_t)numRecords, fname);
+  if (asyncDepth)
+    status = asyncgrep(fp, idxFp, fname, keyLines, numKeys, hexFlag, revFlag, countFlag, maxcount, asyncDepth, threadsFlag);
+  else if (ilvWidth && !tree) {
+    status = ilvgrep(fp, idxFp, fname, keyLines, numKeys, hexFlag, revFlag, countFlag, maxcount, ilvWidth, st.st_size, total);
+    numKeys = 0;
+  }
+
+  for (k = 0; !asyncDepth && k < numKeys; ++k) {
+    if (keyLines)
+      setKey(keyLines[k], hexFlag);
+    if ((c = hotgrep(keyLines ? keyLines[k] : 0, countFlag, maxcount)) >= 0) {
+      *total += c;
+      if (c > 0)
+        status = 0;
+      continue;
+    }
+    searchRange(fp, idxFp, fname, &low, &high);
+    where = binsrch(fp, revFlag, low, high);
+    c = printmatch(fp, where, keyLines ? keyLines[k] : label, countFlag, maxcount);
+    *total += c;
+    if (countFlag)
+      printcount(keyLines ? keyLines[k] : label, c);
+    if (where >= 0)
+      status = 0;
+  }
+  if (tree)
+    srdsTreeClose(tree);
+  fclose(fp);
+  return status;
 }
 
+/*
+ * concurrent search of several sorted files (option -j): a bounded pool of threads
+ * takes the files in argument order. each thread has its own key, block and read
+ * buffer - allocated once - and writes the output of a file into a memory stream.
+ * the main thread outputs these in argument order - as soon as a file is done.
+ * so the latency of all files approaches that of the slowest.
+ * with a single key, '-m' limits the matches of all files:
+ * once reached, the files behind are not searched any more.
+ */
+
+struct FileJob {
+  const char *fname;
+  char *out;          /* from open_memstream() */
+  size_t outLen;
+  int total;          /* number of matches */
+  int status;         /* 0 if any key matched, 1 if none, 2 on error */
+  int done;
+};
+
+struct FilePool {
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  struct FileJob *jobs;
+  int numJobs;
+  int nextJob;
+  int emitted;        /* matches output - for '-m' over all files */
+  int stop;           /* '-m' reached: no further files */
+  const unsigned char *key;
+  char **keyLines;
+  int numKeys, hexFlag, revFlag, countFlag, maxcount, ilvWidth;
+  size_t bufferSize;
+};
+
+static void *
+fileWorker(void *arg)
+{
+  struct FilePool *p = (struct FilePool *)arg;
+  void *rdBuffer = malloc( p->bufferSize );
+
+  keyBuf = (unsigned char *)malloc( keyLen );
+  blockBuf = (unsigned char *)malloc( blockSize );
+  if (hexOutFlag)
+    hexBuf = (char *)malloc( 2 * blockSize + 1 );
+  memcpy( keyBuf, p->key, keyLen );
+
+  pthread_mutex_lock( &p->mutex );
+  while (p->nextJob < p->numJobs) {
+    struct FileJob *j = &p->jobs[ p->nextJob++ ];
+    int maxcount = p->maxcount;
+    const int skip = p->stop;
+    /* single key: no file needs more than the remaining matches */
+    if (!p->keyLines && maxcount >= 0)
+      maxcount -= p->emitted;
+    pthread_mutex_unlock( &p->mutex );
+
+    j->status = 1;
+    if (!skip) {
+      outFp = open_memstream( &j->out, &j->outLen );
+      if (!outFp) {
+        fprintf(stderr, "srdsgrep: could not allocate output buffer for %s\n", j->fname);
+        j->status = 2;
+      }
+      else {
+        j->status = grepFile(j->fname, j->fname, NULL, p->keyLines, p->numKeys, p->hexFlag, p->revFlag,
+                             p->countFlag, maxcount, 0, 0, p->ilvWidth, rdBuffer, p->bufferSize, &j->total);
+        fclose(outFp);
+      }
+    }
+
+    pthread_mutex_lock( &p->mutex );
+    j->done = 1;
+    pthread_cond_broadcast( &p->cond );
+  }
+  pthread_mutex_unlock( &p->mutex );
+
+  free(rdBuffer);
+  free(keyBuf);
+  free(blockBuf);
+  free(hexBuf);
+  return NULL;
+}
+
+/* searches files with numThreads threads - output in order of files. returns exit status
+ * - or -1, when no thread could be created: nothing is searched then */
+static int
+poolgrep(char **files, int numFiles, int numThreads, char **keyLines, int numKeys, int hexFlag,
+    int revFlag, int countFlag, int maxcount, int ilvWidth, size_t bufferSize)
+{
+  struct FilePool p;
+  pthread_t *threads;
+  const int recLen = hexOutFlag ? 2 * blockSize + 1 : blockSize;
+  int k, status = 1;
+
+  memset( &p, 0, sizeof(p) );
+  pthread_mutex_init( &p.mutex, NULL );
+  pthread_cond_init( &p.cond, NULL );
+  p.jobs = (struct FileJob *)calloc( numFiles, sizeof(struct FileJob) );
+  threads = (pthread_t *)malloc( numThreads * sizeof(pthread_t) );
+  if (!p.jobs || !threads) {
+    fputs("srdsgrep: could not allocate file pool\n", stderr);
+    return 2;
+  }
+  for (k = 0; k < numFiles; ++k)
+    p.jobs[k].fname = files[k];
+  p.numJobs = numFiles;
+  p.key = keyBuf;
+  p.keyLines = keyLines;
+  p.numKeys = numKeys;
+  p.hexFlag = hexFlag;
+  p.revFlag = revFlag;
+  p.countFlag = countFlag;
+  p.maxcount = maxcount;
+  p.ilvWidth = ilvWidth;
+  p.bufferSize = bufferSize;
+
+  if (verboseFlag)
+    fprintf(stderr, "searching %d files with %d threads\n", numFiles, numThreads);
+  for (k = 0; k < numThreads; ++k)
+    if (pthread_create( &threads[k], NULL, fileWorker, &p ))
+      break;
+  if (k < numThreads) {
+    /* each worker takes files until none is left: fewer threads only take longer */
+    if (k)
+      fprintf(stderr, "srdsgrep: could not create thread - searching with %d threads\n", k);
+    else
+      fputs("srdsgrep: could not create thread - searching one file after another\n", stderr);
+    numThreads = k;
+  }
+  if (!numThreads) {
+    free(threads);
+    free(p.jobs);
+    pthread_cond_destroy( &p.cond );
+    pthread_mutex_destroy( &p.mutex );
+    return -1;
+  }
+
+  for (k = 0; k < numFiles; ++k) {
+    struct FileJob *j = &p.jobs[k];
+    int skip, n;
+    pthread_mutex_lock( &p.mutex );
+    while (!j->done)
+      pthread_cond_wait( &p.cond, &p.mutex );
+    skip = p.stop;
+    pthread_mutex_unlock( &p.mutex );
+
+    if (!skip && !keyLines && maxcount >= 0 && j->total > maxcount - p.emitted) {
+      /* single key: cut the output to the remaining matches */
+      n = maxcount - p.emitted;
+      if (countFlag)
+        printcount(j->fname, n);
+      else if (n && fwrite( j->out, recLen, n, stdout ) != (size_t)n)
+        fprintf(stderr, "Error writing all matches to output!\n");
+      j->total = n;
+    }
+    else if (!skip && j->outLen && fwrite( j->out, j->outLen, 1, stdout ) != 1)
+      fprintf(stderr, "Error writing all matches to output!\n");
+    free(j->out);
+    if (skip)
+      continue;
+
+    if (j->status == 2 || (j->status == 0 && status == 1))
+      status = j->status;
+    if (!keyLines && maxcount >= 0) {
+      pthread_mutex_lock( &p.mutex );
+      p.emitted += j->total;
+      if (p.emitted >= maxcount)
+        p.stop = 1;
+      pthread_mutex_unlock( &p.mutex );
+    }
+  }
+
+  for (k = 0; k < numThreads; ++k)
+    pthread_join( threads[k], NULL );
+  free(threads);
+  free(p.jobs);
+  pthread_cond_destroy( &p.cond );
+  pthread_mutex_destroy( &p.mutex );
+  return status;
+}
+
+
 static
 void usage() {
-  fputs("Usage: srdsgrep [-v][-h][-c][-m <max>][-r][-l <blockLength>][-b <keyBegin>][-e <keyEnd>] [-x] key [ sorted_file ... ]\n", stderr);
+  fputs("Usage: srdsgrep [-v][-h][-c][-m <max>][-r][-l <blockLength>][-b <keyBegin>][-e <keyEnd>] [-x] [-X] [-I <index> | -P <pgm> | -K <column> | -E <ef> | -S <manifest>] [-H <hot>] [-f [-q <depth>] [-Q] [-M <width>]] [-j <threads>] key [ sorted_file ... ]\n", stderr);
   fputs("  sorted raw data set grep\n", stderr);
   fputs("  -v     verbose output\n", stderr);
   fputs("  -h     print usage\n",stderr);
   fputs("  -c     print count matches - not matching contents\n", stderr);
   fputs("  -m <v> stop reading file after N matches. default is no stop.\n", stderr);
+  fputs("         with a single key and several files: stop after N matches of all files\n", stderr);
   fputs("  -B <v> bufferSize in kBytes\n", stderr);
   fputs("  -r     sorted file is reversed (descending) order\n", stderr);
   fputs("  -l <v> length of each binary block in bytes\n", stderr);
   fputs("  -b <v> key's begin offset inside block\n", stderr);
   fputs("  -e <v> key's end offset inside block\n", stderr);
   fputs("  -x     key (or key file content) is hexadecimal, e.g. FFAA01\n", stderr);
-  /* fputs("  -f     key is in file. key parameter is filename\n", stderr); */
+  fputs("  -X     output matching blocks as hexadecimal text lines. -XX for lower case\n", stderr);
+  fputs("  -I <f> use prefix bucket index file (from hex2rds -I) to narrow the search\n", stderr);
+  fputs("         the key must start at offset 0. not with multiple sorted files\n", stderr);
+  fputs("  -P <f> use learned index (from srds2pgm) to search only the predicted window\n", stderr);
+  fputs("         the key must start at offset 0. not with multiple sorted files. block length defaults to the model's\n", stderr);
+  fputs("  -K <f> binary search key prefix column (from srds2col) - then only the remaining window of the file\n", stderr);
+  fputs("         the key must start at offset 0. not with multiple sorted files. block length defaults to the column's\n", stderr);
+  fputs("  -E <f> search in memory in Elias-Fano representation (from srds2ef) instead of sorted files\n", stderr);
+  fputs("         the key must start at offset 0. matches are output with the stored bytes only\n", stderr);
+  fputs("  -S <f> route each key by its prefix to its shard from the manifest (from srdssplit) instead of sorted files\n", stderr);
+  fputs("         the key must start at offset 0. block length defaults to the manifest's\n", stderr);
+  fputs("  -H <f> check hot hash sidecar (from hex2rds -H) in memory before searching\n", stderr);
+  fputs("         the key must start at offset 0. not with multiple sorted files or -E\n", stderr);
+  fputs("  -f     keys are in file - one key per line, all of same length. key parameter is filename. '-' reads stdin\n", stderr);
+  fputs("         all keys are searched. with '-c', each key is printed with its count\n", stderr);
+  fputs("  -q <v> search the keys from file asynchronously: with v reads in flight - e.g. 64 for NVMe\n", stderr);
+  fputs("         using io_uring - or a pool of pread() threads, where io_uring is not available\n", stderr);
+  fputs("  -Q     use the pool of pread() threads for '-q' - instead of io_uring\n", stderr);
+  fputs("  -M <v> search the keys from file in the memory mapped file: v searches interleaved on one thread\n", stderr);
+  fputs("         - e.g. 16 - hiding the memory latency, when the file is in the page cache. not with '-q'\n", stderr);
+  fputs("  -j <v> search up to v sorted files concurrently. default: 8. 0 for number of online cpus\n", stderr);
+  fputs("         output stays in order of the files. with a single key, '-m' limits the matches of all files\n", stderr);
+  fputs("  sorted_file  files in static search tree layout (from srds2tree) are detected and searched in the tree\n", stderr);
 }
 
 
@@ -299,14 +1266,36 @@ int main(int argc, char **argv)
   int helpFlag = 0;
   int countFlag = 0, revFlag = 0, hexFlag = 0, fileFlag = 0, maxcount = -1;
   int changedKeyOrBlock = 0;
-  off_t where;
+  int asyncDepth = 0, threadsFlag = 0;
+  int ilvWidth = 0;
+  int numThreads = 8;
+  off_t where, low, high;
+  const char * idxFn = NULL;
+  const char * efFn = NULL;
+  const char * manifestFn = NULL;
+  const char * hotFn = NULL;
+  const char * pgmFn = NULL;
+  const char * colFn = NULL;
+  struct SrdsHotTable hotMem;
+  struct SrdsPgm pgmMem;
+  struct SrdsTree treeMem;
+  struct SrdsCol colMem;
+  int64_t numRecords;
+  int total;
+  struct SrdsManifest manifest;
+  char ** keyLines = NULL;
+  int numKeys = 1, k, c;
+  FILE * idxFp = NULL;
   size_t vBufSize = 0;
+  size_t bufferSize;
   void * rdBuffer = NULL;
   struct stat st;
   extern int optind;
 
+  outFp = stdout;
+
   /* parse command line options */
-  while ((i = getopt(argc, argv, "vhB:crxm:l:b:e:")) > 0 && i != '?') {
+  while ((i = getopt(argc, argv, "vhB:crxXfq:QM:j:I:P:K:E:S:H:m:l:b:e:")) > 0 && i != '?') {
     switch(i) {
     case 'v': ++verboseFlag; break;
     case 'h': ++helpFlag; break;
@@ -314,7 +1303,18 @@ int main(int argc, char **argv)
     case 'c': ++countFlag; break;
     case 'r': ++revFlag; break;
     case 'x': ++hexFlag; break;
-    /* case 'f': ++fileFlag; break; */
+    case 'X': ++hexOutFlag; break;
+    case 'I': idxFn = optarg; break;
+    case 'P': pgmFn = optarg; break;
+    case 'K': colFn = optarg; break;
+    case 'q': asyncDepth = atoi(optarg); break;
+    case 'Q': ++threadsFlag; break;
+    case 'M': ilvWidth = atoi(optarg); break;
+    case 'j': numThreads = atoi(optarg); break;
+    case 'E': efFn = optarg; break;
+    case 'S': manifestFn = optarg; break;
+    case 'H': hotFn = optarg; break;
+    case 'f': ++fileFlag; break;
     case 'm': maxcount = atoi(optarg);  break;
     case 'l':
       blockSize = atoi(optarg);
@@ -340,10 +1340,91 @@ int main(int argc, char **argv)
   i = optind;
   keyarg = argv[i++];
 
-  if (!fileFlag) {
+  if (manifestFn) {
+    if (srdsManifestRead(&manifest, manifestFn)) {
+      fprintf(stderr, "srdsgrep: could not read shard manifest %s\n", manifestFn);
+      exit(2);
+    }
+    if (blockSize <= 0)
+      blockSize = manifest.blockSize;
+    else if (blockSize != manifest.blockSize) {
+      fprintf(stderr, "error: blockSize %d does not match manifest's blockSize %d !\n", blockSize, manifest.blockSize);
+      return 10;
+    }
+  }
+
+  if (pgmFn) {
+    if (revFlag || keyBeg != 0 || idxFn || colFn || efFn || manifestFn || argc - i > 1) {
+      fputs("srdsgrep: learned index is only supported for a single file in ascending order, with key at offset 0 and not with -I, -K, -E or -S\n", stderr);
+      exit(2);
+    }
+    if (srdsPgmLoad(&pgmMem, pgmFn)) {
+      fprintf(stderr, "srdsgrep: could not read learned index %s\n", pgmFn);
+      exit(2);
+    }
+    pgm = &pgmMem;
+    if (blockSize <= 0)
+      blockSize = pgm->blockSize;
+    else if (pgm->blockSize != blockSize) {
+      fprintf(stderr, "srdsgrep: blockSize %d of learned index does not match %d - not using it\n", pgm->blockSize, blockSize);
+      srdsPgmFree(pgm);
+      pgm = NULL;
+    }
+    if (verboseFlag && pgm)
+      fprintf(stderr, "loaded %llu segments with epsilon %d from %s\n", (unsigned long long)pgm->numSegments, pgm->epsilon, pgmFn);
+  }
+
+  if (colFn) {
+    if (revFlag || keyBeg != 0 || idxFn || efFn || manifestFn || argc - i > 1) {
+      fputs("srdsgrep: key prefix column is only supported for a single file in ascending order, with key at offset 0 and not with -I, -P, -E or -S\n", stderr);
+      exit(2);
+    }
+    if (srdsColOpen(&colMem, colFn, verboseFlag >= 2)) {
+      fprintf(stderr, "srdsgrep: could not read key prefix column %s\n", colFn);
+      exit(2);
+    }
+    col = &colMem;
+    if (blockSize <= 0)
+      blockSize = col->blockSize;
+    else if (col->blockSize != blockSize) {
+      fprintf(stderr, "srdsgrep: blockSize %d of key prefix column does not match %d - not using it\n", col->blockSize, blockSize);
+      srdsColClose(col);
+      col = NULL;
+    }
+    if (verboseFlag && col)
+      fprintf(stderr, "mapped %llu prefixes of every %d-th record from %s\n", (unsigned long long)col->numEntries, col->sample, colFn);
+  }
+
+  if (fileFlag) {
+    keyLines = readKeyFile(keyarg, &numKeys);
+    if (!keyLines || !numKeys) {
+      fprintf(stderr, "srdsgrep: could not read keys from %s\n", keyarg);
+      exit(2);
+    }
+    /* all keys are searched with the length of the first key */
+    for (k = 1; k < numKeys; ++k) {
+      if ((hexFlag ? hashLen(keyLines[k]) : (int)strlen(keyLines[k]))
+          != (hexFlag ? hashLen(keyLines[0]) : (int)strlen(keyLines[0]))) {
+        fprintf(stderr, "srdsgrep: key '%s' differs in length from the first key - all keys need the same length\n", keyLines[k]);
+        exit(2);
+      }
+    }
+    keyarg = keyLines[0];
+  }
+  if (asyncDepth && (!fileFlag || asyncDepth < 0 || asyncDepth > 4096)) {
+    fputs("srdsgrep: asynchronous search needs keys from file (-f) and a depth of 1 .. 4096\n", stderr);
+    exit(2);
+  }
+  if (ilvWidth && (!fileFlag || asyncDepth || ilvWidth < 0 || ilvWidth > SRDSILV_MAX_WIDTH)) {
+    fprintf(stderr, "srdsgrep: interleaved search needs keys from file (-f), no '-q' and a width of 1 .. %d\n", SRDSILV_MAX_WIDTH);
+    exit(2);
+  }
+
+  /* key - or 1st key from key file */
+  {
     if (!hexFlag) {
       int len = strlen(keyarg);
-      if ( keyEnd <= 0 )
+      if ( keyEnd < 0 )
       {
         keyEnd = keyBeg + len -1;
         if ( verboseFlag >= 2 )
@@ -364,7 +1445,7 @@ int main(int argc, char **argv)
     else {
       int hlen = hashLen(keyarg);
       int len = hlen / 2;
-      if ( keyEnd <= 0 )
+      if ( keyEnd < 0 )
       {
         keyEnd = keyBeg + len -1;
         keyBuf = (unsigned char *)malloc( len * sizeof(unsigned char) );
@@ -414,18 +1495,109 @@ int main(int argc, char **argv)
     fprintf(stderr, "error: keyLen %d is <= 0 !\n", keyLen);
     return 10;
   }
-  if ( keyEnd <= 0 ) {
-    fprintf(stderr, "error: keyEnd %d is <= 0 !\n", keyEnd);
+  if ( keyEnd < 0 ) {
+    fprintf(stderr, "error: keyEnd %d is < 0 !\n", keyEnd);
     return 10;
   }
 
 
   blockBuf = (unsigned char *)malloc( blockSize * sizeof(unsigned char) );
+  if (hexOutFlag) {
+    hexBuf = (char *)malloc( 2 * blockSize + 1 );
+    encodeHex = selectEncodeHex( verboseFlag >= 2 );
+  }
+
+  if (hotFn) {
+    if (revFlag || keyBeg != 0 || efFn || argc - i > 1) {
+      fputs("srdsgrep: hot hash sidecar is only supported for a single file in ascending order, with key at offset 0 and not with -E\n", stderr);
+      exit(2);
+    }
+    if (srdsHotLoad(&hotMem, hotFn)) {
+      fprintf(stderr, "srdsgrep: could not read hot hash sidecar %s\n", hotFn);
+      exit(2);
+    }
+    hot = &hotMem;
+    if (hot->blockSize != blockSize) {
+      fprintf(stderr, "srdsgrep: blockSize %d of hot hash sidecar does not match %d - not using it\n", hot->blockSize, blockSize);
+      srdsHotFree(hot);
+      hot = NULL;
+    }
+    if (verboseFlag && hot)
+      fprintf(stderr, "loaded %u hot records from %s\n", hot->n, hotFn);
+  }
+
+  if (efFn) {
+    if (revFlag || keyBeg != 0 || idxFn || argc - i > 0) {
+      fputs("srdsgrep: Elias-Fano search is only supported in ascending order, with key at offset 0 and without files\n", stderr);
+      exit(2);
+    }
+    if (!encodeHex)
+      encodeHex = selectEncodeHex( verboseFlag >= 2 );
+    for (status = 1, k = 0; k < numKeys; ++k) {
+      if (keyLines)
+        setKey(keyLines[k], hexFlag);
+      c = efgrep(efFn, countFlag, maxcount, keyLines ? keyLines[k] : 0);
+      if (c < 0)
+        exit(2);
+      if (c > 0)
+        status = 0;
+    }
+    exit(status);
+  }
+
+  if (manifestFn) {
+    size_t bufferSize = vBufSize ? vBufSize : 4096;
+    void ** shardBufs;
+    if (revFlag || keyBeg != 0 || idxFn || efFn || argc - i > 0) {
+      fputs("srdsgrep: shard manifest is only supported in ascending order, with key at offset 0 and without files\n", stderr);
+      exit(2);
+    }
+    shardBufs = (void **)calloc( manifest.numShards, sizeof(void *) );
+    {
+      uint64_t n = 0;
+      for (k = 0; k < manifest.numShards; ++k)
+        n += manifest.shards[k].numRecords;
+      checkHot(n, manifestFn);
+    }
+    for (status = 1, k = 0; k < numKeys; ++k) {
+      if (keyLines)
+        setKey(keyLines[k], hexFlag);
+      c = hotgrep(keyLines ? keyLines[k] : 0, countFlag, maxcount);
+      if (c < 0)
+        c = shardgrep(&manifest, shardBufs, bufferSize, countFlag, maxcount, keyLines ? keyLines[k] : 0);
+      if (c < 0)
+        exit(2);
+      if (c > 0)
+        status = 0;
+    }
+    for (k = 0; k < manifest.numShards; ++k) {
+      if (manifest.shards[k].fp) {
+        fclose(manifest.shards[k].fp);
+        manifest.shards[k].fp = NULL;
+      }
+      free(shardBufs[k]);
+    }
+    free(shardBufs);
+    srdsManifestFree(&manifest);
+    exit(status);
+  }
+
+  if (idxFn) {
+    if (revFlag || argc - i > 1) {
+      fputs("srdsgrep: index is only supported for a single file in ascending order\n", stderr);
+      exit(2);
+    }
+    idxFp = fopen(idxFn, "rb");
+    if (!idxFp) {
+      fprintf(stderr, "srdsgrep: could not open index %s\n", idxFn);
+      exit(2);
+    }
+  }
 
   /* if no input files, then search stdin */
 
   if ((numfile = argc - i) == 0) {
-    size_t bufferSize = vBufSize ? vBufSize : 65536;
+    bufferSize = vBufSize ? vBufSize : ( keyLines ? 4096 : 65536 );
     fstat(fileno(stdin), &st);
     if ((st.st_mode & S_IFREG) == 0) {
       fputs("srdsgrep: STDIN is not a regular file\n", stderr);
@@ -433,40 +1605,58 @@ int main(int argc, char **argv)
     }
     rdBuffer = malloc( bufferSize );
     if (rdBuffer) setbuffer( stdin, rdBuffer, bufferSize );
+    if ((numRecords = openTree(stdin, 0, &treeMem, st.st_size)) < 0)
+      exit(2);
+    checkHot((uint64_t)numRecords, 0);
+    if (asyncDepth)
+      exit(asyncgrep(stdin, idxFp, 0, keyLines, numKeys, hexFlag, revFlag, countFlag, maxcount, asyncDepth, threadsFlag));
+    if (ilvWidth && !tree)
+      exit(ilvgrep(stdin, idxFp, 0, keyLines, numKeys, hexFlag, revFlag, countFlag, maxcount, ilvWidth, st.st_size, &total));
 
-    where = binsrch(stdin, revFlag);
-    printmatch(stdin, where, 0, countFlag, maxcount);
+    for (status = 1, k = 0; k < numKeys; ++k) {
+      if (keyLines)
+        setKey(keyLines[k], hexFlag);
+      if ((c = hotgrep(keyLines ? keyLines[k] : 0, countFlag, maxcount)) >= 0) {
+        if (c > 0)
+          status = 0;
+        continue;
+      }
+      searchRange(stdin, idxFp, 0, &low, &high);
+      where = binsrch(stdin, revFlag, low, high);
+      c = printmatch(stdin, where, keyLines ? keyLines[k] : 0, countFlag, maxcount);
+      if (countFlag)
+        printcount(keyLines ? keyLines[k] : 0, c);
+      if (where >= 0)
+        status = 0;
+    }
+    exit(status);
+  }
 
-    exit(where < 0);
+  /* smaller buffer with many keys: each binary search step reads a full buffer */
+  bufferSize = vBufSize ? vBufSize : ( keyLines ? 4096 : 65536 );
+  if (numThreads <= 0)
+    numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (numThreads > numfile)
+    numThreads = numfile;
+  if (numThreads > 1 && !asyncDepth) {
+    status = poolgrep(argv + i, numfile, numThreads, keyLines, numKeys, hexFlag, revFlag, countFlag, maxcount, ilvWidth, bufferSize);
+    if (status >= 0)
+      exit(status);
   }
 
   /* search each input file */
-  for (status = 1; i < argc; i++) {
-    size_t bufferSize = vBufSize ? vBufSize : 65536;
-    FILE *fp = fopen(argv[i], "rb");
-    if ( !fp ) {
-      fprintf(stderr, "srdsgrep: could not open %s\n", argv[i]);
-      status = 2;
-      continue;
-    }
-    fstat(fileno(fp), &st);
-    if ((st.st_mode & S_IFREG) == 0) {
-      fprintf(stderr, "srdsgrep: %s is not a regular file\n", argv[i]);
-      status = 2;
-      fclose(fp);
-      continue;
-    }
-
-    rdBuffer = malloc( bufferSize );
-    if (rdBuffer) setbuffer( fp, rdBuffer, bufferSize );
-
-    where = binsrch(fp, revFlag);
-    printmatch(fp, where, numfile == 1 ? 0 : argv[i], countFlag, maxcount);
-    if (status == 1 && where >= 0) {
-      status = 0;
-    }
-    fclose(fp);
-    free( rdBuffer );
+  rdBuffer = malloc( bufferSize );
+  for (status = 1, k = 0; i < argc; i++) {
+    /* single key: '-m' limits the matches of all files - as with the pool */
+    const int multiMax = ( numfile > 1 && !keyLines && maxcount >= 0 );
+    if (multiMax && i > argc - numfile && k >= maxcount)
+      break;
+    c = grepFile(argv[i], numfile == 1 ? 0 : argv[i], idxFp, keyLines, numKeys, hexFlag, revFlag,
+                 countFlag, multiMax ? maxcount - k : maxcount, asyncDepth, threadsFlag, ilvWidth, rdBuffer, bufferSize, &total);
+    k += total;
+    if (c == 2 || (c == 0 && status == 1))
+      status = c;
   }
+  free( rdBuffer );
   exit(status);
 }
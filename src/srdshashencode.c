@@ -11,6 +11,8 @@
  * Author:  Hayati Ayguen
  */
 
+/* fopencookie() for the telemetry */
+#define _GNU_SOURCE
 
 #include <stdlib.h>
 #include <unistd.h>
@@ -19,114 +21,313 @@
 #include <stdint.h>
 #include <inttypes.h>
 
-#ifdef __SSE2__
-  #pragma message "__SSE2__ is defined"
-  #define SSE2_AVAILABLE  1
-#elif defined(_MSC_VER)
-  #pragma message "_MSC_VER is defined"
-  #if (defined(_M_AMD64) || defined(_M_X64))
-    //SSE2 x64
-    #define SSE2_AVAILABLE  1
-  #elif _M_IX86_FP == 2
-    //SSE2 x32
-    #define SSE2_AVAILABLE  1
-  #endif
-#endif
+#include "gapcodec.h"
+#include "srdsstat.h"
+#include "srdsio.h"
 
-#ifdef SSE2_AVAILABLE
-#include <x86intrin.h>
+#if defined(__GNUC__) && defined(__SSE2__) && ( defined(__x86_64__) || defined(__i386__) )
+  #define SSE2_AVAILABLE  1
+  #include <x86intrin.h>
 #endif
 
-#if 0
-#undef SSE2_AVAILABLE       /* SSE2 speeds up, approx. by factor 2 */
-#endif
 #define USE_64BIT_ARITH 1   /* on my i5 cpu this speeds up - for blockLen 20 */
 
+#define BUF_PAD       64    /* over-read / over-write of the vector kernels */
+#define MAX_STATEVEC  16    /* max. number of vector registers for decode state */
+
 static int blockSize = -1;
+static struct SrdsStat telemetry;
+
+
+/*
+ * use delta algorithm
+ * compression over delta-algorithm produces smaller files
+ * compared to easier and symmetric xor !
+ *
+ * encode: out[r] = in[r] - in[r-1]   (bytewise, modulo 256)
+ * decode: out[r] = in[r] + out[r-1]  (bytewise prefix sum over the records)
+ * with in[-1] = out[-1] = 00 at start.
+ *
+ * the kernels process whole buffers of n records:
+ * encode() reads the previous raw record from in[-blockSize .. -1],
+ *   so it is a plain elementwise subtraction over the flat buffer.
+ * decode() keeps the previous decoded record in (vector) registers,
+ *   loaded from and stored back to state[] - the scan over the records.
+ * all kernels may read and write up to BUF_PAD bytes beyond the n records.
+ */
+
+typedef void (*EncodeFunc)( const unsigned char * in, unsigned char * out, size_t n );
+typedef void (*DecodeFunc)( const unsigned char * in, unsigned char * out, size_t n, unsigned char * state );
 
 #pragma GCC push_options
 #pragma GCC optimize ("unroll-loops")
 
-#if defined(SSE2_AVAILABLE)
-#pragma message "compiling encode() for SSE2"
-static inline void encode( __m128i * c, const __m128i * a, const __m128i * b, size_t uBlockLen ) {
-  size_t u;
-  for ( u = 0; u < uBlockLen; ++u ) {
-    c[u] = _mm_sub_epi8( a[u], b[u] );
-  }
-}
-#elif USE_64BIT_ARITH
-#pragma message "compiling encode() for 64 Bit arithmetic"
-static inline void encode( uint64_t * c, const uint64_t * a, const uint64_t * b, size_t uBlockLen ) {
-  size_t u;
-  for ( u = 0; u < uBlockLen; ++u ) {
-    c[u] =  ( ( ( a[u]  | UINT64_C(0xFF00FF00FF00FF00) )
-               -( b[u]  & UINT64_C(0x00FF00FF00FF00FF) )
-              )         & UINT64_C(0x00FF00FF00FF00FF)
-            )
-          | ( ( ( a[u]  | UINT64_C(0x00FF00FF00FF00FF) )
-               -( b[u]  & UINT64_C(0xFF00FF00FF00FF00) )
-              )         & UINT64_C(0xFF00FF00FF00FF00)
-            );
+#if USE_64BIT_ARITH
+static void encodeScalar( const unsigned char * in, unsigned char * out, size_t n ) {
+  const size_t len = n * blockSize;
+  size_t j;
+  for ( j = 0; j + 8 <= len; j += 8 ) {
+    uint64_t a, b, c;
+    memcpy( &a, in + j, 8 );
+    memcpy( &b, in + j - blockSize, 8 );
+    c =  ( ( ( a  | UINT64_C(0xFF00FF00FF00FF00) )
+            -( b  & UINT64_C(0x00FF00FF00FF00FF) )
+           )      & UINT64_C(0x00FF00FF00FF00FF)
+         )
+       | ( ( ( a  | UINT64_C(0x00FF00FF00FF00FF) )
+            -( b  & UINT64_C(0xFF00FF00FF00FF00) )
+           )      & UINT64_C(0xFF00FF00FF00FF00)
+         );
+    memcpy( out + j, &c, 8 );
   }
+  for ( ; j < len; ++j )
+    out[j] = in[j] - in[j - blockSize];
 }
 #else
-#pragma message "compiling encode() with fallback options"
-static inline void encode( unsigned char * c, const unsigned char * a, const unsigned char * b, size_t uBlockLen ) {
-  size_t u;
-  for ( u = 0; u < uBlockLen; ++u )
-    c[u] = a[u] - b[u];
+static void encodeScalar( const unsigned char * in, unsigned char * out, size_t n ) {
+  const size_t len = n * blockSize;
+  size_t j;
+  for ( j = 0; j < len; ++j )
+    out[j] = in[j] - in[j - blockSize];
 }
 #endif
 
+static void decodeScalar( const unsigned char * in, unsigned char * out, size_t n, unsigned char * state ) {
+  size_t r;
+  int u;
+  for ( r = 0; r < n; ++r, in += blockSize, out += blockSize ) {
+    for ( u = 0; u < blockSize; ++u )
+      out[u] = state[u] = (unsigned char)( state[u] + in[u] );
+  }
+}
+
 
 #if defined(SSE2_AVAILABLE)
-static inline void decode( __m128i * c, const __m128i * a, size_t uBlockLen ) {
-  size_t u;
-  for ( u = 0; u < uBlockLen; ++u ) {
-    c[u] = _mm_add_epi8( c[u], a[u] );
+
+static void encodeSSE2( const unsigned char * in, unsigned char * out, size_t n ) {
+  const size_t len = n * blockSize;
+  size_t j;
+  for ( j = 0; j < len; j += sizeof(__m128i) ) {
+    const __m128i a = _mm_loadu_si128( (const __m128i *)( in + j ) );
+    const __m128i b = _mm_loadu_si128( (const __m128i *)( in + j - blockSize ) );
+    _mm_storeu_si128( (__m128i *)( out + j ), _mm_sub_epi8( a, b ) );
   }
 }
-#elif USE_64BIT_ARITH
-static inline void decode( uint64_t * c, const uint64_t * a, size_t uBlockLen ) {
-  size_t u;
-  for ( u = 0; u < uBlockLen; ++u ) {
-    /* wp[u] = wp[u] + rp[u]; */
-    c[u] = ( ( ( c[u] & UINT64_C(0x00FF00FF00FF00FF) )
-              +( a[u] & UINT64_C(0x00FF00FF00FF00FF) )
-             )        & UINT64_C(0x00FF00FF00FF00FF)
-           )
-         | ( ( ( c[u] & UINT64_C(0xFF00FF00FF00FF00) )
-              +( a[u] & UINT64_C(0xFF00FF00FF00FF00) )
-             )        & UINT64_C(0xFF00FF00FF00FF00)
-           );
+
+static void decodeSSE2( const unsigned char * in, unsigned char * out, size_t n, unsigned char * state ) {
+  const int nv = ( blockSize + (int)sizeof(__m128i) - 1 ) / (int)sizeof(__m128i);
+  __m128i s[MAX_STATEVEC];
+  size_t r;
+  int v;
+  for ( v = 0; v < nv; ++v )
+    s[v] = _mm_loadu_si128( (const __m128i *)state + v );
+  for ( r = 0; r < n; ++r, in += blockSize, out += blockSize ) {
+    for ( v = 0; v < nv; ++v ) {
+      s[v] = _mm_add_epi8( s[v], _mm_loadu_si128( (const __m128i *)in + v ) );
+      _mm_storeu_si128( (__m128i *)out + v, s[v] );
+    }
   }
+  for ( v = 0; v < nv; ++v )
+    _mm_storeu_si128( (__m128i *)state + v, s[v] );
 }
-#else
-static inline void decode( unsigned char * c, const unsigned char * a, size_t uBlockLen ) {
-  size_t u;
-  for ( u = 0; u < uBlockLen; ++u )
-    c[u] += a[u];
+
+__attribute__((target("avx2")))
+static void encodeAVX2( const unsigned char * in, unsigned char * out, size_t n ) {
+  const size_t len = n * blockSize;
+  size_t j;
+  for ( j = 0; j < len; j += sizeof(__m256i) ) {
+    const __m256i a = _mm256_loadu_si256( (const __m256i *)( in + j ) );
+    const __m256i b = _mm256_loadu_si256( (const __m256i *)( in + j - blockSize ) );
+    _mm256_storeu_si256( (__m256i *)( out + j ), _mm256_sub_epi8( a, b ) );
+  }
+}
+
+__attribute__((target("avx2")))
+static void decodeAVX2( const unsigned char * in, unsigned char * out, size_t n, unsigned char * state ) {
+  const int nv = ( blockSize + (int)sizeof(__m256i) - 1 ) / (int)sizeof(__m256i);
+  __m256i s[MAX_STATEVEC];
+  size_t r;
+  int v;
+  for ( v = 0; v < nv; ++v )
+    s[v] = _mm256_loadu_si256( (const __m256i *)state + v );
+  for ( r = 0; r < n; ++r, in += blockSize, out += blockSize ) {
+    for ( v = 0; v < nv; ++v ) {
+      s[v] = _mm256_add_epi8( s[v], _mm256_loadu_si256( (const __m256i *)in + v ) );
+      _mm256_storeu_si256( (__m256i *)out + v, s[v] );
+    }
+  }
+  for ( v = 0; v < nv; ++v )
+    _mm256_storeu_si256( (__m256i *)state + v, s[v] );
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void encodeAVX512( const unsigned char * in, unsigned char * out, size_t n ) {
+  const size_t len = n * blockSize;
+  size_t j;
+  for ( j = 0; j < len; j += sizeof(__m512i) ) {
+    const __m512i a = _mm512_loadu_si512( (const void *)( in + j ) );
+    const __m512i b = _mm512_loadu_si512( (const void *)( in + j - blockSize ) );
+    _mm512_storeu_si512( (void *)( out + j ), _mm512_sub_epi8( a, b ) );
+  }
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void decodeAVX512( const unsigned char * in, unsigned char * out, size_t n, unsigned char * state ) {
+  const int nv = ( blockSize + (int)sizeof(__m512i) - 1 ) / (int)sizeof(__m512i);
+  __m512i s[MAX_STATEVEC];
+  size_t r;
+  int v;
+  for ( v = 0; v < nv; ++v )
+    s[v] = _mm512_loadu_si512( (const void *)( state + v * sizeof(__m512i) ) );
+  for ( r = 0; r < n; ++r, in += blockSize, out += blockSize ) {
+    for ( v = 0; v < nv; ++v ) {
+      s[v] = _mm512_add_epi8( s[v], _mm512_loadu_si512( (const void *)( in + v * sizeof(__m512i) ) ) );
+      _mm512_storeu_si512( (void *)( out + v * sizeof(__m512i) ), s[v] );
+    }
+  }
+  for ( v = 0; v < nv; ++v )
+    _mm512_storeu_si512( (void *)( state + v * sizeof(__m512i) ), s[v] );
 }
+
 #endif
 
 #pragma GCC pop_options
 
 
+/* selects kernels for the cpu at runtime. returns vector size in bytes - or 0 for scalar */
+static
+int selectKernels( EncodeFunc * enc, DecodeFunc * dec, int verboseFlag )
+{
+  *enc = encodeScalar;
+  *dec = decodeScalar;
+#if defined(SSE2_AVAILABLE)
+  __builtin_cpu_init();
+  if ( __builtin_cpu_supports("avx512bw") && blockSize <= MAX_STATEVEC * 64 ) {
+    *enc = encodeAVX512;
+    *dec = decodeAVX512;
+    if (verboseFlag >= 2)
+      fprintf(stderr, "using AVX-512 intrinsics\n");
+    return 64;
+  }
+  if ( __builtin_cpu_supports("avx2") && blockSize <= MAX_STATEVEC * 32 ) {
+    *enc = encodeAVX2;
+    *dec = decodeAVX2;
+    if (verboseFlag >= 2)
+      fprintf(stderr, "using AVX2 intrinsics\n");
+    return 32;
+  }
+  if ( blockSize <= MAX_STATEVEC * 16 ) {
+    *enc = encodeSSE2;
+    *dec = decodeSSE2;
+    if (verboseFlag >= 2)
+      fprintf(stderr, "using SSE2 intrinsics\n");
+    return 16;
+  }
+#endif
+  if (verboseFlag >= 2)
+    fprintf(stderr, "using scalar code\n");
+  return 0;
+}
+
+
+/* gap coding mode - see gapcodec.h. returns exit code */
+static
+int gapEncode( FILE * inp, FILE * out, unsigned char * buf, size_t batchRecs, int verboseFlag )
+{
+  struct GapEncoder e;
+  unsigned long long numRecs = 0;
+  size_t fill = 0;
+  int ret = 0;
+
+  if ( gapEncoderInit( &e, out, blockSize ) ) {
+    fprintf(stderr, "error writing gap coding header to output!\n");
+    gapEncoderFinish( &e );
+    return 8;
+  }
+  while ( !ret ) {
+    size_t rd = fread( buf + fill, 1, batchRecs * blockSize - fill, inp );
+    size_t n;
+    fill += rd;
+    if ( ferror(inp) ) {
+      fprintf(stderr, "error reading from input!\n");
+      ret = 9;
+      break;
+    }
+    n = fill / blockSize;
+    if ( !n )
+      break;
+    if ( gapEncoderPut( &e, buf, n ) ) {
+      fprintf(stderr, "error writing to output!\n");
+      ret = 8;
+    }
+    srdsStatRecords( &telemetry, n );
+    numRecs += n;
+    fill -= n * blockSize;
+    memmove( buf, buf + n * blockSize, fill );
+    if ( feof(inp) )
+      break;
+  }
+  if ( !ret && fill && verboseFlag )
+    fprintf(stderr, "warning: ignoring %u trailing bytes - not a multiple of blockSize %d\n", (unsigned)fill, blockSize);
+  if ( gapEncoderFinish( &e ) && !ret ) {
+    fprintf(stderr, "error writing to output!\n");
+    ret = 8;
+  }
+  if ( !ret && verboseFlag )
+    fprintf(stderr, "gap coded %llu data sets into %llu bytes: %.3f bytes per data set\n",
+            numRecs, e.bytesWritten, numRecs ? (double)e.bytesWritten / numRecs : 0.0);
+  return ret;
+}
+
+/* header holds the GAP_HEADER_SIZE bytes already read from inp. returns exit code */
+static
+int gapDecode( FILE * inp, FILE * out, const unsigned char * header, unsigned char * buf, size_t batchRecs )
+{
+  struct GapDecoder d;
+  long n;
+  int ret = 0;
+
+  if ( gapDecoderInit( &d, inp, blockSize, header ) < 0 ) {
+    fprintf(stderr, "error: input is no gap coded stream with blockSize %d!\n", blockSize);
+    gapDecoderFree( &d );
+    return 9;
+  }
+  while ( ( n = gapDecoderGet( &d, buf, batchRecs ) ) > 0 ) {
+    if ( fwrite( buf, blockSize, (size_t)n, out ) != (size_t)n ) {
+      fprintf(stderr, "error writing to output!\n");
+      ret = 8;
+      break;
+    }
+    srdsStatRecords( &telemetry, (uint64_t)n );
+  }
+  if ( n < 0 ) {
+    fprintf(stderr, "error reading gap coded input!\n");
+    ret = 9;
+  }
+  gapDecoderFree( &d );
+  return ret;
+}
+
 
 static
 void usage() {
-  fputs("Usage: srdshashencode [-v][-h][-B <bufferSize>][-c|-d][-l <blockLength>] [-i <input>] [-o <output>]\n", stderr);
+  fputs("Usage: srdshashencode [-v][-h][-B <bufferSize>][-c|-d][-g][-l <blockLength>] [-i <input>] [-o <output>][-D <mode>][-P <sec>][-J <json>]\n", stderr);
   fputs("  sorted raw data set hash coding\n", stderr);
   fputs("  encoding preconditons sorted hash data for better compression\n", stderr);
   fputs("  -v     verbose output\n", stderr);
   fputs("  -h     print usage\n",stderr);
-  fputs("  -B <v> bufferSize in kBytes\n", stderr);
+  fputs("  -B <v> bufferSize in kBytes. data sets are processed in batches of this size\n", stderr);
   fputs("  -c     encode data (=default)\n",stderr);
-  fputs("  -d     decode data\n",stderr);
+  fputs("  -d     decode data. gap coded input is detected automatically\n",stderr);
+  fputs("  -g     gap coding: Rice coded big integer differences - no external compressor needed.\n",stderr);
+  fputs("         ~ 16.7 bytes per SHA-1 for the full HIBP list\n",stderr);
   fputs("  -l <v> length of each raw data set block in bytes (= cycle length, 20 for SHA-1)\n", stderr);
   fputs("  -i <f> input from file. default is stdin\n", stderr);
   fputs("  -o <f> output to file. default is stdout\n", stderr);
+  fputs("  -D <m> I/O mode of regular files: 'cache' (default), 'dontneed' drops the pages behind\n", stderr);
+  fputs("         or 'direct' for O_DIRECT - leaving the page cache to the lookups\n", stderr);
+  fputs("  -P <v> print progress to stderr every v seconds\n", stderr);
+  fputs("  -J <f> write summary with timing of read/process/write phases as JSON to file. '-' for stderr\n", stderr);
 }
 
 
@@ -134,33 +335,31 @@ int main(int argc, char *argv[]) {
   FILE * inp = stdin;
   FILE * out = stdout;
   const char * outfn = NULL;
+  const char * jsonFn = NULL;
+  double progressInterval = 0.0;
   int helpFlag = 0, verboseFlag = 0;
-  int encodeFlag = 1;
-  int optFlag, k, ret = 0;
+  int encodeFlag = 1, gapFlag = 0;
+  int ioMode = SRDSIO_CACHE;
+  int optFlag, ret = 0;
   size_t vBufSize = 0;
-  void * rdBuffer = NULL;
-  void * wrBuffer = NULL;
-  void * vbuf[4];
-#if defined(SSE2_AVAILABLE)
-  __m128i * ubuf[4];
-#elif USE_64BIT_ARITH
-  uint64_t * ubuf[4];
-#else
-  unsigned char * ubuf[4];
-#endif
-
-
-  size_t rd, wr;
+  size_t batchRecs, stateSize, fill = 0;
+  unsigned char * inBuf = NULL;
+  unsigned char * outBuf = NULL;
+  unsigned char * state = NULL;
+  unsigned char * in;
+  EncodeFunc encode;
+  DecodeFunc decode;
   extern int optind;
 
   /* parse command line options */
-  while ((optFlag = getopt(argc, argv, "vhB:cdxl:i:o:")) > 0 && optFlag != '?') {
+  while ((optFlag = getopt(argc, argv, "vhB:cdgxl:i:o:D:P:J:")) > 0 && optFlag != '?') {
     switch(optFlag) {
     case 'v': ++verboseFlag; break;
     case 'h': ++helpFlag; break;
     case 'B': vBufSize = (size_t)( atol(optarg) * 1024 ); break;
     case 'c': encodeFlag = 1; break;
     case 'd': encodeFlag = 0; break;
+    case 'g': ++gapFlag; break;
     case 'l':
       blockSize = atoi(optarg);
       if ( verboseFlag >= 2 )
@@ -176,6 +375,15 @@ int main(int argc, char *argv[]) {
     case 'o':
       outfn = optarg;
       break;
+    case 'D':
+      ioMode = srdsIoParseMode(optarg);
+      if ( ioMode < 0 ) {
+        fprintf(stderr, "error: unknown I/O mode '%s'!\n", optarg);
+        return 10;
+      }
+      break;
+    case 'P': progressInterval = atof(optarg); break;
+    case 'J': jsonFn = optarg; break;
     }
   }
 
@@ -196,6 +404,10 @@ int main(int argc, char *argv[]) {
     fprintf(stderr, "error: blockSize %d is <= 0 !\n", blockSize);
     return 10;
   }
+  if ( gapFlag && encodeFlag && blockSize > GAP_MAX_BLOCKSIZE ) {
+    fprintf(stderr, "error: gap coding requires blockSize <= %d !\n", GAP_MAX_BLOCKSIZE);
+    return 10;
+  }
 
   if ( outfn )
   {
@@ -206,166 +418,107 @@ int main(int argc, char *argv[]) {
     }
   }
 
-  const size_t blkMemSize = (blockSize + 15) & (~15); // round up to 16 byte blocks
-#if defined(SSE2_AVAILABLE)
-  const size_t uBlockLen = (blockSize + sizeof(__m128i) -1) / sizeof(__m128i);
-#elif USE_64BIT_ARITH
-  const size_t uBlockLen = (blockSize + sizeof(uint64_t) -1) / sizeof(uint64_t);
-#else
-  const size_t uBlockLen = blockSize;
-#endif
-
-  vbuf[0] = malloc( blkMemSize );
-  vbuf[1] = malloc( blkMemSize );
-  vbuf[2] = malloc( blkMemSize );
-#if defined(SSE2_AVAILABLE)
-  ubuf[0] = (__m128i *)vbuf[0];
-  ubuf[1] = (__m128i *)vbuf[1];
-  ubuf[2] = (__m128i *)vbuf[2];
-#elif USE_64BIT_ARITH
-  ubuf[0] = (uint64_t *)vbuf[0];
-  ubuf[1] = (uint64_t *)vbuf[1];
-  ubuf[2] = (uint64_t *)vbuf[2];
-#else
-  ubuf[0] = (unsigned char *)vbuf[0];
-  ubuf[1] = (unsigned char *)vbuf[1];
-  ubuf[2] = (unsigned char *)vbuf[2];
-#endif
-
-  memset( vbuf[0], 0, blkMemSize );
-  k = 0;
-
-#if defined(SSE2_AVAILABLE)
-  if (verboseFlag >= 2)
-    fprintf(stderr, "using SSE2 intrinsics\n");
-#endif
+  srdsStatInit( &telemetry, "srdshashencode", progressInterval, progressInterval > 0.0 || jsonFn );
+  srdsStatInputSize( &telemetry, inp );
+  inp = srdsIoWrap( &telemetry, inp, 0, ioMode );
+  out = srdsIoWrap( &telemetry, out, 1, ioMode );
 
-  /* use delta algorithm
-   * compression over delta-algorithm produces smaller files
-   * compared to easier and symmetric xor !
-   */
+  selectKernels( &encode, &decode, verboseFlag );
 
   /*
-   * init:
-   * k = 0
-   * [0] = 00
-   *
-   * encode iterations:                     decode iteration:
-   * j = k      // old is j
-   * k = 1 - k  // new is k
-   * [k] = read()                           [1] = read
-   * [2] = [k] - [j] --> write()            [0] = [1] + [0] --> write()
-   *
-   *
-   * in iteration 1:
-   * j = 0; k = 1
-   * [1] = read(), eg. A                    [1] = read == A
-   * [2] = [1]-[0]: A-0=A --> write()       [0] = [1]+[0]: A+0 = A ==> OK
-   *
-   * in iteration 2:
-   * j = 1; k = 0
-   * [0] = read(), eg. B                    [1] = read() == B-A
-   * [2] = [0]-[1]: B-A --> write()         [0] = [1]+[0]: (B-A)+A = B ==> OK
-   *
-   * in iteration 3:
-   * j = 0; k = 1
-   * [1] = read(), eg. C                    [1] = read() == C-B
-   * [2] = [1]-[0]: C-B --> write()         [0] = [1]+[0]: (C-B)+B = C ==> OK
-   *
-   * in iteration 4:
-   * j = 1; k = 0
-   * [0] = read(), eg. D                    [1] = read() == D-C
-   * [2] = [0]-[1]: D-C --> write()         [0] = [1]+[0]: (D-C)+C = D ==> OK
-   *
+   * buffer layout: [ previous record ][ batchRecs records ][ BUF_PAD ]
+   * the previous (raw) record in front is needed for encode()
    */
-
   {
-    size_t bufferSize = vBufSize ? vBufSize
-                                 : (4*blockSize > 65536)
-                                   ? (4*blockSize)
-                                   : 65536;
-    rdBuffer = malloc( bufferSize );
-    wrBuffer = malloc( bufferSize );
-    if (rdBuffer) setbuffer( inp, rdBuffer, bufferSize );
-    if (wrBuffer) setbuffer( out, wrBuffer, bufferSize );
+    size_t bufferSize = vBufSize ? vBufSize : ( 1024 * 1024 );
+    batchRecs = bufferSize / blockSize;
+    if ( batchRecs < 1 )
+      batchRecs = 1;
+  }
+  stateSize = (size_t)blockSize + BUF_PAD;
+  inBuf = (unsigned char *)calloc( 1, blockSize + batchRecs * blockSize + BUF_PAD );
+  outBuf = (unsigned char *)malloc( batchRecs * blockSize + BUF_PAD );
+  state = (unsigned char *)calloc( 1, stateSize + BUF_PAD * MAX_STATEVEC );
+  if ( !inBuf || !outBuf || !state ) {
+    fprintf(stderr, "error allocating buffers for %lu data sets!\n", (unsigned long)batchRecs);
+    return 10;
+  }
+  in = inBuf + blockSize;
+
+  if ( gapFlag && encodeFlag )
+    ret = gapEncode( inp, out, in, batchRecs, verboseFlag );
+  else if ( !encodeFlag ) {
+    /* detect gap coded input from its magic */
+    while ( fill < GAP_HEADER_SIZE && !feof(inp) && !ferror(inp) )
+      fill += fread( in + fill, 1, GAP_HEADER_SIZE - fill, inp );
+    if ( gapIsStream( in, fill ) ) {
+      ret = gapDecode( inp, out, in, outBuf, batchRecs );
+      fill = 0;
+      gapFlag = 1;
+    }
+    else if ( gapFlag ) {
+      fprintf(stderr, "error: input is no gap coded stream!\n");
+      ret = 9;
+    }
   }
 
-  if (encodeFlag) {
-
-    while ( !feof(inp) ) {
-      const int j = k;
-      k = 1 - k;
-
-      rd = fread( vbuf[k], blockSize, 1, inp );
-      if (!rd) {
-        if (!feof(inp)) {
-          fprintf(stderr, "error reading from input!\n");
-          ret = 9;
-        }
-        break;
-      }
+  while ( !gapFlag && !ret ) {
+    size_t rd, n, w;
 
-      encode( ubuf[2], ubuf[k], ubuf[j], uBlockLen );
-
-      wr = fwrite( vbuf[2], blockSize, 1, out );
-      if (!wr) {
-        int ferr = ferror(out);
-        if (ferr)
-          fprintf(stderr, "error %d writing to output!: %s\n", ferr, strerror(ferr));
-        else
-          fprintf(stderr, "error %d writing to output!\n", ferr);
-        ret = 8;
-        break;
-      }
+    rd = fread( in + fill, 1, batchRecs * blockSize - fill, inp );
+    fill += rd;
+    if ( ferror(inp) ) {
+      fprintf(stderr, "error reading from input!\n");
+      ret = 9;
+      break;
     }
-  }
-  else {
-    /* decode */
-#if defined(SSE2_AVAILABLE)
-  __m128i * rp = ubuf[1];
-  __m128i * wp = ubuf[0];
-#elif USE_64BIT_ARITH
-    uint64_t * rp = ubuf[1];
-    uint64_t * wp = ubuf[0];
-#else
-    unsigned char * rp = ubuf[1];
-    unsigned char * wp = ubuf[0];
-#endif
-    while ( !feof(inp) ) {
-
-      rd = fread( rp, blockSize, 1, inp );
-      if (!rd) {
-        if (!feof(inp)) {
-          fprintf(stderr, "error reading from input!\n");
-          ret = 9;
-        }
-        break;
-      }
+    n = fill / blockSize;
+    if ( !n )
+      break;
 
-      decode( wp, rp, uBlockLen );
-
-      wr = fwrite( wp, blockSize, 1, out );
-      if (!wr) {
-        int ferr = ferror(out);
-        if (ferr)
-          fprintf(stderr, "error %d writing to output!: %s\n", ferr, strerror(ferr));
-        else
-          fprintf(stderr, "error %d writing to output!\n", ferr);
-        
-        ret = 8;
-        break;
-      }
+    if (encodeFlag) {
+      encode( in, outBuf, n );
+      memcpy( inBuf, in + (n - 1) * blockSize, blockSize );
+    }
+    else
+      decode( in, outBuf, n, state );
+
+    w = fwrite( outBuf, blockSize, n, out );
+    if ( w != n ) {
+      int ferr = ferror(out);
+      if (ferr)
+        fprintf(stderr, "error %d writing to output!: %s\n", ferr, strerror(ferr));
+      else
+        fprintf(stderr, "error %d writing to output!\n", ferr);
+      ret = 8;
+      break;
     }
+    srdsStatRecords( &telemetry, n );
+
+    /* keep incomplete record - only possible at end of input */
+    fill -= n * blockSize;
+    memmove( in, in + n * blockSize, fill );
+    if ( feof(inp) )
+      break;
   }
 
-  if ( out != stdout ) {
-    fclose(out);
-    free( wrBuffer );
+  if ( fill && !ret && verboseFlag )
+    fprintf(stderr, "warning: ignoring %u trailing bytes - not a multiple of blockSize %d\n", (unsigned)fill, blockSize);
+
+  free(inBuf);
+  free(outBuf);
+  free(state);
+
+  if ( out != stdout && fclose(out) && !ret ) {
+    fprintf(stderr, "error writing to output!\n");
+    ret = 8;
   }
-  if ( inp != stdin ) {
+  if ( inp != stdin )
     fclose(inp);
-    free( rdBuffer );
-  }
 
+  if ( srdsStatSummary( &telemetry, jsonFn, ret ) && !ret ) {
+    fprintf(stderr, "error writing summary to '%s'\n", jsonFn);
+    ret = 8;
+  }
   return ret;
 }
@@ -0,0 +1,285 @@
+/*
+ * srdshot.h
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * hot hash sidecar of a sorted raw data set (srds) file:
+ * the top N records by prevalence (the ':COUNT' column of the HIBP lists).
+ * hex2rds collects them in a bounded min-heap - while converting.
+ * srdsgrep loads them into an open addressing hash table and checks it
+ * before searching the file: the most frequent hits need no file access.
+ *
+ * file format - all numbers little endian:
+ *   8 bytes   magic "SRDSHOT1"
+ *   4 bytes   blockSize
+ *   4 bytes   number of entries
+ *   8 bytes   number of records of the srds file - to detect a mismatch
+ *   entries - ascending by record:
+ *     blockSize bytes  record
+ *     8 bytes          prevalence: sum of counts
+ *     4 bytes          number of occurrences in the srds file
+ *
+ * Author:  Hayati Ayguen
+ */
+
+#ifndef SRDSHOT_H
+#define SRDSHOT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "srdsindex.h"
+
+#define SRDSHOT_MAGIC        "SRDSHOT1"
+#define SRDSHOT_HEADER_SIZE  24
+
+/* min-heap by prevalence of the top 'cap' records */
+struct SrdsHotHeap {
+  int blockSize;
+  uint32_t cap;
+  uint32_t n;
+  uint64_t * count;
+  uint32_t * occ;
+  unsigned char * recs;
+};
+
+struct SrdsHotSlot {
+  uint64_t key64;
+  uint32_t idx;            /* entry + 1. 0 for empty slot */
+};
+
+/* open addressing - linear probing - table of the sidecar's entries */
+struct SrdsHotTable {
+  int blockSize;
+  int bits;
+  uint32_t n;
+  uint64_t numRecords;
+  unsigned char * entries; /* as in file */
+  struct SrdsHotSlot * slots;
+};
+
+
+/* returns 0 on success */
+static
+int srdsHotHeapInit( struct SrdsHotHeap * h, int blockSize, uint32_t cap )
+{
+  memset( h, 0, sizeof(*h) );
+  h->blockSize = blockSize;
+  h->cap = cap;
+  h->count = (uint64_t *)malloc( ( cap + 1 ) * sizeof(uint64_t) );
+  h->occ = (uint32_t *)malloc( ( cap + 1 ) * sizeof(uint32_t) );
+  h->recs = (unsigned char *)malloc( ( cap + 1 ) * (size_t)blockSize );
+  return ( h->count && h->occ && h->recs ) ? 0 : -1;
+}
+
+static
+void srdsHotHeapFree( struct SrdsHotHeap * h )
+{
+  free( h->count );
+  free( h->occ );
+  free( h->recs );
+  memset( h, 0, sizeof(*h) );
+}
+
+static inline
+void srdsHotHeapSwap( struct SrdsHotHeap * h, uint32_t a, uint32_t b )
+{
+  const size_t bs = (size_t)h->blockSize;
+  uint64_t c = h->count[a];
+  uint32_t o = h->occ[a];
+  h->count[a] = h->count[b];  h->count[b] = c;
+  h->occ[a] = h->occ[b];  h->occ[b] = o;
+  /* entry 'cap' is scratch space */
+  memcpy( h->recs + h->cap * bs, h->recs + a * bs, bs );
+  memcpy( h->recs + a * bs, h->recs + b * bs, bs );
+  memcpy( h->recs + b * bs, h->recs + h->cap * bs, bs );
+}
+
+/* offer a record with its prevalence. O(1) if it is below the current top N */
+static inline
+void srdsHotHeapAdd( struct SrdsHotHeap * h, const unsigned char * rec, uint64_t count, uint32_t occ )
+{
+  uint32_t i;
+  if ( !h->cap || ( h->n == h->cap && count <= h->count[0] ) )
+    return;
+  if ( h->n < h->cap ) {
+    /* append and sift up */
+    i = h->n++;
+    h->count[i] = count;
+    h->occ[i] = occ;
+    memcpy( h->recs + (size_t)i * h->blockSize, rec, h->blockSize );
+    while ( i && h->count[ ( i - 1 ) / 2 ] > h->count[i] ) {
+      srdsHotHeapSwap( h, i, ( i - 1 ) / 2 );
+      i = ( i - 1 ) / 2;
+    }
+    return;
+  }
+  /* replace minimum and sift down */
+  h->count[0] = count;
+  h->occ[0] = occ;
+  memcpy( h->recs, rec, h->blockSize );
+  for ( i = 0; ; ) {
+    const uint32_t l = 2 * i + 1, r = l + 1;
+    uint32_t m = i;
+    if ( l < h->n && h->count[l] < h->count[m] )
+      m = l;
+    if ( r < h->n && h->count[r] < h->count[m] )
+      m = r;
+    if ( m == i )
+      break;
+    srdsHotHeapSwap( h, i, m );
+    i = m;
+  }
+}
+
+static const struct SrdsHotHeap * srdsHotSortHeap = NULL;
+
+static
+int srdsHotCompare( const void * a, const void * b )
+{
+  const size_t bs = (size_t)srdsHotSortHeap->blockSize;
+  return memcmp( srdsHotSortHeap->recs + *(const uint32_t *)a * bs,
+                 srdsHotSortHeap->recs + *(const uint32_t *)b * bs, bs );
+}
+
+/* writes the heap's entries ascending by record. returns 0 on success */
+static
+int srdsHotWrite( const struct SrdsHotHeap * h, const char * fn, uint64_t numRecords )
+{
+  uint32_t * order = (uint32_t *)malloc( ( h->n + 1 ) * sizeof(uint32_t) );
+  unsigned char e[SRDSHOT_HEADER_SIZE];
+  FILE * fp = fopen( fn, "wb" );
+  uint32_t k;
+  int ret = 0;
+
+  if ( !order || !fp ) {
+    free( order );
+    if ( fp )
+      fclose( fp );
+    return -1;
+  }
+  for ( k = 0; k < h->n; ++k )
+    order[k] = k;
+  srdsHotSortHeap = h;
+  qsort( order, h->n, sizeof(uint32_t), srdsHotCompare );
+
+  memcpy( e, SRDSHOT_MAGIC, 8 );
+  putLE32( e + 8, (uint32_t)h->blockSize );
+  putLE32( e + 12, h->n );
+  putLE64( e + 16, numRecords );
+  if ( fwrite( e, SRDSHOT_HEADER_SIZE, 1, fp ) != 1 )
+    ret = -1;
+  for ( k = 0; !ret && k < h->n; ++k ) {
+    putLE64( e, h->count[ order[k] ] );
+    putLE32( e + 8, h->occ[ order[k] ] );
+    if ( fwrite( h->recs + (size_t)order[k] * h->blockSize, h->blockSize, 1, fp ) != 1
+         || fwrite( e, 12, 1, fp ) != 1 )
+      ret = -1;
+  }
+  if ( fclose( fp ) )
+    ret = -1;
+  free( order );
+  return ret;
+}
+
+
+static inline
+uint32_t srdsHotSlotOf( const struct SrdsHotTable * t, uint64_t key64 )
+{
+  /* hashes are uniform already - the multiply spreads other keys */
+  return (uint32_t)( ( key64 * 0x9E3779B97F4A7C15ULL ) >> ( 64 - t->bits ) );
+}
+
+static inline
+const unsigned char * srdsHotEntry( const struct SrdsHotTable * t, uint32_t idx )
+{
+  return t->entries + (size_t)idx * ( t->blockSize + 12 );
+}
+
+static
+void srdsHotFree( struct SrdsHotTable * t )
+{
+  free( t->entries );
+  free( t->slots );
+  memset( t, 0, sizeof(*t) );
+}
+
+/* loads the sidecar into a table with load factor <= 0.5. returns 0 on success */
+static
+int srdsHotLoad( struct SrdsHotTable * t, const char * fn )
+{
+  unsigned char h[SRDSHOT_HEADER_SIZE];
+  FILE * fp = fopen( fn, "rb" );
+  size_t entrySize;
+  uint32_t k;
+
+  memset( t, 0, sizeof(*t) );
+  if ( !fp )
+    return -1;
+  if ( fread( h, SRDSHOT_HEADER_SIZE, 1, fp ) != 1 || memcmp( h, SRDSHOT_MAGIC, 8 ) ) {
+    fclose( fp );
+    return -1;
+  }
+  t->blockSize = (int)getLE32( h + 8 );
+  t->n = getLE32( h + 12 );
+  t->numRecords = getLE64( h + 16 );
+  entrySize = (size_t)t->blockSize + 12;
+  for ( t->bits = 4; ( (uint64_t)1 << t->bits ) < 2 * (uint64_t)t->n; ++t->bits )
+    ;
+  t->entries = (unsigned char *)malloc( t->n * entrySize + 1 );
+  t->slots = (struct SrdsHotSlot *)calloc( (size_t)1 << t->bits, sizeof(struct SrdsHotSlot) );
+  if ( t->blockSize <= 0 || !t->entries || !t->slots
+       || fread( t->entries, entrySize, t->n, fp ) != t->n ) {
+    fclose( fp );
+    srdsHotFree( t );
+    return -1;
+  }
+  fclose( fp );
+
+  for ( k = 0; k < t->n; ++k ) {
+    const unsigned char * rec = srdsHotEntry( t, k );
+    const uint64_t key64 = keyPrefix64( rec, t->blockSize, 0 );
+    const uint32_t mask = ( (uint32_t)1 << t->bits ) - 1;
+    uint32_t s = srdsHotSlotOf( t, key64 );
+    while ( t->slots[s].idx )
+      s = ( s + 1 ) & mask;
+    t->slots[s].key64 = key64;
+    t->slots[s].idx = k + 1;
+  }
+  return 0;
+}
+
+/* entry index of the record equal to key - or -1. key must have full blockSize */
+static inline
+long srdsHotFind( const struct SrdsHotTable * t, const unsigned char * key, int keyLen )
+{
+  const uint64_t key64 = keyPrefix64( key, keyLen, 0 );
+  const uint32_t mask = ( (uint32_t)1 << t->bits ) - 1;
+  uint32_t s;
+  if ( keyLen != t->blockSize || !t->n )
+    return -1;
+  for ( s = srdsHotSlotOf( t, key64 ); t->slots[s].idx; s = ( s + 1 ) & mask ) {
+    if ( t->slots[s].key64 == key64
+         && !memcmp( srdsHotEntry( t, t->slots[s].idx - 1 ), key, keyLen ) )
+      return (long)t->slots[s].idx - 1;
+  }
+  return -1;
+}
+
+/* prevalence and number of occurrences of entry */
+static inline
+uint64_t srdsHotCount( const struct SrdsHotTable * t, long idx )
+{
+  return getLE64( srdsHotEntry( t, (uint32_t)idx ) + t->blockSize );
+}
+
+static inline
+uint32_t srdsHotOccurrences( const struct SrdsHotTable * t, long idx )
+{
+  return getLE32( srdsHotEntry( t, (uint32_t)idx ) + t->blockSize + 8 );
+}
+
+#endif /* SRDSHOT_H */
@@ -0,0 +1,131 @@
+/*
+ * srdsilv.h
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * interleaved binary searches in a memory mapped sorted raw data set:
+ * in memory, each probe of a binary search is a dependent cache miss of ~100 ns.
+ * a single search is bound by this latency - while the memory bandwidth is idle.
+ * here, up to 'width' searches advance alternately on one thread - each as a
+ * state machine: a step compares one probe, prefetches the next probe -
+ * and switches to the next search. while the other searches step,
+ * the prefetched cache line arrives. the search itself is unchanged:
+ * lower bound by bisection, then the matches are counted sequentially.
+ *
+ * Author:  Hayati Ayguen
+ */
+
+#ifndef SRDSILV_H
+#define SRDSILV_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define SRDSILV_MAX_WIDTH  64
+
+#if defined(__GNUC__)
+#define SRDSILV_PREFETCH( p )  __builtin_prefetch( (p) )
+#else
+#define SRDSILV_PREFETCH( p )  ( (void)(p) )
+#endif
+
+struct SrdsIlvJob {
+  const unsigned char * key;
+  int keyLen;
+  uint64_t lo, hi;      /* in: records [lo, hi) to bisect. out: the matching records [lo, hi) */
+};
+
+/* one search in flight */
+struct SrdsIlvSlot {
+  struct SrdsIlvJob * job;
+  uint64_t lo, hi;
+  int scan;             /* bisection is done: count the matches at lo */
+};
+
+/* prefetch the key bytes of record r - which might span two cache lines */
+static inline
+void srdsIlvPrefetch( const unsigned char * data, int blockSize, int keyBeg, int keyLen, uint64_t r )
+{
+  const unsigned char * p = data + r * (uint64_t)blockSize + keyBeg;
+  SRDSILV_PREFETCH( p );
+  SRDSILV_PREFETCH( p + keyLen - 1 );
+}
+
+/*
+ * searches all jobs in the numRecords records of blockSize bytes at data - width of them interleaved.
+ * the key of each job is compared at offset keyBeg of the records. records are in ascending order -
+ * descending with reverse. a match at the lower bound is only found inside the job's range,
+ * while the matches are counted up to numRecords - but at most maxCount.
+ */
+static
+void srdsIlvSearch( const unsigned char * data, uint64_t numRecords, int blockSize, int keyBeg, int reverse,
+                    struct SrdsIlvJob * jobs, int numJobs, int width, uint64_t maxCount )
+{
+  struct SrdsIlvSlot slots[SRDSILV_MAX_WIDTH];
+  int nextJob = 0, active = 0, k;
+
+  if ( width < 1 )
+    width = 1;
+  else if ( width > SRDSILV_MAX_WIDTH )
+    width = SRDSILV_MAX_WIDTH;
+  for ( k = 0; k < width; ++k )
+    slots[k].job = NULL;
+
+  while ( active || nextJob < numJobs ) {
+    for ( k = 0; k < width; ++k ) {
+      struct SrdsIlvSlot * s = &slots[k];
+      struct SrdsIlvJob * j = s->job;
+      int cmp;
+
+      if ( !j ) {
+        /* start next search - its first probe is prefetched */
+        if ( nextJob >= numJobs )
+          continue;
+        j = s->job = &jobs[ nextJob++ ];
+        s->lo = j->lo;
+        s->hi = ( j->hi < numRecords ) ? j->hi : numRecords;
+        s->scan = 0;
+        ++active;
+        if ( s->lo < s->hi )
+          srdsIlvPrefetch( data, blockSize, keyBeg, j->keyLen, s->lo + ( s->hi - s->lo ) / 2 );
+        continue;
+      }
+
+      if ( !s->scan ) {
+        /* one bisection step - with the prefetched probe */
+        if ( s->lo < s->hi ) {
+          const uint64_t mid = s->lo + ( s->hi - s->lo ) / 2;
+          cmp = memcmp( data + mid * (uint64_t)blockSize + keyBeg, j->key, j->keyLen );
+          if ( reverse )
+            cmp = -cmp;
+          if ( cmp < 0 )
+            s->lo = mid + 1;
+          else
+            s->hi = mid;
+        }
+        if ( s->lo < s->hi ) {
+          srdsIlvPrefetch( data, blockSize, keyBeg, j->keyLen, s->lo + ( s->hi - s->lo ) / 2 );
+          continue;
+        }
+        s->scan = 1;
+        if ( s->lo < j->hi && s->lo < numRecords )
+          srdsIlvPrefetch( data, blockSize, keyBeg, j->keyLen, s->lo );
+        continue;
+      }
+
+      /* count the matches at the lower bound - outside the job's range no probe matched */
+      s->hi = s->lo;
+      if ( s->lo < j->hi )
+        while ( s->hi < numRecords && s->hi - s->lo < maxCount
+                && !memcmp( data + s->hi * (uint64_t)blockSize + keyBeg, j->key, j->keyLen ) )
+          ++s->hi;
+      j->lo = s->lo;
+      j->hi = s->hi;
+      s->job = NULL;
+      --active;
+    }
+  }
+}
+
+#endif /* SRDSILV_H */
@@ -0,0 +1,206 @@
+/*
+ * srdsindex.h
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * prefix bucket index for sorted raw data set (srds) files:
+ * for every value p of the leading 'prefixBits' bits of the key,
+ * the index holds the number of the first record with prefix >= p.
+ * entry 2^prefixBits is the total number of records.
+ * so the records with prefix p are [ entry[p], entry[p+1] ).
+ *
+ * file format - all numbers little endian:
+ *   8 bytes   magic "SRDSIDX1"
+ *   4 bytes   prefixBits
+ *   4 bytes   blockSize
+ *   8 bytes   number of records
+ *   8 bytes * ( 2^prefixBits + 1 )  entries
+ *
+ * the index is written streaming - while records are produced in ascending order.
+ *
+ * Author:  Hayati Ayguen
+ */
+
+#ifndef SRDSINDEX_H
+#define SRDSINDEX_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#define SRDSIDX_MAGIC        "SRDSIDX1"
+#define SRDSIDX_HEADER_SIZE  24
+#define SRDSIDX_MAX_BITS     28
+
+static inline
+void putLE32( unsigned char * p, uint32_t v )
+{
+  p[0] = (unsigned char)v;  p[1] = (unsigned char)(v >> 8);
+  p[2] = (unsigned char)(v >> 16);  p[3] = (unsigned char)(v >> 24);
+}
+
+static inline
+void putLE64( unsigned char * p, uint64_t v )
+{
+  putLE32( p, (uint32_t)v );
+  putLE32( p + 4, (uint32_t)(v >> 32) );
+}
+
+static inline
+uint32_t getLE32( const unsigned char * p )
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline
+uint64_t getLE64( const unsigned char * p )
+{
+  return (uint64_t)getLE32( p ) | ( (uint64_t)getLE32( p + 4 ) << 32 );
+}
+
+/* leading 'bits' bits of key. missing key bytes are filled with padByte */
+static inline
+uint32_t keyPrefix( const unsigned char * key, int keyLen, int bits, int padByte )
+{
+  uint32_t v = 0;
+  int k;
+  for ( k = 0; k < 4; ++k )
+    v = ( v << 8 ) | (uint32_t)( k < keyLen ? key[k] : padByte );
+  return v >> ( 32 - bits );
+}
+
+/* leading 64 bits of key. missing key bytes are filled with padByte */
+static inline
+uint64_t keyPrefix64( const unsigned char * key, int keyLen, int padByte )
+{
+  uint64_t v = 0;
+  int k;
+  for ( k = 0; k < 8; ++k )
+    v = ( v << 8 ) | (uint64_t)( k < keyLen ? key[k] : padByte );
+  return v;
+}
+
+
+struct SrdsIndexWriter {
+  FILE * fp;
+  int prefixBits;
+  int blockSize;
+  uint64_t nextBucket;
+  uint64_t numRecords;
+};
+
+static
+int srdsIndexWriteHeader( struct SrdsIndexWriter * w )
+{
+  unsigned char h[SRDSIDX_HEADER_SIZE];
+  memcpy( h, SRDSIDX_MAGIC, 8 );
+  putLE32( h + 8, (uint32_t)w->prefixBits );
+  putLE32( h + 12, (uint32_t)w->blockSize );
+  putLE64( h + 16, w->numRecords );
+  return fwrite( h, SRDSIDX_HEADER_SIZE, 1, w->fp ) == 1 ? 0 : -1;
+}
+
+/* returns 0 on success */
+static
+int srdsIndexOpen( struct SrdsIndexWriter * w, const char * fn, int prefixBits, int blockSize )
+{
+  memset( w, 0, sizeof(*w) );
+  w->prefixBits = prefixBits;
+  w->blockSize = blockSize;
+  w->fp = fopen( fn, "wb" );
+  if ( !w->fp )
+    return -1;
+  return srdsIndexWriteHeader( w );
+}
+
+/* reopens a partially written index - continuing behind entry nextBucket-1. returns 0 on success */
+static
+int srdsIndexResume( struct SrdsIndexWriter * w, const char * fn, int prefixBits, int blockSize,
+                     uint64_t nextBucket, uint64_t numRecords )
+{
+  const long off = SRDSIDX_HEADER_SIZE + 8 * (long)nextBucket;
+  memset( w, 0, sizeof(*w) );
+  w->prefixBits = prefixBits;
+  w->blockSize = blockSize;
+  w->nextBucket = nextBucket;
+  w->numRecords = numRecords;
+  if ( nextBucket > ( (uint64_t)1 << prefixBits ) + 1 )
+    return -1;
+  w->fp = fopen( fn, "r+b" );
+  if ( !w->fp )
+    return -1;
+  fseek( w->fp, 0, SEEK_END );
+  if ( ftell( w->fp ) < off || fseek( w->fp, off, SEEK_SET ) )
+    return -1;
+  return 0;
+}
+
+/* add next record's key - keys must be in ascending order */
+static inline
+int srdsIndexAdd( struct SrdsIndexWriter * w, const unsigned char * key, int keyLen )
+{
+  const uint64_t p = keyPrefix( key, keyLen, w->prefixBits, 0 );
+  unsigned char e[8];
+  putLE64( e, w->numRecords );
+  for ( ; w->nextBucket <= p; ++w->nextBucket )
+    if ( fwrite( e, 8, 1, w->fp ) != 1 )
+      return -1;
+  ++w->numRecords;
+  return 0;
+}
+
+/* writes remaining entries and final header. returns 0 on success */
+static
+int srdsIndexClose( struct SrdsIndexWriter * w )
+{
+  const uint64_t numBuckets = (uint64_t)1 << w->prefixBits;
+  unsigned char e[8];
+  int ret = 0;
+  putLE64( e, w->numRecords );
+  for ( ; !ret && w->nextBucket <= numBuckets; ++w->nextBucket )
+    if ( fwrite( e, 8, 1, w->fp ) != 1 )
+      ret = -1;
+  if ( !ret && ( fseek( w->fp, 0, SEEK_SET ) || srdsIndexWriteHeader( w ) ) )
+    ret = -1;
+  if ( fclose( w->fp ) )
+    ret = -1;
+  w->fp = NULL;
+  return ret;
+}
+
+
+/*
+ * reads the record range [ *first, *last ), which may hold the key,
+ * from the index file. keyLen might be shorter than the prefix.
+ * returns 0 on success.
+ */
+static
+int srdsIndexLookup( FILE * fp, int blockSize, const unsigned char * key, int keyLen,
+                     uint64_t * first, uint64_t * last, uint64_t * numRecords )
+{
+  unsigned char h[SRDSIDX_HEADER_SIZE];
+  unsigned char e[8];
+  uint32_t lo, hi;
+  int prefixBits;
+
+  if ( fseek( fp, 0, SEEK_SET ) || fread( h, SRDSIDX_HEADER_SIZE, 1, fp ) != 1
+       || memcmp( h, SRDSIDX_MAGIC, 8 ) )
+    return -1;
+  prefixBits = (int)getLE32( h + 8 );
+  if ( prefixBits <= 0 || prefixBits > SRDSIDX_MAX_BITS || (int)getLE32( h + 12 ) != blockSize )
+    return -1;
+  *numRecords = getLE64( h + 16 );
+
+  lo = keyPrefix( key, keyLen, prefixBits, 0x00 );
+  hi = keyPrefix( key, keyLen, prefixBits, 0xFF );
+  if ( fseek( fp, SRDSIDX_HEADER_SIZE + 8 * (long)lo, SEEK_SET ) || fread( e, 8, 1, fp ) != 1 )
+    return -1;
+  *first = getLE64( e );
+  if ( fseek( fp, SRDSIDX_HEADER_SIZE + 8 * ( (long)hi + 1 ), SEEK_SET ) || fread( e, 8, 1, fp ) != 1 )
+    return -1;
+  *last = getLE64( e );
+  return 0;
+}
+
+#endif /* SRDSINDEX_H */
@@ -0,0 +1,549 @@
+/*
+ * srdsio.h
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * page cache friendly streaming I/O of the bulk tools (option -D <mode>):
+ *   cache     default: buffered I/O through the page cache
+ *   dontneed  buffered I/O, but the pages behind the stream position are dropped
+ *             with posix_fadvise(POSIX_FADV_DONTNEED) every SRDSIO_WINDOW bytes.
+ *             written pages are flushed with sync_file_range() before:
+ *             dirty pages can not be dropped.
+ *   direct    O_DIRECT with two aligned buffers, which a helper thread reads ahead
+ *             or writes behind: the file bypasses the page cache - and the I/O
+ *             overlaps with processing. where the filesystem refuses O_DIRECT,
+ *             dontneed is used.
+ * a rebuild of tens of GB then does not evict the working set of the lookups.
+ * dontneed also drops pages of an input, which were cached before -
+ * prefer direct, when reading a file, which is served at the same time.
+ *
+ * only regular files are affected - pipes and terminals are passed to srdsstat.h.
+ * the stream is wrapped with fopencookie() - continuing the telemetry of srdsstat.h:
+ * with direct, read and write time is the time waiting for the helper thread.
+ *
+ * Author:  Hayati Ayguen
+ */
+
+#ifndef SRDSIO_H
+#define SRDSIO_H
+
+#include "srdsstat.h"
+
+enum { SRDSIO_CACHE = 0, SRDSIO_DONTNEED, SRDSIO_DIRECT };
+
+#define SRDSIO_WINDOW   ( 8 << 20 )   /* dontneed: drop pages behind every 8 MB */
+#define SRDSIO_ALIGN    4096          /* direct: alignment of buffers, file offsets and lengths */
+#define SRDSIO_BUFSIZE  ( 4 << 20 )   /* direct: size of each of the two buffers */
+#define SRDSIO_MAXOPEN  8             /* written streams known to srdsIoSync() */
+
+/* mode from argument of option -D. returns -1 for unknown */
+static
+int srdsIoParseMode( const char * s )
+{
+  if ( !strcmp( s, "cache" ) )
+    return SRDSIO_CACHE;
+  if ( !strcmp( s, "dontneed" ) )
+    return SRDSIO_DONTNEED;
+  if ( !strcmp( s, "direct" ) )
+    return SRDSIO_DIRECT;
+  return -1;
+}
+
+#if defined(__GLIBC__) && defined(_GNU_SOURCE)
+
+#include <fcntl.h>
+#include <pthread.h>
+
+struct SrdsIo {
+  struct SrdsStat * s;
+  FILE * fp;                /* original stream - closed with the wrapper, except stdin/stdout */
+  FILE * w;                 /* the wrapping stream */
+  int fd;
+  int mode;
+  int forWrite;
+  int fdFlags;              /* file status flags before O_DIRECT */
+  off_t pos;                /* dontneed: file offset of the stream position */
+  off_t synced;             /* dontneed, write: writeback is started up to here */
+  off_t dropped;            /* dontneed: pages before are dropped */
+
+  /* direct: buffers are handed between the tool and the helper thread */
+  pthread_t thread;
+  pthread_mutex_t mtx;
+  pthread_cond_t cond;
+  unsigned char * buf[2];
+  off_t bufOff[2];          /* aligned file offset of buf[k] */
+  size_t len[2];            /* bytes in buf[k] */
+  int full[2];              /* write: buf[k] is queued for the helper. read: buf[k] is filled by it */
+  int last[2];              /* read: buf[k] ends at end of file - or error */
+  int cur;                  /* the tool's buffer */
+  size_t used;              /* read: consumed bytes of buf[cur] */
+  int err;                  /* errno of the helper's failed pread()/pwrite() */
+  int quit;
+};
+
+static struct SrdsIo * srdsIoWriters[SRDSIO_MAXOPEN];
+
+
+/* reads n bytes - less at end of file. returns bytes read or -1 */
+static
+ssize_t srdsIoPread( int fd, unsigned char * p, size_t n, off_t off )
+{
+  size_t done = 0;
+  while ( done < n ) {
+    const ssize_t r = pread( fd, p + done, n - done, off + (off_t)done );
+    if ( r < 0 && errno == EINTR )
+      continue;
+    if ( r < 0 )
+      return -1;
+    if ( r == 0 )
+      break;
+    done += (size_t)r;
+    if ( done % SRDSIO_ALIGN )
+      break;    /* unaligned short read: end of file */
+  }
+  return (ssize_t)done;
+}
+
+/* returns 0 on success */
+static
+int srdsIoPwrite( int fd, const unsigned char * p, size_t n, off_t off )
+{
+  size_t done = 0;
+  while ( done < n ) {
+    const ssize_t w = pwrite( fd, p + done, n - done, off + (off_t)done );
+    if ( w < 0 && errno == EINTR )
+      continue;
+    if ( w <= 0 )
+      return -1;
+    done += (size_t)w;
+  }
+  return 0;
+}
+
+/* dontneed: drops the pages behind the stream position - written pages after their writeback */
+static
+void srdsIoDropBehind( struct SrdsIo * io, int final )
+{
+  const unsigned waitAll = SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER;
+  if ( !io->forWrite ) {
+    if ( final || io->pos - io->dropped >= SRDSIO_WINDOW ) {
+      /* length 0 is up to the end of file */
+      posix_fadvise( io->fd, io->dropped, final ? 0 : io->pos - io->dropped, POSIX_FADV_DONTNEED );
+      io->dropped = io->pos;
+    }
+    return;
+  }
+  if ( final ) {
+    sync_file_range( io->fd, io->dropped, io->pos - io->dropped, waitAll );
+    posix_fadvise( io->fd, io->dropped, io->pos - io->dropped, POSIX_FADV_DONTNEED );
+    io->dropped = io->synced = io->pos;
+    return;
+  }
+  if ( io->pos - io->synced < SRDSIO_WINDOW )
+    return;
+  /* start writeback of the last window - then wait for the window before and drop it */
+  sync_file_range( io->fd, io->synced, io->pos - io->synced, SYNC_FILE_RANGE_WRITE );
+  if ( io->synced > io->dropped ) {
+    sync_file_range( io->fd, io->dropped, io->synced - io->dropped, waitAll );
+    posix_fadvise( io->fd, io->dropped, io->synced - io->dropped, POSIX_FADV_DONTNEED );
+    io->dropped = io->synced;
+  }
+  io->synced = io->pos;
+}
+
+
+/* direct: helper thread filling the buffers alternately - until end of file */
+static
+void * srdsIoReader( void * arg )
+{
+  struct SrdsIo * io = (struct SrdsIo *)arg;
+  off_t off = io->bufOff[0];
+  int k = 0;
+  int last = 0;
+  while ( !last ) {
+    ssize_t r;
+    pthread_mutex_lock( &io->mtx );
+    while ( io->full[k] && !io->quit )
+      pthread_cond_wait( &io->cond, &io->mtx );
+    if ( io->quit ) {
+      pthread_mutex_unlock( &io->mtx );
+      break;
+    }
+    pthread_mutex_unlock( &io->mtx );
+
+    r = srdsIoPread( io->fd, io->buf[k], SRDSIO_BUFSIZE, off );
+
+    pthread_mutex_lock( &io->mtx );
+    if ( r < 0 ) {
+      io->err = errno;
+      r = 0;
+    }
+    last = ( r < (ssize_t)SRDSIO_BUFSIZE );
+    io->bufOff[k] = off;
+    io->len[k] = (size_t)r;
+    io->last[k] = last;
+    io->full[k] = 1;
+    pthread_cond_broadcast( &io->cond );
+    pthread_mutex_unlock( &io->mtx );
+    off += (off_t)r;
+    k ^= 1;
+  }
+  return NULL;
+}
+
+/* direct: helper thread writing the queued buffers in order */
+static
+void * srdsIoWriter( void * arg )
+{
+  struct SrdsIo * io = (struct SrdsIo *)arg;
+  int k = 0;
+  int failed = 0;
+  pthread_mutex_lock( &io->mtx );
+  for (;;) {
+    while ( !io->full[k] && !io->quit )
+      pthread_cond_wait( &io->cond, &io->mtx );
+    if ( !io->full[k] )
+      break;
+    pthread_mutex_unlock( &io->mtx );
+
+    if ( !failed && srdsIoPwrite( io->fd, io->buf[k], io->len[k], io->bufOff[k] ) )
+      failed = errno ? errno : EIO;
+
+    pthread_mutex_lock( &io->mtx );
+    if ( failed && !io->err )
+      io->err = failed;
+    io->full[k] = 0;
+    pthread_cond_broadcast( &io->cond );
+    k ^= 1;
+  }
+  pthread_mutex_unlock( &io->mtx );
+  return NULL;
+}
+
+/* direct read: copies from the buffers filled by the helper. returns bytes - 0 at end of file, -1 on error */
+static
+ssize_t srdsIoTake( struct SrdsIo * io, char * p, size_t n )
+{
+  for (;;) {
+    const int k = io->cur;
+    pthread_mutex_lock( &io->mtx );
+    while ( !io->full[k] )
+      pthread_cond_wait( &io->cond, &io->mtx );
+    pthread_mutex_unlock( &io->mtx );
+
+    if ( io->used < io->len[k] ) {
+      const size_t m = ( n < io->len[k] - io->used ) ? n : io->len[k] - io->used;
+      memcpy( p, io->buf[k] + io->used, m );
+      io->used += m;
+      return (ssize_t)m;
+    }
+    if ( io->last[k] ) {
+      if ( io->err ) {
+        errno = io->err;
+        return -1;
+      }
+      return 0;
+    }
+    /* hand the consumed buffer back for reading ahead */
+    pthread_mutex_lock( &io->mtx );
+    io->full[k] = 0;
+    pthread_cond_broadcast( &io->cond );
+    pthread_mutex_unlock( &io->mtx );
+    io->cur = k ^ 1;
+    io->used = 0;
+  }
+}
+
+/* direct write: queues the tool's full buffer and waits for the other one. returns 0 on success */
+static
+int srdsIoQueue( struct SrdsIo * io )
+{
+  const int k = io->cur;
+  int err;
+  pthread_mutex_lock( &io->mtx );
+  io->full[k] = 1;
+  pthread_cond_broadcast( &io->cond );
+  while ( io->full[k ^ 1] )
+    pthread_cond_wait( &io->cond, &io->mtx );
+  err = io->err;
+  pthread_mutex_unlock( &io->mtx );
+  io->bufOff[k ^ 1] = io->bufOff[k] + (off_t)io->len[k];
+  io->len[k ^ 1] = 0;
+  io->cur = k ^ 1;
+  if ( err )
+    errno = err;
+  return err ? -1 : 0;
+}
+
+/*
+ * direct write: waits for the helper, then writes the tool's partial buffer -
+ * its unaligned end without O_DIRECT. the buffer is kept: when full, it is written again.
+ * returns 0 on success
+ */
+static
+int srdsIoWriteTail( struct SrdsIo * io )
+{
+  const int k = io->cur;
+  const size_t n = io->len[k];
+  const size_t aligned = n & ~(size_t)( SRDSIO_ALIGN - 1 );
+  int ret;
+  pthread_mutex_lock( &io->mtx );
+  while ( io->full[k ^ 1] )
+    pthread_cond_wait( &io->cond, &io->mtx );
+  ret = io->err ? -1 : 0;
+  pthread_mutex_unlock( &io->mtx );
+
+  if ( !ret && aligned )
+    ret = srdsIoPwrite( io->fd, io->buf[k], aligned, io->bufOff[k] );
+  if ( !ret && n > aligned ) {
+    const off_t off = io->bufOff[k] + (off_t)aligned;
+    if ( fcntl( io->fd, F_SETFL, io->fdFlags ) )
+      return -1;
+    ret = srdsIoPwrite( io->fd, io->buf[k] + aligned, n - aligned, off );
+    if ( !ret ) {
+      sync_file_range( io->fd, off, (off_t)( n - aligned ),
+                       SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER );
+      posix_fadvise( io->fd, off, (off_t)( n - aligned ), POSIX_FADV_DONTNEED );
+    }
+    if ( fcntl( io->fd, F_SETFL, io->fdFlags | O_DIRECT ) )
+      ret = -1;
+  }
+  return ret;
+}
+
+/* direct: sets O_DIRECT, allocates the buffers and starts the helper thread. returns 0 on success */
+static
+int srdsIoStartDirect( struct SrdsIo * io, off_t start )
+{
+  const off_t head = start % SRDSIO_ALIGN;
+  int k;
+  io->fdFlags = fcntl( io->fd, F_GETFL );
+  if ( io->fdFlags < 0 || ( io->fdFlags & O_APPEND ) )
+    return -1;     /* pwrite() appends with O_APPEND */
+  for ( k = 0; k < 2; ++k )
+    if ( posix_memalign( (void **)&io->buf[k], SRDSIO_ALIGN, SRDSIO_BUFSIZE ) )
+      io->buf[k] = NULL;
+  if ( !io->buf[0] || !io->buf[1] )
+    goto fail;
+
+  io->bufOff[0] = start - head;
+  if ( io->forWrite ) {
+    /* the partial first block is written again with the first buffer */
+    if ( head && srdsIoPread( io->fd, io->buf[0], (size_t)head, start - head ) != (ssize_t)head )
+      goto fail;
+    io->len[0] = (size_t)head;
+  }
+  else
+    io->used = (size_t)head;
+
+  if ( fcntl( io->fd, F_SETFL, io->fdFlags | O_DIRECT ) )
+    goto fail;
+  pthread_mutex_init( &io->mtx, NULL );
+  pthread_cond_init( &io->cond, NULL );
+  if ( pthread_create( &io->thread, NULL, io->forWrite ? srdsIoWriter : srdsIoReader, io ) ) {
+    pthread_cond_destroy( &io->cond );
+    pthread_mutex_destroy( &io->mtx );
+    fcntl( io->fd, F_SETFL, io->fdFlags );
+    goto fail;
+  }
+  return 0;
+
+fail:
+  free( io->buf[0] );
+  free( io->buf[1] );
+  io->buf[0] = io->buf[1] = NULL;
+  io->len[0] = io->used = 0;
+  return -1;
+}
+
+
+static
+ssize_t srdsIoCookieRead( void * c, char * buf, size_t n )
+{
+  struct SrdsIo * io = (struct SrdsIo *)c;
+  const double t = io->s->enabled ? srdsStatNow() : 0.0;
+  ssize_t r;
+  if ( io->mode == SRDSIO_DIRECT )
+    r = srdsIoTake( io, buf, n );
+  else {
+    do
+      r = read( io->fd, buf, n );
+    while ( r < 0 && errno == EINTR );
+    if ( r > 0 ) {
+      io->pos += (off_t)r;
+      srdsIoDropBehind( io, 0 );
+    }
+    else if ( !r )
+      srdsIoDropBehind( io, 1 );  /* end of file - tools might not close their inputs */
+  }
+  if ( io->s->enabled ) {
+    srdsStatAddPhase( io->s, SRDSSTAT_READ, srdsStatNow() - t );
+    if ( r > 0 )
+      __atomic_add_fetch( &io->s->bytesIn, (uint64_t)r, __ATOMIC_RELAXED );
+  }
+  return r;
+}
+
+static
+ssize_t srdsIoCookieWrite( void * c, const char * buf, size_t n )
+{
+  struct SrdsIo * io = (struct SrdsIo *)c;
+  const double t = io->s->enabled ? srdsStatNow() : 0.0;
+  size_t done = 0;
+  if ( io->mode == SRDSIO_DIRECT ) {
+    while ( done < n ) {
+      const int k = io->cur;
+      const size_t m = ( n - done < SRDSIO_BUFSIZE - io->len[k] ) ? n - done : SRDSIO_BUFSIZE - io->len[k];
+      memcpy( io->buf[k] + io->len[k], buf + done, m );
+      io->len[k] += m;
+      if ( io->len[k] == SRDSIO_BUFSIZE && srdsIoQueue( io ) )
+        break;   /* buffer is written - but failed before */
+      done += m;
+    }
+  }
+  else {
+    while ( done < n ) {
+      const ssize_t w = write( io->fd, buf + done, n - done );
+      if ( w < 0 && errno == EINTR )
+        continue;
+      if ( w <= 0 )
+        break;
+      done += (size_t)w;
+    }
+    io->pos += (off_t)done;
+    srdsIoDropBehind( io, 0 );
+  }
+  if ( io->s->enabled ) {
+    srdsStatAddPhase( io->s, SRDSSTAT_WRITE, srdsStatNow() - t );
+    __atomic_add_fetch( &io->s->bytesOut, (uint64_t)done, __ATOMIC_RELAXED );
+  }
+  return ( done || !n ) ? (ssize_t)done : -1;
+}
+
+static
+int srdsIoCookieClose( void * c )
+{
+  struct SrdsIo * io = (struct SrdsIo *)c;
+  const double t = io->s->enabled ? srdsStatNow() : 0.0;
+  int ret = 0;
+  int k;
+  if ( io->mode == SRDSIO_DIRECT ) {
+    if ( io->forWrite && srdsIoWriteTail( io ) )
+      ret = -1;
+    pthread_mutex_lock( &io->mtx );
+    io->quit = 1;
+    pthread_cond_broadcast( &io->cond );
+    pthread_mutex_unlock( &io->mtx );
+    pthread_join( io->thread, NULL );
+    if ( io->forWrite && io->err )
+      ret = -1;
+    fcntl( io->fd, F_SETFL, io->fdFlags );
+    pthread_cond_destroy( &io->cond );
+    pthread_mutex_destroy( &io->mtx );
+    free( io->buf[0] );
+    free( io->buf[1] );
+  }
+  else
+    srdsIoDropBehind( io, 1 );
+  if ( io->forWrite && io->s->enabled )
+    srdsStatAddPhase( io->s, SRDSSTAT_WRITE, srdsStatNow() - t );
+
+  for ( k = 0; k < SRDSIO_MAXOPEN; ++k )
+    if ( srdsIoWriters[k] == io )
+      srdsIoWriters[k] = NULL;
+  if ( io->fp != stdin && io->fp != stdout && fclose( io->fp ) )
+    ret = -1;
+  free( io );
+  return ret;
+}
+
+/*
+ * returns a stream, which reads or writes fp in the given mode - with the telemetry s.
+ * call before any I/O on fp - and before setbuffer(). closing the returned
+ * stream closes fp - except stdin and stdout.
+ */
+static
+FILE * srdsIoWrap( struct SrdsStat * s, FILE * fp, int forWrite, int mode )
+{
+  cookie_io_functions_t cf;
+  struct SrdsIo * io;
+  struct stat st;
+  off_t start;
+  int k;
+
+  if ( mode == SRDSIO_CACHE || !fp || fstat( fileno( fp ), &st ) || !S_ISREG(st.st_mode)
+       || ( start = ftello( fp ) ) < 0 )
+    return srdsStatWrap( s, fp, forWrite );
+  io = (struct SrdsIo *)calloc( 1, sizeof(*io) );
+  if ( !io )
+    return srdsStatWrap( s, fp, forWrite );
+  io->s = s;
+  io->fp = fp;
+  io->fd = fileno( fp );
+  io->mode = mode;
+  io->forWrite = forWrite;
+  io->pos = io->synced = io->dropped = start;
+
+  if ( mode == SRDSIO_DIRECT && srdsIoStartDirect( io, start ) ) {
+    fprintf(stderr, "warning: no O_DIRECT for file descriptor %d - dropping pages behind instead\n", io->fd);
+    io->mode = SRDSIO_DONTNEED;
+  }
+  if ( io->mode == SRDSIO_DONTNEED && !forWrite )
+    posix_fadvise( io->fd, start, 0, POSIX_FADV_SEQUENTIAL );
+
+  memset( &cf, 0, sizeof(cf) );
+  if ( forWrite )
+    cf.write = srdsIoCookieWrite;
+  else
+    cf.read = srdsIoCookieRead;
+  cf.close = srdsIoCookieClose;
+  io->w = fopencookie( io, forWrite ? "w" : "r", cf );
+  if ( !io->w ) {
+    io->fp = stdin;   /* keep fp open */
+    srdsIoCookieClose( io );
+    return srdsStatWrap( s, fp, forWrite );
+  }
+  if ( forWrite )
+    for ( k = 0; k < SRDSIO_MAXOPEN; ++k )
+      if ( !srdsIoWriters[k] ) {
+        srdsIoWriters[k] = io;
+        break;
+      }
+  return io->w;
+}
+
+/* flushes stream fp - also the buffer of a direct stream - with fdatasync() of its file descriptor fd. returns 0 on success */
+static
+int srdsIoSync( FILE * fp, int fd )
+{
+  int k;
+  if ( fflush( fp ) )
+    return -1;
+  for ( k = 0; k < SRDSIO_MAXOPEN; ++k )
+    if ( srdsIoWriters[k] && srdsIoWriters[k]->w == fp && srdsIoWriters[k]->mode == SRDSIO_DIRECT
+         && srdsIoWriteTail( srdsIoWriters[k] ) )
+      return -1;
+  return fdatasync( fd );
+}
+
+#else
+
+static
+FILE * srdsIoWrap( struct SrdsStat * s, FILE * fp, int forWrite, int mode )
+{
+  (void)mode;
+  return srdsStatWrap( s, fp, forWrite );
+}
+
+static
+int srdsIoSync( FILE * fp, int fd )
+{
+  if ( fflush( fp ) )
+    return -1;
+  return fdatasync( fd );
+}
+
+#endif
+
+#endif /* SRDSIO_H */
@@ -7,23 +7,46 @@
  * srdsmerge (sorted raw data set merge) is an alternative to traditional Unix
  * sort with option "-m", for sorted raw data set files.
  * Limitations / requirements:
- * 1) All input files must be sorted regular files.
+ * 1) All input files must be sorted. regular files, pipes (FIFOs),
+ *    process substitutions or stdin ('-', at most once) are accepted.
  * 2) every 'line' is a raw data set (block) - all with same fixed length
  *
+ * inputs and output might be hash encoded (see srdshashencode):
+ * each input is decoded on the fly - with its own running state,
+ * the merged records are encoded in the same pass.
+ * gap coded inputs are detected from their magic, delta coded ones
+ * carry no header: these require option '-d'.
+ *
+ * with '-C', a checkpoint (see srdsckpt.h) is written periodically:
+ * '--resume' continues an interrupted merge from there.
+ *
  * Usage: see below at usage()
  *
  * Author:  Hayati Ayguen
  */
 
+/* fopencookie() for the telemetry */
+#define _GNU_SOURCE
 
 #include <stddef.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
 #include <stdio.h>
+#include <getopt.h>
+
+#include "gapcodec.h"
+#include "srdsstat.h"
+#include "srdsckpt.h"
+#include "srdsio.h"
 
 #define MAXINFILES  16
 
+/* coding of inputs / output */
+#define CODING_RAW    0
+#define CODING_DELTA  1   /* srdshashencode -c */
+#define CODING_GAP    2   /* srdshashencode -g */
+
 static int blockSize = -1;
 static int keyBeg = 0;
 static int keyEnd = -1;
@@ -34,10 +57,29 @@ static FILE * input[MAXINFILES];
 static void * rdBuffers[MAXINFILES];
 static size_t readBlockBuf[MAXINFILES];
 static unsigned char * blockBuf[MAXINFILES];
+static struct SrdsStat telemetry;
+
+/* per input decoding state: blockBuf[] holds the previous decoded record */
+static int inCoding[MAXINFILES];
+static unsigned char * codedBuf[MAXINFILES];
+static struct GapDecoder gapDec[MAXINFILES];
+/* bytes read for the format detection - consumed before the FILE */
+static unsigned char pending[MAXINFILES][GAP_HEADER_SIZE];
+static size_t pendingLen[MAXINFILES];
+
+static const char * codingName[] = { "raw", "delta coded", "gap coded" };
+
+/* checkpoints - see srdsckpt.h */
+static char * ckptFn = NULL;
+static double ckptInterval = 0.0;
+static double nextCkpt = 0.0;
+static int outFd = -1;
+static uint64_t inOffset[MAXINFILES];     /* bytes of undecoded records consumed from input */
+static unsigned long long baseRecords = 0;   /* written before '--resume' */
 
 static
 void usage() {
-  fputs("Usage: srdsmerge [-v][-h][-r][-l <blockLength>][-b <keyBegin>][-e <keyEnd>][-o <output>] (<sorted_file>)+\n", stderr);
+  fputs("Usage: srdsmerge [-v][-h][-r][-l <blockLength>][-b <keyBegin>][-e <keyEnd>][-d][-c|-g][-o <output>][-C <sec>][--resume][-D <mode>][-P <sec>][-J <json>] (<sorted_file>)+\n", stderr);
   fputs("  sorted raw data set merge\n", stderr);
   fputs("  -v     verbose output\n", stderr);
   fputs("  -h     print usage\n",stderr);
@@ -46,14 +88,170 @@ void usage() {
   fputs("  -l <v> length of each raw data set block in bytes\n", stderr);
   fputs("  -b <v> key's begin offset inside block\n", stderr);
   fputs("  -e <v> key's end offset inside block\n", stderr);
+  fputs("  -d     inputs are delta coded (srdshashencode -c). gap coded inputs are detected automatically\n", stderr);
+  fputs("  -c     delta code output - as srdshashencode -c\n", stderr);
+  fputs("  -g     gap code output - as srdshashencode -g\n", stderr);
   fputs("  -o <f> output to file. default is stdout\n", stderr);
-  fputs("  sorted_file  minimum 2 filenames required\n", stderr);
+  fputs("  -C <v> write checkpoint '<output>.ckpt' every v seconds. requires '-o', input files and no gap coding\n", stderr);
+  fputs("  --resume  continue an interrupted merge - with the same options - from its last checkpoint\n", stderr);
+  fputs("  -D <m> I/O mode of regular files: 'cache' (default), 'dontneed' drops the pages behind\n", stderr);
+  fputs("         or 'direct' for O_DIRECT - leaving the page cache to the lookups\n", stderr);
+  fputs("  -P <v> print progress to stderr every v seconds\n", stderr);
+  fputs("  -J <f> write summary with timing of read/process/write phases as JSON to file. '-' for stderr\n", stderr);
+  fputs("  sorted_file  minimum 2 filenames required. '-' reads stdin\n", stderr);
+}
+
+
+/* reads one undecoded record - the detection bytes first. returns 1 on success, 0 at end */
+static
+size_t readRaw( int fno, unsigned char * dst )
+{
+  size_t k = pendingLen[fno];
+  if ( !k )
+    return fread( dst, blockSize, 1, input[fno] );
+  if ( k > (size_t)blockSize )
+    k = (size_t)blockSize;
+  memcpy( dst, pending[fno], k );
+  pendingLen[fno] -= k;
+  memmove( pending[fno], pending[fno] + k, pendingLen[fno] );
+  if ( k == (size_t)blockSize )
+    return 1;
+  return fread( dst + k, 1, blockSize - k, input[fno] ) == blockSize - k;
+}
+
+/* as readRaw() - counting the input offset for the checkpoints */
+static
+size_t readRawCounted( int fno, unsigned char * dst )
+{
+  const size_t r = readRaw( fno, dst );
+  inOffset[fno] += r * blockSize;
+  return r;
+}
+
+/* reads and decodes next record of input fno into blockBuf[fno]. returns 1 on success, 0 at end */
+static
+size_t readBlock( int fno )
+{
+  unsigned char * b = blockBuf[fno];
+  const unsigned char * c = codedBuf[fno];
+  long n;
+  int u;
+
+  switch ( inCoding[fno] ) {
+  case CODING_GAP:
+    n = gapDecoderGet( &gapDec[fno], b, 1 );
+    if ( n < 0 ) {
+      fprintf(stderr, "srdsmerge: error reading gap coded input %d!\n", fno +1);
+      exit(9);
+    }
+    return (size_t)n;
+  case CODING_DELTA:
+    if ( !readRawCounted( fno, codedBuf[fno] ) )
+      return 0;
+    for ( u = 0; u < blockSize; ++u )
+      b[u] = (unsigned char)( b[u] + c[u] );
+    return 1;
+  default:
+    return readRawCounted( fno, b );
+  }
+}
+
+/* reads the first bytes of input fno to detect its coding */
+static
+void detectCoding( int fno, int deltaFlag )
+{
+  FILE * fp = input[fno];
+  size_t n = 0;
+
+  while ( n < GAP_HEADER_SIZE && !feof(fp) && !ferror(fp) )
+    n += fread( pending[fno] + n, 1, GAP_HEADER_SIZE - n, fp );
+  pendingLen[fno] = n;
+  inCoding[fno] = deltaFlag ? CODING_DELTA : CODING_RAW;
+  if ( n == GAP_HEADER_SIZE && gapIsStream( pending[fno], n ) ) {
+    if ( gapDecoderInit( &gapDec[fno], fp, blockSize, pending[fno] ) < 0 ) {
+      fprintf(stderr, "srdsmerge: input %d is no gap coded stream with blockSize %d!\n", fno +1, blockSize);
+      exit(10);
+    }
+    inCoding[fno] = CODING_GAP;
+    pendingLen[fno] = 0;
+  }
+  if ( verboseFlag )
+    fprintf(stderr, "input %d is %s\n", fno +1, codingName[ inCoding[fno] ]);
+}
+
+/*
+ * syncs the output, then writes the position of all files into the checkpoint:
+ * the current record of each input is not merged yet - its offset is in front of it.
+ * last is the last written record, tail its (coded) bytes in the output. returns 0 on success
+ */
+static
+int writeCheckpoint( FILE * out, int numInputs, int outCoding, unsigned long long numRecords,
+                     const unsigned char * last, const unsigned char * tail )
+{
+  unsigned char * state = (unsigned char *)malloc( blockSize );
+  char key[32];
+  FILE * f;
+  int fno, u;
+
+  if ( !state || srdsIoSync( out, outFd ) || !( f = srdsCkptBegin( ckptFn, "srdsmerge", blockSize ) ) ) {
+    free( state );
+    return -1;
+  }
+  fprintf(f, "records=%llu\n", numRecords);
+  fprintf(f, "output=%llu\n", numRecords * blockSize);
+  fprintf(f, "inputs=%d\n", numInputs);
+  fprintf(f, "coding=%s\n", codingName[ outCoding ]);
+  if ( numRecords ) {
+    srdsCkptPutHex( f, "tail", tail, blockSize );
+    srdsCkptPutHex( f, "last", last, blockSize );
+  }
+  for ( fno = 0; fno < numInputs; ++fno ) {
+    snprintf( key, sizeof(key), "input%d", fno );
+    fprintf(f, "%s=%llu\n", key, (unsigned long long)( inOffset[fno] - ( readBlockBuf[fno] ? blockSize : 0 ) ));
+    snprintf( key, sizeof(key), "coding%d", fno );
+    fprintf(f, "%s=%s\n", key, codingName[ inCoding[fno] ]);
+    if ( inCoding[fno] == CODING_DELTA ) {
+      /* decoding state in front of the current record */
+      for ( u = 0; u < blockSize; ++u )
+        state[u] = (unsigned char)( blockBuf[fno][u] - ( readBlockBuf[fno] ? codedBuf[fno][u] : 0 ) );
+      snprintf( key, sizeof(key), "state%d", fno );
+      srdsCkptPutHex( f, key, state, blockSize );
+    }
+  }
+  free( state );
+  return srdsCkptCommit( f, ckptFn );
+}
+
+/* positions input fno at the checkpoint. returns 0 on success */
+static
+int resumeInput( const struct SrdsCkpt * ckpt, int fno, int deltaFlag )
+{
+  char key[32];
+  const char * c;
+  inCoding[fno] = deltaFlag ? CODING_DELTA : CODING_RAW;
+  snprintf( key, sizeof(key), "coding%d", fno );
+  c = srdsCkptGet( ckpt, key );
+  if ( !c || strcmp( c, codingName[ inCoding[fno] ] ) ) {
+    fprintf(stderr, "srdsmerge: input %d is not %s in checkpoint!\n", fno +1, codingName[ inCoding[fno] ]);
+    return -1;
+  }
+  if ( srdsCkptResumeInput( ckpt, fno, input[fno], &inOffset[fno] ) )
+    return -1;
+  snprintf( key, sizeof(key), "state%d", fno );
+  if ( inCoding[fno] == CODING_DELTA && srdsCkptGetHex( ckpt, key, blockBuf[fno], blockSize ) ) {
+    fprintf(stderr, "srdsmerge: checkpoint has no decoding state for input %d!\n", fno +1);
+    return -1;
+  }
+  return 0;
 }
 
 
 int main(int argc, char *argv[]) {
   FILE * out = stdout;
   const char * outfn = NULL;
+  const char * jsonFn = NULL;
+  double progressInterval = 0.0;
+  unsigned long long numRecords = 0;
   int optFlag, numInputs = 0;
   int numAvailable = 0;
   int firstAvailable = -1;
@@ -62,13 +260,27 @@ int main(int argc, char *argv[]) {
   int helpFlag = 0;
   int revFlag = 0;
   int changedKeyOrBlock = 0;
+  int stdinUsed = 0;
+  int deltaFlag = 0;
+  int outCoding = CODING_RAW;
+  int resumeFlag = 0;
+  int ioMode = SRDSIO_CACHE;
   size_t vBufSize = 0;
   size_t bufferSize = 0;
   void * wrBuffer = NULL;
+  unsigned char * prevOut = NULL;
+  unsigned char * codedOut = NULL;
+  unsigned char * lastOut = NULL;
+  struct GapEncoder gapEnc;
+  struct SrdsCkpt ckpt;
+  static const struct option longOpts[] = {
+    { "resume", no_argument, NULL, 'R' },
+    { NULL, 0, NULL, 0 }
+  };
   extern int optind;
 
   /* parse command line options */
-  while ((optFlag = getopt(argc, argv, "vhB:rl:b:e:o:")) > 0 && optFlag != '?') {
+  while ((optFlag = getopt_long(argc, argv, "vhB:rl:b:e:dcgo:C:D:P:J:", longOpts, NULL)) > 0 && optFlag != '?') {
     switch(optFlag) {
     case 'v': ++verboseFlag; break;
     case 'h': ++helpFlag; break;
@@ -89,9 +301,23 @@ int main(int argc, char *argv[]) {
       if ( verboseFlag >= 2 )
         fprintf(stderr, "parsed key End %d\n", keyEnd);
       break;
+    case 'd': ++deltaFlag; break;
+    case 'c': outCoding = CODING_DELTA; break;
+    case 'g': outCoding = CODING_GAP; break;
     case 'o':
       outfn = optarg;
       break;
+    case 'C': ckptInterval = atof(optarg); break;
+    case 'R': ++resumeFlag; break;
+    case 'D':
+      ioMode = srdsIoParseMode(optarg);
+      if ( ioMode < 0 ) {
+        fprintf(stderr, "srdsmerge: unknown I/O mode '%s'!\n", optarg);
+        exit(10);
+      }
+      break;
+    case 'P': progressInterval = atof(optarg); break;
+    case 'J': jsonFn = optarg; break;
     }
   }
   if (optFlag == '?' || helpFlag) {
@@ -138,22 +364,81 @@ int main(int argc, char *argv[]) {
     fprintf(stderr, "error: keyEnd %d is <= 0 !\n", keyEnd);
     return 10;
   }
+  if ( outCoding == CODING_GAP && blockSize > GAP_MAX_BLOCKSIZE ) {
+    fprintf(stderr, "error: gap coding requires blockSize <= %d !\n", GAP_MAX_BLOCKSIZE);
+    return 10;
+  }
+
+  memset( &ckpt, 0, sizeof(ckpt) );
+  if ( ckptInterval > 0.0 || resumeFlag ) {
+    if ( !outfn || outCoding == CODING_GAP ) {
+      fputs("srdsmerge: checkpoints require an output file ('-o') - without gap coding!\n", stderr);
+      return 10;
+    }
+    ckptFn = srdsCkptName( outfn );
+    nextCkpt = srdsStatNow() + ckptInterval;
+    lastOut = (unsigned char *)malloc( blockSize );
+  }
+  if ( resumeFlag ) {
+    uint64_t v;
+    if ( !ckptFn || srdsCkptLoad( &ckpt, ckptFn ) || srdsCkptGetU64( &ckpt, "records", &v ) ) {
+      fprintf(stderr, "srdsmerge: no checkpoint '%s' to resume from!\n", ckptFn ? ckptFn : outfn);
+      return 10;
+    }
+    baseRecords = v;
+  }
 
   bufferSize = vBufSize ? vBufSize : 65536;
+  srdsStatInit( &telemetry, "srdsmerge", progressInterval, progressInterval > 0.0 || jsonFn );
 
   /* search each input file */
   for ( ; optFlag < argc; optFlag++) {
-    FILE * fp = fopen(argv[optFlag], "rb");
+    FILE * fp;
+    if ( numInputs >= MAXINFILES ) {
+      fprintf(stderr, "srdsmerge: maximum %d input files supported!\n", MAXINFILES);
+      exit(2);
+    }
+    if ( !strcmp(argv[optFlag], "-") ) {
+      if ( stdinUsed++ ) {
+        fputs("srdsmerge: STDIN ('-') can be used only once!\n", stderr);
+        exit(2);
+      }
+      fp = stdin;
+    }
+    else
+      fp = fopen(argv[optFlag], "rb");
     if (!fp) {
         fprintf(stderr, "srdsmerge:  could not open %s\n", argv[optFlag]);
         exit(2);
     }
+    if ( ckptFn ) {
+      struct stat st;
+      if ( fp == stdin || fstat( fileno(fp), &st ) || !S_ISREG(st.st_mode) ) {
+        fprintf(stderr, "srdsmerge: checkpoints require regular input files - not %s\n", argv[optFlag]);
+        exit(2);
+      }
+    }
+    input[numInputs] = fp;
+    if ( resumeFlag )
+      blockBuf[numInputs] = (unsigned char *)calloc( blockSize, sizeof(unsigned char) );
+    if ( resumeFlag && resumeInput( &ckpt, numInputs, deltaFlag ) )
+      exit(10);
 
+    srdsStatInputSize( &telemetry, fp );
+    fp = srdsIoWrap( &telemetry, fp, 0, ioMode );
     input[numInputs] = fp;
     rdBuffers[numInputs] = malloc( bufferSize );
     if (rdBuffers[numInputs]) setbuffer( fp, rdBuffers[numInputs], bufferSize );
-    blockBuf[numInputs] = (unsigned char *)malloc( blockSize * sizeof(unsigned char) );
-    readBlockBuf[numInputs] = fread( blockBuf[numInputs], blockSize, 1, input[numInputs] );
+    if ( !resumeFlag ) {
+      blockBuf[numInputs] = (unsigned char *)calloc( blockSize, sizeof(unsigned char) );
+      detectCoding( numInputs, deltaFlag );
+      if ( ckptFn && inCoding[numInputs] == CODING_GAP ) {
+        fprintf(stderr, "srdsmerge: gap coded input %d can not be checkpointed!\n", numInputs +1);
+        exit(10);
+      }
+    }
+    codedBuf[numInputs] = (unsigned char *)malloc( blockSize * sizeof(unsigned char) );
+    readBlockBuf[numInputs] = readBlock( numInputs );
     isAvailable = (int)( readBlockBuf[numInputs] );
     numAvailable += isAvailable;
     if ( isAvailable ) {
@@ -166,7 +451,7 @@ int main(int argc, char *argv[]) {
 
   /* if no input files? */
   if (numInputs == 0) {
-    fputs("srdsmerge: STDIN is not accepted. input filenames required at command line!\n", stderr);
+    fputs("srdsmerge: input filenames required at command line! use '-' for STDIN\n", stderr);
     exit(10);
   }
   else if ( numInputs < 2 )
@@ -175,7 +460,24 @@ int main(int argc, char *argv[]) {
     exit(9);
   }
 
-  if ( numInputs && numAvailable && outfn )
+  if ( resumeFlag ) {
+    const char * c = srdsCkptGet( &ckpt, "coding" );
+    uint64_t v;
+    out = fopen(outfn, "r+b");
+    if (!out) {
+      fputs("error opening output file!\n", stderr);
+      exit(8);
+    }
+    if ( srdsCkptResumeOutput( &ckpt, "srdsmerge", blockSize, out ) < 0
+         || srdsCkptGetU64( &ckpt, "inputs", &v ) || v != (uint64_t)numInputs
+         || !c || strcmp( c, codingName[ outCoding ] ) ) {
+      fprintf(stderr, "srdsmerge: can not resume from checkpoint '%s' - with these options!\n", ckptFn);
+      exit(10);
+    }
+    if ( verboseFlag )
+      fprintf(stderr, "resuming after %llu records\n", baseRecords);
+  }
+  else if ( numInputs && numAvailable && outfn )
   {
     out = fopen(outfn, "wb");
     if (!out) {
@@ -183,10 +485,27 @@ int main(int argc, char *argv[]) {
       exit(8);
     }
   }
+  outFd = fileno(out);
 
+  out = srdsIoWrap( &telemetry, out, 1, ioMode );
   wrBuffer = malloc( bufferSize );
   if (wrBuffer) setbuffer( out, wrBuffer, bufferSize );
 
+  if ( outCoding == CODING_DELTA ) {
+    prevOut = (unsigned char *)calloc( blockSize, sizeof(unsigned char) );
+    codedOut = (unsigned char *)malloc( blockSize * sizeof(unsigned char) );
+    if ( baseRecords && srdsCkptGetHex( &ckpt, "last", prevOut, blockSize ) ) {
+      fprintf(stderr, "srdsmerge: checkpoint '%s' has no last record!\n", ckptFn);
+      exit(10);
+    }
+  }
+  else if ( outCoding == CODING_GAP && gapEncoderInit( &gapEnc, out, blockSize ) ) {
+    fputs("error writing gap coding header to output file!\n", stderr);
+    exit(7);
+  }
+  if ( verboseFlag && outCoding != CODING_RAW )
+    fprintf(stderr, "output is %s\n", codingName[ outCoding ]);
+
   while ( numAvailable )
   {
     size_t w;
@@ -214,14 +533,29 @@ int main(int argc, char *argv[]) {
     }
 
     // output best block
-    w = fwrite( blockBuf[fbest], blockSize, 1, out );
+    if ( outCoding == CODING_DELTA ) {
+      const unsigned char * b = blockBuf[fbest];
+      int u;
+      for ( u = 0; u < blockSize; ++u )
+        codedOut[u] = (unsigned char)( b[u] - prevOut[u] );
+      memcpy( prevOut, b, blockSize );
+      w = fwrite( codedOut, blockSize, 1, out );
+    }
+    else if ( outCoding == CODING_GAP )
+      w = !gapEncoderPut( &gapEnc, blockBuf[fbest], 1 );
+    else
+      w = fwrite( blockBuf[fbest], blockSize, 1, out );
     if (!w) {
       fputs("error writing to output file!\n", stderr);
       exit(7);
     }
+    if ( !( ++numRecords & 0xFFFF ) )
+      srdsStatRecords( &telemetry, 65536 );
+    if ( lastOut )
+      memcpy( lastOut, blockBuf[fbest], blockSize );
 
     // load next block of best file
-    readBlockBuf[fbest] = fread( blockBuf[fbest], blockSize, 1, input[fbest] );
+    readBlockBuf[fbest] = readBlock( fbest );
     if ( !readBlockBuf[fbest] )
     {
       // update number of available blocks over all files
@@ -239,12 +573,43 @@ int main(int argc, char *argv[]) {
       }
     }
 
+    if ( ckptInterval > 0.0 && !( numRecords & 0xFFFF ) && srdsStatNow() >= nextCkpt ) {
+      if ( writeCheckpoint( out, numInputs, outCoding, baseRecords + numRecords, lastOut,
+                            outCoding == CODING_DELTA ? codedOut : lastOut ) ) {
+        fprintf(stderr, "error writing checkpoint '%s'!\n", ckptFn);
+        exit(8);
+      }
+      nextCkpt = srdsStatNow() + ckptInterval;
+    }
+  }
+
+  srdsStatRecords( &telemetry, numRecords & 0xFFFF );
+
+  if ( outCoding == CODING_GAP && gapEncoderFinish( &gapEnc ) ) {
+    fputs("error writing to output file!\n", stderr);
+    exit(7);
   }
+  free( prevOut );
+  free( codedOut );
+  free( lastOut );
 
   if ( out != stdout ) {
-    fclose(out);
+    if ( fclose(out) ) {
+      fputs("error writing to output file!\n", stderr);
+      exit(7);
+    }
     free( wrBuffer );
   }
 
+  /* the checkpoint is kept for '--resume' - only a complete merge removes it */
+  if ( ckptFn )
+    remove( ckptFn );
+  free( ckptFn );
+  srdsCkptFree( &ckpt );
+
+  if ( srdsStatSummary( &telemetry, jsonFn, 0 ) ) {
+    fprintf(stderr, "error writing summary to '%s'\n", jsonFn);
+    return 8;
+  }
   return 0;
 }
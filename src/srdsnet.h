@@ -0,0 +1,253 @@
+/*
+ * srdsnet.h
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * line based lookup protocol of srdsserve and srdsrouter:
+ * the client sends hexadecimal keys - one per line. the server replies
+ * one line 'KEY:COUNT' per key - in request order, 'KEY:ERR' on error.
+ * a client may send any number of keys without waiting (pipelining):
+ * all complete lines of one read() are processed as a batch.
+ *
+ * addresses are 'host:port', ':port' or 'port' for TCP -
+ * or a path (containing '/') for a unix domain socket.
+ *
+ * Author:  Hayati Ayguen
+ */
+
+#ifndef SRDSNET_H
+#define SRDSNET_H
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SRDSNET_MAXLINE  4096
+
+/* growable buffer for lines: read from a socket - or composed for writing */
+struct SrdsLineBuf {
+  char * buf;
+  size_t cap;
+  size_t beg;     /* start of unprocessed data */
+  size_t end;     /* end of data */
+};
+
+static
+int srdsNetIsUnix( const char * addr )
+{
+  return strchr( addr, '/' ) != NULL;
+}
+
+/* resolve address. returns 0 on success */
+static
+int srdsNetAddr( const char * addr, struct sockaddr_storage * sa, socklen_t * saLen )
+{
+  memset( sa, 0, sizeof(*sa) );
+  if ( srdsNetIsUnix( addr ) ) {
+    struct sockaddr_un * un = (struct sockaddr_un *)sa;
+    if ( strlen( addr ) >= sizeof(un->sun_path) )
+      return -1;
+    un->sun_family = AF_UNIX;
+    strcpy( un->sun_path, addr );
+    *saLen = sizeof(*un);
+  }
+  else {
+    char host[256];
+    const char * colon = strrchr( addr, ':' );
+    const char * port = colon ? colon + 1 : addr;
+    struct addrinfo hints, * res = NULL;
+    size_t hostLen = colon ? (size_t)( colon - addr ) : 0;
+    if ( hostLen >= sizeof(host) )
+      return -1;
+    memcpy( host, addr, hostLen );
+    host[hostLen] = 0;
+    memset( &hints, 0, sizeof(hints) );
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    if ( getaddrinfo( hostLen ? host : NULL, port, &hints, &res ) || !res )
+      return -1;
+    memcpy( sa, res->ai_addr, res->ai_addrlen );
+    *saLen = res->ai_addrlen;
+    freeaddrinfo( res );
+  }
+  return 0;
+}
+
+/* returns listening socket - or -1 */
+static
+int srdsNetListen( const char * addr )
+{
+  struct sockaddr_storage sa;
+  socklen_t saLen;
+  int fd, one = 1;
+  if ( srdsNetAddr( addr, &sa, &saLen ) )
+    return -1;
+  fd = socket( sa.ss_family, SOCK_STREAM, 0 );
+  if ( fd < 0 )
+    return -1;
+  if ( sa.ss_family == AF_UNIX )
+    unlink( addr );
+  else
+    setsockopt( fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one) );
+  if ( bind( fd, (struct sockaddr *)&sa, saLen ) || listen( fd, 64 ) ) {
+    close( fd );
+    return -1;
+  }
+  return fd;
+}
+
+/*
+ * returns connected socket - or -1.
+ * with nonBlock, connection might still be in progress: wait for POLLOUT and check SO_ERROR
+ */
+static
+int srdsNetConnect( const char * addr, int nonBlock )
+{
+  struct sockaddr_storage sa;
+  socklen_t saLen;
+  int fd, one = 1;
+  if ( srdsNetAddr( addr, &sa, &saLen ) )
+    return -1;
+  fd = socket( sa.ss_family, SOCK_STREAM, 0 );
+  if ( fd < 0 )
+    return -1;
+  if ( nonBlock )
+    fcntl( fd, F_SETFL, fcntl( fd, F_GETFL ) | O_NONBLOCK );
+  if ( connect( fd, (struct sockaddr *)&sa, saLen ) && !( nonBlock && errno == EINPROGRESS ) ) {
+    close( fd );
+    return -1;
+  }
+  if ( sa.ss_family != AF_UNIX )
+    setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one) );
+  return fd;
+}
+
+/* returns 0 on success */
+static
+int srdsNetWriteAll( int fd, const char * p, size_t n )
+{
+  while ( n ) {
+    ssize_t w = write( fd, p, n );
+    if ( w < 0 && errno == EINTR )
+      continue;
+    if ( w <= 0 )
+      return -1;
+    p += w;
+    n -= (size_t)w;
+  }
+  return 0;
+}
+
+/* make room for n more bytes. returns 0 on success */
+static
+int srdsLineBufReserve( struct SrdsLineBuf * lb, size_t n )
+{
+  if ( lb->end + n <= lb->cap )
+    return 0;
+  if ( lb->beg ) {
+    memmove( lb->buf, lb->buf + lb->beg, lb->end - lb->beg );
+    lb->end -= lb->beg;
+    lb->beg = 0;
+  }
+  if ( lb->end + n > lb->cap ) {
+    size_t cap = lb->cap ? lb->cap : 65536;
+    char * p;
+    while ( cap < lb->end + n )
+      cap *= 2;
+    p = (char *)realloc( lb->buf, cap );
+    if ( !p )
+      return -1;
+    lb->buf = p;
+    lb->cap = cap;
+  }
+  return 0;
+}
+
+static
+int srdsLineBufAppend( struct SrdsLineBuf * lb, const char * p, size_t n )
+{
+  if ( srdsLineBufReserve( lb, n ) )
+    return -1;
+  memcpy( lb->buf + lb->end, p, n );
+  lb->end += n;
+  return 0;
+}
+
+/* read available data from fd. returns number of bytes, 0 at end of stream - or -1 */
+static
+ssize_t srdsLineBufFill( struct SrdsLineBuf * lb, int fd )
+{
+  ssize_t r;
+  if ( srdsLineBufReserve( lb, SRDSNET_MAXLINE ) )
+    return -1;
+  do
+    r = read( fd, lb->buf + lb->end, lb->cap - lb->end );
+  while ( r < 0 && errno == EINTR );
+  if ( r > 0 )
+    lb->end += (size_t)r;
+  return r;
+}
+
+/*
+ * next complete line - without line end - or NULL.
+ * the line stays valid until the next fill or append
+ */
+static
+char * srdsLineBufNext( struct SrdsLineBuf * lb )
+{
+  char * line = lb->buf + lb->beg;
+  char * nl = (char *)memchr( line, '\n', lb->end - lb->beg );
+  if ( !nl )
+    return NULL;
+  lb->beg = (size_t)( nl + 1 - lb->buf );
+  *nl = 0;
+  if ( nl > line && nl[-1] == '\r' )
+    nl[-1] = 0;
+  return line;
+}
+
+static
+void srdsLineBufFree( struct SrdsLineBuf * lb )
+{
+  free( lb->buf );
+  memset( lb, 0, sizeof(*lb) );
+}
+
+/* convert hexadecimal key. returns number of bytes - or -1 */
+static
+int srdsNetParseKey( const char * s, unsigned char * bin, int maxLen )
+{
+  int n = 0;
+  for ( ; s[0] && s[1]; s += 2 ) {
+    int k, v = 0;
+    for ( k = 0; k < 2; ++k ) {
+      const char c = s[k];
+      v <<= 4;
+      if ( c >= '0' && c <= '9' )
+        v |= c - '0';
+      else if ( c >= 'A' && c <= 'F' )
+        v |= 10 + c - 'A';
+      else if ( c >= 'a' && c <= 'f' )
+        v |= 10 + c - 'a';
+      else
+        return -1;
+    }
+    if ( n >= maxLen )
+      return -1;
+    bin[n++] = (unsigned char)v;
+  }
+  return ( s[0] || !n ) ? -1 : n;
+}
+
+#endif /* SRDSNET_H */
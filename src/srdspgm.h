@@ -0,0 +1,296 @@
+/*
+ * srdspgm.h
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * learned index of a sorted raw data set (srds) - from srds2pgm:
+ * a piecewise linear model of position over the leading 64 bits of each
+ * record (big endian) - in the style of the PGM-index, see
+ * https://pgm.di.unipi.it/
+ * every distinct 64 bit key x with the position r of its first record is
+ * a point. each segment predicts  r0 + slope * ( x - x0 ),  clamped to the
+ * segment's positions, with an error of at most epsilon records.
+ * the segments are fitted streaming - in one pass with O(1) per record:
+ * the range of feasible slopes shrinks with each point (a 'shrinking cone'),
+ * a new segment starts when it becomes empty.
+ *
+ * a lookup predicts the position and searches only a window of
+ * 2 * epsilon + maxRun records, e.g. 129 records = 2.6 kB for SHA-1 at epsilon 64:
+ * usually a single page. for uniform hashes, a segment covers ~ epsilon^2 records:
+ * a few MB for a billion records - much less than a dense prefix table.
+ *
+ * file format - all numbers little endian:
+ *   8 bytes   magic "SRDSPGM1"
+ *   4 bytes   blockSize
+ *   4 bytes   epsilon
+ *   8 bytes   number of records
+ *   8 bytes   number of segments
+ *   8 bytes   maxRun: maximum number of records with equal leading 64 bits
+ *   segments - ascending by key:
+ *     8 bytes  x0: key of first point
+ *     8 bytes  r0: position of first point
+ *     8 bytes  slope: IEEE 754 double
+ *
+ * Author:  Hayati Ayguen
+ */
+
+#ifndef SRDSPGM_H
+#define SRDSPGM_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <float.h>
+
+#include "srdsindex.h"
+
+#define SRDSPGM_MAGIC        "SRDSPGM1"
+#define SRDSPGM_HEADER_SIZE  40
+
+struct SrdsPgmWriter {
+  FILE * fp;
+  int blockSize;
+  int epsilon;
+  uint64_t numRecords;
+  uint64_t numSegments;
+  uint64_t run;            /* records with key lastKey */
+  uint64_t maxRun;
+  uint64_t lastKey;
+  uint64_t x0, r0;         /* first point of the open segment */
+  double slopeLo, slopeHi; /* feasible slopes of the open segment */
+};
+
+/* model in memory */
+struct SrdsPgm {
+  int blockSize;
+  int epsilon;
+  uint64_t numRecords;
+  uint64_t numSegments;
+  uint64_t maxRun;
+  uint64_t * keys;
+  uint64_t * pos;
+  double * slopes;
+};
+
+
+static inline
+void srdsPgmPutDouble( unsigned char * p, double d )
+{
+  uint64_t v;
+  memcpy( &v, &d, 8 );
+  putLE64( p, v );
+}
+
+static inline
+double srdsPgmGetDouble( const unsigned char * p )
+{
+  const uint64_t v = getLE64( p );
+  double d;
+  memcpy( &d, &v, 8 );
+  return d;
+}
+
+static
+int srdsPgmWriteHeader( struct SrdsPgmWriter * w )
+{
+  unsigned char h[SRDSPGM_HEADER_SIZE];
+  memcpy( h, SRDSPGM_MAGIC, 8 );
+  putLE32( h + 8, (uint32_t)w->blockSize );
+  putLE32( h + 12, (uint32_t)w->epsilon );
+  putLE64( h + 16, w->numRecords );
+  putLE64( h + 24, w->numSegments );
+  putLE64( h + 32, w->maxRun );
+  return fwrite( h, SRDSPGM_HEADER_SIZE, 1, w->fp ) == 1 ? 0 : -1;
+}
+
+/* epsilon must be >= 1. returns 0 on success */
+static
+int srdsPgmOpen( struct SrdsPgmWriter * w, const char * fn, int blockSize, int epsilon )
+{
+  memset( w, 0, sizeof(*w) );
+  w->blockSize = blockSize;
+  w->epsilon = epsilon;
+  w->fp = fopen( fn, "wb" );
+  if ( !w->fp )
+    return -1;
+  return srdsPgmWriteHeader( w );
+}
+
+static
+int srdsPgmEmit( struct SrdsPgmWriter * w )
+{
+  unsigned char e[24];
+  /* single point: any slope >= 0 fits */
+  const double slope = ( w->slopeHi == DBL_MAX ) ? w->slopeLo : 0.5 * ( w->slopeLo + w->slopeHi );
+  putLE64( e, w->x0 );
+  putLE64( e + 8, w->r0 );
+  srdsPgmPutDouble( e + 16, slope );
+  ++w->numSegments;
+  return fwrite( e, 24, 1, w->fp ) == 1 ? 0 : -1;
+}
+
+/* add next record - records must be in ascending order. returns 0 on success, -2 on order violation */
+static inline
+int srdsPgmAdd( struct SrdsPgmWriter * w, const unsigned char * rec )
+{
+  const uint64_t x = keyPrefix64( rec, w->blockSize, 0 );
+  const uint64_t r = w->numRecords;
+  /* fitted with epsilon - 1: rounding of the prediction adds up to 0.5 */
+  const double e = (double)( w->epsilon - 1 );
+  double dx, lo, hi;
+
+  if ( r && x < w->lastKey )
+    return -2;
+  ++w->numRecords;
+  if ( r && x == w->lastKey ) {
+    if ( ++w->run > w->maxRun )
+      w->maxRun = w->run;
+    return 0;
+  }
+  w->lastKey = x;
+  w->run = 1;
+  if ( !w->maxRun )
+    w->maxRun = 1;
+
+  if ( r ) {
+    dx = (double)( x - w->x0 );
+    lo = ( (double)( r - w->r0 ) - e ) / dx;
+    hi = ( (double)( r - w->r0 ) + e ) / dx;
+    if ( lo < w->slopeLo )
+      lo = w->slopeLo;
+    if ( hi > w->slopeHi )
+      hi = w->slopeHi;
+    if ( lo <= hi ) {
+      w->slopeLo = lo;
+      w->slopeHi = hi;
+      return 0;
+    }
+    if ( srdsPgmEmit( w ) )
+      return -1;
+  }
+  /* start a new segment at this point. slopes >= 0 keep predictions monotonic */
+  w->x0 = x;
+  w->r0 = r;
+  w->slopeLo = 0.0;
+  w->slopeHi = DBL_MAX;
+  return 0;
+}
+
+/* writes last segment and final header. returns 0 on success */
+static
+int srdsPgmClose( struct SrdsPgmWriter * w )
+{
+  int ret = 0;
+  if ( w->numRecords && srdsPgmEmit( w ) )
+    ret = -1;
+  if ( !ret && ( fseek( w->fp, 0, SEEK_SET ) || srdsPgmWriteHeader( w ) ) )
+    ret = -1;
+  if ( fclose( w->fp ) )
+    ret = -1;
+  w->fp = NULL;
+  return ret;
+}
+
+
+static
+void srdsPgmFree( struct SrdsPgm * m )
+{
+  free( m->keys );
+  free( m->pos );
+  free( m->slopes );
+  memset( m, 0, sizeof(*m) );
+}
+
+/* loads the model into memory. returns 0 on success */
+static
+int srdsPgmLoad( struct SrdsPgm * m, const char * fn )
+{
+  unsigned char h[SRDSPGM_HEADER_SIZE];
+  unsigned char e[24];
+  FILE * fp = fopen( fn, "rb" );
+  uint64_t k;
+
+  memset( m, 0, sizeof(*m) );
+  if ( !fp )
+    return -1;
+  if ( fread( h, SRDSPGM_HEADER_SIZE, 1, fp ) != 1 || memcmp( h, SRDSPGM_MAGIC, 8 ) ) {
+    fclose( fp );
+    return -1;
+  }
+  m->blockSize = (int)getLE32( h + 8 );
+  m->epsilon = (int)getLE32( h + 12 );
+  m->numRecords = getLE64( h + 16 );
+  m->numSegments = getLE64( h + 24 );
+  m->maxRun = getLE64( h + 32 );
+  m->keys = (uint64_t *)malloc( ( m->numSegments + 1 ) * sizeof(uint64_t) );
+  m->pos = (uint64_t *)malloc( ( m->numSegments + 1 ) * sizeof(uint64_t) );
+  m->slopes = (double *)malloc( ( m->numSegments + 1 ) * sizeof(double) );
+  if ( m->blockSize <= 0 || m->epsilon <= 0 || !m->keys || !m->pos || !m->slopes ) {
+    fclose( fp );
+    srdsPgmFree( m );
+    return -1;
+  }
+  for ( k = 0; k < m->numSegments; ++k ) {
+    if ( fread( e, 24, 1, fp ) != 1 ) {
+      fclose( fp );
+      srdsPgmFree( m );
+      return -1;
+    }
+    m->keys[k] = getLE64( e );
+    m->pos[k] = getLE64( e + 8 );
+    m->slopes[k] = srdsPgmGetDouble( e + 16 );
+  }
+  /* sentinel: end of last segment */
+  m->pos[ m->numSegments ] = m->numRecords;
+  fclose( fp );
+  return 0;
+}
+
+/* predicted position of the first record with leading 64 bits >= x */
+static inline
+uint64_t srdsPgmPredict( const struct SrdsPgm * m, uint64_t x )
+{
+  uint64_t lo = 0, hi = m->numSegments;
+  double p;
+  /* last segment with key <= x */
+  while ( lo < hi ) {
+    const uint64_t mid = lo + ( hi - lo ) / 2;
+    if ( m->keys[mid] <= x )
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if ( !lo )
+    return 0;
+  --lo;
+  p = (double)m->pos[lo] + m->slopes[lo] * (double)( x - m->keys[lo] ) + 0.5;
+  if ( p >= (double)m->pos[ lo + 1 ] )
+    return m->pos[ lo + 1 ];
+  return (uint64_t)p;
+}
+
+/*
+ * range of records [ *first, *last ), which holds all records starting with key.
+ * keyLen might be shorter than 8 bytes
+ */
+static
+void srdsPgmLookup( const struct SrdsPgm * m, const unsigned char * key, int keyLen,
+                    uint64_t * first, uint64_t * last )
+{
+  const uint64_t lo = keyPrefix64( key, keyLen, 0x00 );
+  const uint64_t hi = keyPrefix64( key, keyLen, 0xFF );
+  const uint64_t p = srdsPgmPredict( m, lo );
+  *first = ( p > (uint64_t)m->epsilon ) ? p - m->epsilon : 0;
+  if ( hi == UINT64_MAX )
+    *last = m->numRecords;
+  else {
+    /* the first record > hi is at most epsilon + maxRun - 1 behind its prediction */
+    *last = srdsPgmPredict( m, hi + 1 ) + m->epsilon + m->maxRun;
+    if ( *last > m->numRecords )
+      *last = m->numRecords;
+  }
+}
+
+#endif /* SRDSPGM_H */
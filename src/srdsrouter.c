@@ -0,0 +1,329 @@
+/*
+ * srdsrouter (sorted raw data set query router)
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * srdsrouter distributes lookups over several srdsserve instances,
+ * each serving one shard (from srdssplit) of the key space.
+ * the manifest has the format of srdsshard.h - with the address of
+ * each shard's server instead of the path, e.g.
+ *   shard=0000 7FFF 1234 127.0.0.1:7001
+ *   shard=8000 FFFF 1230 /run/srds/shard1.sock
+ *
+ * clients use the line protocol of srdsnet.h - with single keys or batches.
+ * all keys of a batch are split by shard, the sub batches are sent to all
+ * involved servers at once (pipelined in one write each) and the replies are
+ * read in parallel with poll() - with a timeout. the replies are merged
+ * in request order. keys, shorter than the prefix, might span several shards:
+ * their counts are summed up.
+ * each client connection is served by its own thread - with its own
+ * connections to the servers.
+ *
+ * Usage: see below at usage()
+ *
+ * Author:  Hayati Ayguen
+ */
+
+#include <sys/time.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+
+#include "srdsnet.h"
+#include "srdsshard.h"
+
+static int verboseFlag = 0;
+static int timeoutMs = 5000;
+static struct SrdsManifest manifest;
+
+/* connection to one shard's server - per client connection */
+struct Backend {
+  int fd;
+  int connecting;
+  int failed;              /* in current batch */
+  size_t expected;         /* number of reply lines in current batch */
+  size_t received;
+  size_t scanned;          /* reply bytes already scanned for line ends */
+  struct SrdsLineBuf out;  /* sub batch */
+  struct SrdsLineBuf in;   /* replies */
+};
+
+struct Query {
+  char * line;
+  int first, last;         /* shards */
+  int err;
+};
+
+
+static
+long long nowMs()
+{
+  struct timeval tv;
+  gettimeofday( &tv, NULL );
+  return (long long)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+static
+void closeBackend( struct Backend * be )
+{
+  if ( be->fd >= 0 )
+    close( be->fd );
+  be->fd = -1;
+  be->connecting = 0;
+  be->failed = 1;
+}
+
+/* send all sub batches and receive all replies - in parallel. failed backends are closed */
+static
+void exchange( struct Backend * be, struct pollfd * pfd, int * pidx )
+{
+  const long long deadline = nowMs() + timeoutMs;
+  int s, n;
+
+  for ( s = 0; s < manifest.numShards; ++s ) {
+    if ( !be[s].expected || be[s].fd >= 0 )
+      continue;
+    be[s].fd = srdsNetConnect( manifest.shards[s].name, 1 );
+    be[s].connecting = 1;
+    if ( be[s].fd < 0 ) {
+      if ( verboseFlag )
+        fprintf(stderr, "error connecting to shard server '%s'\n", manifest.shards[s].name);
+      closeBackend( &be[s] );
+    }
+  }
+
+  for (;;) {
+    long long remaining;
+    for ( n = 0, s = 0; s < manifest.numShards; ++s ) {
+      if ( be[s].failed || ( be[s].out.beg == be[s].out.end && be[s].received >= be[s].expected ) )
+        continue;
+      pfd[n].fd = be[s].fd;
+      pfd[n].events = ( be[s].out.beg < be[s].out.end ) ? ( POLLIN | POLLOUT ) : POLLIN;
+      pfd[n].revents = 0;
+      pidx[n++] = s;
+    }
+    if ( !n )
+      break;
+    remaining = deadline - nowMs();
+    if ( remaining <= 0 || poll( pfd, n, (int)remaining ) == 0 ) {
+      for ( s = 0; s < n; ++s ) {
+        if ( verboseFlag )
+          fprintf(stderr, "timeout from shard server '%s'\n", manifest.shards[ pidx[s] ].name);
+        closeBackend( &be[ pidx[s] ] );
+      }
+      break;
+    }
+    for ( s = 0; s < n; ++s ) {
+      struct Backend * b = &be[ pidx[s] ];
+      if ( ( pfd[s].revents & POLLOUT ) && b->connecting ) {
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if ( getsockopt( b->fd, SOL_SOCKET, SO_ERROR, &err, &len ) || err ) {
+          closeBackend( b );
+          continue;
+        }
+        b->connecting = 0;
+      }
+      if ( pfd[s].revents & POLLOUT ) {
+        const ssize_t w = write( b->fd, b->out.buf + b->out.beg, b->out.end - b->out.beg );
+        if ( w > 0 )
+          b->out.beg += (size_t)w;
+        else if ( w < 0 && errno != EAGAIN && errno != EINTR ) {
+          closeBackend( b );
+          continue;
+        }
+      }
+      if ( pfd[s].revents & ( POLLIN | POLLHUP | POLLERR ) ) {
+        const ssize_t r = srdsLineBufFill( &b->in, b->fd );
+        if ( r > 0 ) {
+          for ( ; b->scanned < b->in.end; ++b->scanned )
+            b->received += ( b->in.buf[ b->scanned ] == '\n' );
+        }
+        else if ( r == 0 || ( errno != EAGAIN && errno != EINTR ) )
+          closeBackend( b );
+      }
+    }
+  }
+}
+
+static
+void * routeConnection( void * arg )
+{
+  const int fd = (int)(intptr_t)arg;
+  struct SrdsLineBuf in, out;
+  struct Backend * be = (struct Backend *)calloc( manifest.numShards, sizeof(struct Backend) );
+  struct pollfd * pfd = (struct pollfd *)malloc( manifest.numShards * sizeof(struct pollfd) );
+  int * pidx = (int *)malloc( manifest.numShards * sizeof(int) );
+  struct Query * q = NULL;
+  size_t numQ, capQ = 0, k;
+  unsigned char key[SRDSNET_MAXLINE / 2];
+  char * line;
+  int s, failed = 0;
+
+  memset( &in, 0, sizeof(in) );
+  memset( &out, 0, sizeof(out) );
+  for ( s = 0; be && s < manifest.numShards; ++s )
+    be[s].fd = -1;
+
+  while ( be && pfd && pidx && srdsLineBufFill( &in, fd ) > 0 ) {
+    for ( s = 0; s < manifest.numShards; ++s ) {
+      be[s].out.beg = be[s].out.end = 0;
+      be[s].in.beg = be[s].in.end = 0;
+      be[s].expected = be[s].received = be[s].scanned = 0;
+      be[s].failed = 0;
+    }
+
+    /* split the batch by shard */
+    for ( numQ = 0; ( line = srdsLineBufNext( &in ) ); ++numQ ) {
+      const int keyLen = srdsNetParseKey( line, key, sizeof(key) );
+      if ( numQ == capQ ) {
+        struct Query * p = (struct Query *)realloc( q, ( capQ ? 2 * capQ : 1024 ) * sizeof(struct Query) );
+        if ( !p ) {
+          failed = 1;
+          break;
+        }
+        q = p;
+        capQ = capQ ? 2 * capQ : 1024;
+      }
+      q[numQ].line = line;
+      q[numQ].err = ( keyLen <= 0 || keyLen > manifest.blockSize );
+      q[numQ].first = q[numQ].err ? -1 : srdsManifestFind( &manifest, srdsManifestPrefix( &manifest, key, keyLen, 0x00 ) );
+      q[numQ].last = q[numQ].err ? -1 : srdsManifestFind( &manifest, srdsManifestPrefix( &manifest, key, keyLen, 0xFF ) );
+      if ( q[numQ].first < 0 || q[numQ].last < 0 )
+        q[numQ].err = 1;
+      for ( s = q[numQ].first; !q[numQ].err && s <= q[numQ].last; ++s ) {
+        if ( srdsLineBufAppend( &be[s].out, line, strlen(line) ) || srdsLineBufAppend( &be[s].out, "\n", 1 ) ) {
+          failed = 1;
+          break;
+        }
+        ++be[s].expected;
+      }
+      if ( failed )
+        break;
+    }
+    /* out of memory: a query would get no reply - close the connection instead */
+    if ( failed )
+      break;
+
+    exchange( be, pfd, pidx );
+
+    /* merge replies in request order */
+    out.beg = out.end = 0;
+    for ( k = 0; k < numQ; ++k ) {
+      unsigned long long sum = 0;
+      char num[32];
+      int err = q[k].err, n;
+      for ( s = q[k].first; !q[k].err && s <= q[k].last; ++s ) {
+        const char * reply = be[s].failed ? NULL : srdsLineBufNext( &be[s].in );
+        const char * colon = reply ? strrchr( reply, ':' ) : NULL;
+        if ( !colon || !strcmp( colon + 1, "ERR" ) )
+          err = 1;
+        else
+          sum += strtoull( colon + 1, NULL, 10 );
+      }
+      n = err ? snprintf( num, sizeof(num), ":ERR\n" ) : snprintf( num, sizeof(num), ":%llu\n", sum );
+      if ( srdsLineBufAppend( &out, q[k].line, strlen( q[k].line ) ) || srdsLineBufAppend( &out, num, n ) ) {
+        failed = 1;
+        break;
+      }
+    }
+    if ( failed || in.end - in.beg > SRDSNET_MAXLINE || srdsNetWriteAll( fd, out.buf, out.end ) )
+      break;
+  }
+
+  if ( failed )
+    fprintf(stderr, "error: out of memory - closing connection\n");
+  close( fd );
+  for ( s = 0; be && s < manifest.numShards; ++s ) {
+    if ( be[s].fd >= 0 )
+      close( be[s].fd );
+    srdsLineBufFree( &be[s].out );
+    srdsLineBufFree( &be[s].in );
+  }
+  srdsLineBufFree( &in );
+  srdsLineBufFree( &out );
+  free( be );
+  free( pfd );
+  free( pidx );
+  free( q );
+  return NULL;
+}
+
+
+static
+void usage() {
+  fputs("Usage: srdsrouter [-v][-h][-t <timeout>] -L <address> <manifest>\n", stderr);
+  fputs("  routes lookups of hexadecimal keys by prefix to the srdsserve instances of the manifest\n", stderr);
+  fputs("  batches are split by shard and sent to all servers in parallel. replies are merged in request order\n", stderr);
+  fputs("  -v     verbose output\n", stderr);
+  fputs("  -h     print usage\n",stderr);
+  fputs("  -t <v> timeout in milliseconds for the servers' replies to a batch. default: 5000\n", stderr);
+  fputs("  -L <a> listen address: 'host:port', ':port', 'port' or unix socket path (with '/')\n", stderr);
+  fputs("  manifest  shard manifest (see srdssplit) - with server addresses instead of paths\n", stderr);
+}
+
+
+int main(int argc, char *argv[])
+{
+  const char * addr = NULL;
+  int helpFlag = 0;
+  int optFlag, lfd, k;
+  pthread_attr_t attr;
+  extern int optind;
+
+  /* parse command line options */
+  while ((optFlag = getopt(argc, argv, "vht:L:")) > 0 && optFlag != '?') {
+    switch(optFlag) {
+    case 'v': ++verboseFlag; break;
+    case 'h': ++helpFlag; break;
+    case 't': timeoutMs = atoi(optarg); break;
+    case 'L': addr = optarg; break;
+    }
+  }
+  if (optFlag == '?' || helpFlag || !addr || optind + 1 != argc) {
+    usage();
+    exit(2);
+  }
+
+  if ( srdsManifestRead( &manifest, argv[optind] ) ) {
+    fprintf(stderr, "error reading shard manifest '%s'\n", argv[optind]);
+    return 10;
+  }
+  if ( verboseFlag ) {
+    for ( k = 0; k < manifest.numShards; ++k )
+      fprintf(stderr, "shard %d: prefixes %X .. %X at '%s'\n", k,
+              manifest.shards[k].first, manifest.shards[k].last, manifest.shards[k].name);
+  }
+
+  lfd = srdsNetListen( addr );
+  if ( lfd < 0 ) {
+    fprintf(stderr, "error listening on '%s'\n", addr);
+    return 10;
+  }
+  signal( SIGPIPE, SIG_IGN );
+
+  pthread_attr_init( &attr );
+  pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+  for (;;) {
+    pthread_t t;
+    const int cfd = accept( lfd, NULL, NULL );
+    if ( cfd < 0 ) {
+      if ( errno == EINTR || errno == ECONNABORTED )
+        continue;
+      fprintf(stderr, "error accepting connection on '%s'\n", addr);
+      return 9;
+    }
+    if ( pthread_create( &t, &attr, routeConnection, (void *)(intptr_t)cfd ) ) {
+      fprintf(stderr, "error creating thread for connection\n");
+      close( cfd );
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,227 @@
+/*
+ * srdsserve (sorted raw data set lookup server)
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * srdsserve maps a sorted raw data set file - e.g. one shard from srdssplit -
+ * into memory and answers lookups over TCP or a unix domain socket
+ * with the line protocol of srdsnet.h: 'KEY' => 'KEY:COUNT'.
+ * the key must start at offset 0 of each block.
+ * each connection is served by its own thread. several instances
+ * are combined with srdsrouter.
+ * the keys of a batch - all complete lines received at once - are searched
+ * interleaved (srdsilv.h): their cache misses in the mapped file overlap.
+ *
+ * Usage: see below at usage()
+ *
+ * Author:  Hayati Ayguen
+ */
+
+/* large file support */
+
+#ifdef _AIX
+#define _LARGE_FILES
+#else
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <pthread.h>
+
+#include "srdsnet.h"
+#include "srdsilv.h"
+
+static int blockSize = 20;
+static int verboseFlag = 0;
+static int ilvWidth = 16;
+static const unsigned char * data = NULL;
+static uint64_t numRecords = 0;
+
+
+/* keys of one batch of lines */
+struct Batch {
+  char ** lines;
+  unsigned char * keys;       /* blockSize bytes per line */
+  struct SrdsIlvJob * jobs;
+  int n, cap;
+};
+
+/* adds line with its parsed key - keyLen 0 for invalid keys. returns 0 on success */
+static
+int batchAdd( struct Batch * b, char * line )
+{
+  struct SrdsIlvJob * j;
+  int keyLen;
+  if ( b->n == b->cap ) {
+    const int cap = b->cap ? 2 * b->cap : 256;
+    char ** lines = (char **)realloc( b->lines, cap * sizeof(char *) );
+    unsigned char * keys = lines ? (unsigned char *)realloc( b->keys, (size_t)cap * blockSize ) : NULL;
+    struct SrdsIlvJob * jobs = keys ? (struct SrdsIlvJob *)realloc( b->jobs, cap * sizeof(struct SrdsIlvJob) ) : NULL;
+    if ( lines )
+      b->lines = lines;
+    if ( keys )
+      b->keys = keys;
+    if ( !jobs )
+      return -1;
+    b->jobs = jobs;
+    b->cap = cap;
+  }
+  j = &b->jobs[b->n];
+  keyLen = srdsNetParseKey( line, b->keys + (size_t)b->n * blockSize, blockSize );
+  j->keyLen = ( keyLen <= 0 || keyLen > blockSize ) ? 0 : keyLen;
+  j->lo = 0;
+  j->hi = j->keyLen ? numRecords : 0;
+  b->lines[b->n++] = line;
+  return 0;
+}
+
+static
+void * serveConnection( void * arg )
+{
+  const int fd = (int)(intptr_t)arg;
+  struct SrdsLineBuf in, out;
+  struct Batch b;
+  char * line;
+  uint64_t numKeys = 0;
+  int k, failed = 0;
+
+  memset( &in, 0, sizeof(in) );
+  memset( &out, 0, sizeof(out) );
+  memset( &b, 0, sizeof(b) );
+  while ( srdsLineBufFill( &in, fd ) > 0 ) {
+    /* all complete lines are one batch - searched interleaved, with a single reply write */
+    out.beg = out.end = 0;
+    b.n = 0;
+    while ( !failed && ( line = srdsLineBufNext( &in ) ) )
+      failed = batchAdd( &b, line );
+    /* out of memory: a key would get no reply - close the connection instead */
+    if ( failed )
+      break;
+    for ( k = 0; k < b.n; ++k )
+      b.jobs[k].key = b.keys + (size_t)k * blockSize;
+    srdsIlvSearch( data, numRecords, blockSize, 0, 0, b.jobs, b.n, ilvWidth, UINT64_MAX );
+
+    for ( k = 0; k < b.n; ++k ) {
+      char num[32];
+      const int n = !b.jobs[k].keyLen ? snprintf( num, sizeof(num), ":ERR\n" )
+                    : snprintf( num, sizeof(num), ":%llu\n", (unsigned long long)( b.jobs[k].hi - b.jobs[k].lo ) );
+      if ( srdsLineBufAppend( &out, b.lines[k], strlen(b.lines[k]) ) || srdsLineBufAppend( &out, num, n ) ) {
+        failed = 1;
+        break;
+      }
+      ++numKeys;
+    }
+    if ( failed || in.end - in.beg > SRDSNET_MAXLINE || srdsNetWriteAll( fd, out.buf, out.end ) )
+      break;
+  }
+  if ( failed )
+    fprintf(stderr, "error: out of memory - closing connection\n");
+  if ( verboseFlag )
+    fprintf(stderr, "connection closed after %llu keys\n", (unsigned long long)numKeys);
+  close( fd );
+  srdsLineBufFree( &in );
+  srdsLineBufFree( &out );
+  free( b.lines );
+  free( b.keys );
+  free( b.jobs );
+  return NULL;
+}
+
+
+static
+void usage() {
+  fputs("Usage: srdsserve [-v][-h][-l <blockLength>][-w <width>] -L <address> <sorted_file>\n", stderr);
+  fputs("  serves lookups of hexadecimal keys in a sorted raw data set: 'KEY' => 'KEY:COUNT'\n", stderr);
+  fputs("  one line per key. the key must start at offset 0\n", stderr);
+  fputs("  -v     verbose output\n", stderr);
+  fputs("  -h     print usage\n",stderr);
+  fputs("  -l <v> length of each raw data set block in bytes. default: 20\n", stderr);
+  fputs("  -w <v> number of interleaved searches of a batch of keys. default: 16. 1 searches one by one\n", stderr);
+  fputs("  -L <a> listen address: 'host:port', ':port', 'port' or unix socket path (with '/')\n", stderr);
+}
+
+
+int main(int argc, char *argv[])
+{
+  const char * addr = NULL;
+  int helpFlag = 0;
+  int optFlag, fd, lfd;
+  struct stat st;
+  pthread_attr_t attr;
+  extern int optind;
+
+  /* parse command line options */
+  while ((optFlag = getopt(argc, argv, "vhl:w:L:")) > 0 && optFlag != '?') {
+    switch(optFlag) {
+    case 'v': ++verboseFlag; break;
+    case 'h': ++helpFlag; break;
+    case 'l': blockSize = atoi(optarg); break;
+    case 'w': ilvWidth = atoi(optarg); break;
+    case 'L': addr = optarg; break;
+    }
+  }
+  if (optFlag == '?' || helpFlag || !addr || optind + 1 != argc) {
+    usage();
+    exit(2);
+  }
+  if ( blockSize <= 0 ) {
+    fprintf(stderr, "error: blockSize %d is <= 0 !\n", blockSize);
+    return 10;
+  }
+  if ( ilvWidth < 1 || ilvWidth > SRDSILV_MAX_WIDTH ) {
+    fprintf(stderr, "error: width %d is not in 1 .. %d !\n", ilvWidth, SRDSILV_MAX_WIDTH);
+    return 10;
+  }
+
+  fd = open( argv[optind], O_RDONLY );
+  if ( fd < 0 || fstat( fd, &st ) || !S_ISREG(st.st_mode) ) {
+    fprintf(stderr, "error opening input file '%s' - must be a regular file\n", argv[optind]);
+    return 10;
+  }
+  numRecords = (uint64_t)st.st_size / blockSize;
+  if ( numRecords ) {
+    data = (const unsigned char *)mmap( NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+    if ( data == (const unsigned char *)MAP_FAILED ) {
+      fprintf(stderr, "error mapping input file '%s'\n", argv[optind]);
+      return 10;
+    }
+  }
+  close( fd );
+
+  lfd = srdsNetListen( addr );
+  if ( lfd < 0 ) {
+    fprintf(stderr, "error listening on '%s'\n", addr);
+    return 10;
+  }
+  signal( SIGPIPE, SIG_IGN );
+  if ( verboseFlag )
+    fprintf(stderr, "serving %llu records of '%s' on '%s'\n", (unsigned long long)numRecords, argv[optind], addr);
+
+  pthread_attr_init( &attr );
+  pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+  for (;;) {
+    pthread_t t;
+    const int cfd = accept( lfd, NULL, NULL );
+    if ( cfd < 0 ) {
+      if ( errno == EINTR || errno == ECONNABORTED )
+        continue;
+      fprintf(stderr, "error accepting connection on '%s'\n", addr);
+      return 9;
+    }
+    if ( pthread_create( &t, &attr, serveConnection, (void *)(intptr_t)cfd ) ) {
+      fprintf(stderr, "error creating thread for connection\n");
+      close( cfd );
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,159 @@
+/*
+ * srdsshard.h
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * shard manifest of a sorted raw data set, which was split with srdssplit
+ * into key ranges at prefix boundaries: all keys with the same leading
+ * 'prefixBits' bits are in the same shard. so a key is routed to its shard
+ * by its prefix - without searching other shards.
+ *
+ * manifest format - text lines:
+ *   blockSize=<bytes>
+ *   prefixBits=<bits>
+ *   shards=<number>
+ *   shard=<first prefix> <last prefix> <number of records> <path>
+ *   ..
+ * prefixes are hexadecimal, ranges are inclusive and ascending.
+ * relative paths are relative to the manifest's directory.
+ * for srdsrouter, the path is the address of the shard's srdsserve.
+ * lines starting with '#' are comments.
+ *
+ * Author:  Hayati Ayguen
+ */
+
+#ifndef SRDSSHARD_H
+#define SRDSSHARD_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "srdsindex.h"
+
+struct SrdsShard {
+  uint32_t first;        /* prefix range [ first, last ] */
+  uint32_t last;
+  unsigned long long numRecords;
+  char * path;
+  char * name;           /* path as written - e.g. address of a srdsserve */
+  FILE * fp;             /* opened on demand by user */
+};
+
+struct SrdsManifest {
+  int blockSize;
+  int prefixBits;
+  int numShards;
+  struct SrdsShard * shards;
+};
+
+static
+void srdsManifestFree( struct SrdsManifest * m )
+{
+  int k;
+  for ( k = 0; k < m->numShards; ++k ) {
+    if ( m->shards[k].fp )
+      fclose( m->shards[k].fp );
+    free( m->shards[k].path );
+    free( m->shards[k].name );
+  }
+  free( m->shards );
+  memset( m, 0, sizeof(*m) );
+}
+
+/* returns 0 on success */
+static
+int srdsManifestRead( struct SrdsManifest * m, const char * fn )
+{
+  FILE * fp = fopen( fn, "r" );
+  const char * slash = strrchr( fn, '/' );
+  const size_t dirLen = slash ? (size_t)( slash - fn + 1 ) : 0;
+  char line[4096];
+  int cap = 0, ret = 0;
+
+  memset( m, 0, sizeof(*m) );
+  if ( !fp )
+    return -1;
+  while ( !ret && fgets( line, sizeof(line), fp ) ) {
+    char path[4096];
+    unsigned first, last;
+    unsigned long long n;
+    line[ strcspn( line, "\r\n" ) ] = 0;
+    if ( !line[0] || line[0] == '#' )
+      continue;
+    if ( !strncmp( line, "blockSize=", 10 ) )
+      m->blockSize = atoi( line + 10 );
+    else if ( !strncmp( line, "prefixBits=", 11 ) )
+      m->prefixBits = atoi( line + 11 );
+    else if ( !strncmp( line, "shards=", 7 ) )
+      ;
+    else if ( !strncmp( line, "shard=", 6 ) && sscanf( line + 6, "%x %x %llu %4095[^\n]", &first, &last, &n, path ) == 4 ) {
+      struct SrdsShard * s;
+      if ( m->numShards == cap ) {
+        cap = cap ? 2 * cap : 16;
+        s = (struct SrdsShard *)realloc( m->shards, cap * sizeof(struct SrdsShard) );
+        if ( !s ) {
+          ret = -1;
+          break;
+        }
+        m->shards = s;
+      }
+      s = &m->shards[ m->numShards++ ];
+      memset( s, 0, sizeof(*s) );
+      s->first = first;
+      s->last = last;
+      s->numRecords = n;
+      s->path = (char *)malloc( dirLen + strlen(path) + 1 );
+      s->name = strdup( path );
+      if ( !s->path || !s->name ) {
+        ret = -1;
+        break;
+      }
+      if ( path[0] == '/' )
+        strcpy( s->path, path );
+      else {
+        memcpy( s->path, fn, dirLen );
+        strcpy( s->path + dirLen, path );
+      }
+      /* shards must be ascending and without overlap */
+      if ( first > last || ( m->numShards > 1 && first <= m->shards[ m->numShards - 2 ].last ) )
+        ret = -1;
+    }
+    else
+      ret = -1;
+  }
+  fclose( fp );
+  if ( !ret && ( m->blockSize <= 0 || m->prefixBits <= 0 || m->prefixBits > 32 || !m->numShards ) )
+    ret = -1;
+  if ( ret )
+    srdsManifestFree( m );
+  return ret;
+}
+
+/* index of the shard holding the prefix - or -1 */
+static inline
+int srdsManifestFind( const struct SrdsManifest * m, uint32_t prefix )
+{
+  int lo = 0, hi = m->numShards - 1;
+  while ( lo <= hi ) {
+    const int mid = ( lo + hi ) / 2;
+    if ( prefix < m->shards[mid].first )
+      hi = mid - 1;
+    else if ( prefix > m->shards[mid].last )
+      lo = mid + 1;
+    else
+      return mid;
+  }
+  return -1;
+}
+
+/* leading prefixBits of key - up to 32 bits */
+static inline
+uint32_t srdsManifestPrefix( const struct SrdsManifest * m, const unsigned char * key, int keyLen, int padByte )
+{
+  return keyPrefix( key, keyLen, m->prefixBits, padByte );
+}
+
+#endif /* SRDSSHARD_H */
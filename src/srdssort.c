@@ -0,0 +1,573 @@
+/*
+ * srdssort (raw data set sort)
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * srdssort sorts (unsorted) raw data set files into a sorted raw data set:
+ * an alternative to traditional Unix sort for fixed length binary blocks.
+ * Limitations / requirements:
+ * 1) every 'line' is a raw data set (block) - all with same fixed length
+ * 2) the key is compared bytewise (memcmp order), as with srdsgrep/srdsmerge
+ * 3) the sort is not stable: records with equal keys - but different bytes
+ *    outside the key (-b/-e) - are output in an unspecified order
+ *
+ * input is read in chunks of the memory budget (option -M).
+ * each chunk is sorted in memory with a most significant digit (MSD)
+ * radix sort on the key bytes: the 1st key byte is distributed by all threads
+ * into 256 buckets. for hash data, the buckets are of (nearly) even size,
+ * so the threads sort the buckets independently - with an in-place
+ * american flag sort on the following key bytes.
+ * when the input does not fit into one chunk, each sorted chunk is spilled
+ * as a run to a temporary file and all runs are k-way merged at the end.
+ *
+ * Usage: see below at usage()
+ *
+ * Author:  Hayati Ayguen
+ */
+
+/* large file support */
+
+#ifdef _AIX
+#define _LARGE_FILES
+#else
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdio.h>
+#include <pthread.h>
+
+#define MAXTHREADS  256
+#define INSERTION_THRESHOLD  32
+
+static int blockSize = -1;
+static int keyBeg = 0;
+static int keyEnd = -1;
+static int keyLen = -1;
+static int revFlag = 0;
+static int verboseFlag = 0;
+static int numThreads = 0;
+
+
+/* key byte at depth d of record r - mapped for descending order */
+#define KEYBYTE(r, d)  ( revFlag ? ( 255 - (r)[keyBeg + (d)] ) : (r)[keyBeg + (d)] )
+
+static inline
+int compareKeys( const unsigned char * a, const unsigned char * b, int depth )
+{
+  int cmp = memcmp( a + keyBeg + depth, b + keyBeg + depth, keyLen - depth );
+  return revFlag ? -cmp : cmp;
+}
+
+
+static
+void insertionSort( unsigned char * base, size_t n, int depth, unsigned char * tmp )
+{
+  size_t i, j;
+  for ( i = 1; i < n; ++i ) {
+    unsigned char * r = base + i * blockSize;
+    for ( j = i; j > 0 && compareKeys( base + (j-1) * blockSize, r, depth ) > 0; --j )
+      ;
+    if ( j == i )
+      continue;
+    memcpy( tmp, r, blockSize );
+    memmove( base + (j+1) * blockSize, base + j * blockSize, (i - j) * blockSize );
+    memcpy( base + j * blockSize, tmp, blockSize );
+  }
+}
+
+
+/* in-place MSD radix sort (american flag sort) from key byte 'depth' on */
+static
+void flagSort( unsigned char * base, size_t n, int depth, unsigned char * tmp )
+{
+  size_t count[256], head[256], tail[256];
+  size_t i, pos;
+  int b;
+
+  while ( 1 ) {
+    if ( n < 2 || depth >= keyLen )
+      return;
+    if ( n < INSERTION_THRESHOLD ) {
+      insertionSort( base, n, depth, tmp );
+      return;
+    }
+
+    memset( count, 0, sizeof(count) );
+    for ( i = 0; i < n; ++i )
+      ++count[ KEYBYTE( base + i * blockSize, depth ) ];
+
+    /* all in one bucket? continue with next byte - without recursion */
+    for ( b = 0; b < 256 && count[b] != n; ++b )
+      ;
+    if ( b < 256 ) {
+      ++depth;
+      continue;
+    }
+    break;
+  }
+
+  for ( pos = 0, b = 0; b < 256; ++b ) {
+    head[b] = pos;
+    pos += count[b];
+    tail[b] = pos;
+  }
+
+  for ( b = 0; b < 256; ++b ) {
+    while ( head[b] < tail[b] ) {
+      unsigned char * r = base + head[b] * blockSize;
+      int v = KEYBYTE( r, depth );
+      if ( v == b ) {
+        ++head[b];
+      }
+      else {
+        unsigned char * s = base + head[v] * blockSize;
+        memcpy( tmp, r, blockSize );
+        memcpy( r, s, blockSize );
+        memcpy( s, tmp, blockSize );
+        ++head[v];
+      }
+    }
+  }
+
+  for ( pos = 0, b = 0; b < 256; ++b ) {
+    if ( count[b] > 1 )
+      flagSort( base + pos * blockSize, count[b], depth + 1, tmp );
+    pos += count[b];
+  }
+}
+
+
+/* shared state for sorting one chunk with multiple threads */
+struct SortJob {
+  unsigned char * src;
+  unsigned char * dst;
+  size_t n;
+  size_t hist[MAXTHREADS][256];
+  size_t bucketBeg[257];
+  int nextBucket;
+  pthread_mutex_t mutex;
+  pthread_barrier_t barrier;
+};
+
+struct SortThread {
+  struct SortJob * job;
+  int no;
+};
+
+static
+void * sortThread( void * arg )
+{
+  struct SortThread * t = (struct SortThread *)arg;
+  struct SortJob * job = t->job;
+  const size_t lo = job->n * t->no / numThreads;
+  const size_t hi = job->n * (t->no + 1) / numThreads;
+  size_t * hist = job->hist[t->no];
+  size_t off[256];
+  size_t i;
+  int b, k;
+  unsigned char * tmp = (unsigned char *)malloc( blockSize );
+
+  /* 1st pass: histogram of 1st key byte over own slice */
+  memset( hist, 0, 256 * sizeof(size_t) );
+  for ( i = lo; i < hi; ++i )
+    ++hist[ KEYBYTE( job->src + i * blockSize, 0 ) ];
+
+  pthread_barrier_wait( &job->barrier );
+
+  /* output offset of own slice in each bucket */
+  {
+    size_t pos = 0;
+    for ( b = 0; b < 256; ++b ) {
+      if ( t->no == 0 )
+        job->bucketBeg[b] = pos;
+      for ( k = 0; k < numThreads; ++k ) {
+        if ( k == t->no )
+          off[b] = pos;
+        pos += job->hist[k][b];
+      }
+    }
+    if ( t->no == 0 )
+      job->bucketBeg[256] = pos;
+  }
+
+  /* 2nd pass: scatter own slice into the buckets */
+  for ( i = lo; i < hi; ++i ) {
+    const unsigned char * r = job->src + i * blockSize;
+    memcpy( job->dst + (off[ KEYBYTE( r, 0 ) ]++) * blockSize, r, blockSize );
+  }
+
+  pthread_barrier_wait( &job->barrier );
+
+  /* sort remaining key bytes of buckets - taking next free bucket */
+  while ( 1 ) {
+    pthread_mutex_lock( &job->mutex );
+    b = job->nextBucket++;
+    pthread_mutex_unlock( &job->mutex );
+    if ( b >= 256 )
+      break;
+    flagSort( job->dst + job->bucketBeg[b] * blockSize,
+              job->bucketBeg[b+1] - job->bucketBeg[b], 1, tmp );
+  }
+
+  free( tmp );
+  return NULL;
+}
+
+
+/* sorts n records from src into dst */
+static
+void sortChunk( unsigned char * src, unsigned char * dst, size_t n )
+{
+  static struct SortJob job;
+  pthread_t threads[MAXTHREADS];
+  struct SortThread targs[MAXTHREADS];
+  int k;
+
+  job.src = src;
+  job.dst = dst;
+  job.n = n;
+  job.nextBucket = 0;
+  pthread_mutex_init( &job.mutex, NULL );
+  pthread_barrier_init( &job.barrier, NULL, numThreads );
+
+  for ( k = 0; k < numThreads; ++k ) {
+    targs[k].job = &job;
+    targs[k].no = k;
+    if ( k )
+      pthread_create( &threads[k], NULL, sortThread, &targs[k] );
+  }
+  sortThread( &targs[0] );
+  for ( k = 1; k < numThreads; ++k )
+    pthread_join( threads[k], NULL );
+
+  pthread_barrier_destroy( &job.barrier );
+  pthread_mutex_destroy( &job.mutex );
+}
+
+
+/* reads up to maxRecords records over all input files */
+static
+size_t readChunk( unsigned char * buf, size_t maxRecords, FILE ** inputs, int numInputs, int * currInput )
+{
+  size_t n = 0;
+  while ( n < maxRecords && *currInput < numInputs ) {
+    FILE * fp = inputs[*currInput];
+    const size_t rd = fread( buf + n * blockSize, 1, ( maxRecords - n ) * blockSize, fp );
+    n += rd / blockSize;
+    if ( n < maxRecords ) {
+      if ( ferror(fp) )
+        fprintf(stderr, "error reading from input file %d!\n", *currInput);
+      else if ( rd % blockSize )
+        fprintf(stderr, "warning: input file %d has trailing bytes - not a multiple of blockSize %d!\n", *currInput, blockSize);
+      ++(*currInput);
+    }
+  }
+  return n;
+}
+
+
+static
+int writeRecords( FILE * out, const unsigned char * buf, size_t n )
+{
+  return ( fwrite( buf, blockSize, n, out ) == n ) ? 0 : -1;
+}
+
+
+/* k-way merge of sorted runs - with a binary heap of run indices */
+
+static FILE ** runs = NULL;
+static unsigned char ** runBuf = NULL;
+static int * heap = NULL;
+
+static inline
+int runLess( int a, int b )
+{
+  return compareKeys( runBuf[a], runBuf[b], 0 ) < 0;
+}
+
+static
+void siftDown( int numHeap, int i )
+{
+  while ( 1 ) {
+    int c = 2 * i + 1;
+    int t;
+    if ( c >= numHeap )
+      return;
+    if ( c + 1 < numHeap && runLess( heap[c+1], heap[c] ) )
+      ++c;
+    if ( !runLess( heap[c], heap[i] ) )
+      return;
+    t = heap[c];  heap[c] = heap[i];  heap[i] = t;
+    i = c;
+  }
+}
+
+static
+int mergeRuns( FILE * out, int numRuns, size_t bufferSize )
+{
+  int k, numHeap = 0;
+  unsigned long long numWritten = 0;
+
+  runBuf = (unsigned char **)malloc( numRuns * sizeof(unsigned char *) );
+  heap = (int *)malloc( numRuns * sizeof(int) );
+  for ( k = 0; k < numRuns; ++k ) {
+    void * rdBuffer = malloc( bufferSize );
+    if (rdBuffer) setbuffer( runs[k], rdBuffer, bufferSize );
+    runBuf[k] = (unsigned char *)malloc( blockSize );
+    if ( fread( runBuf[k], blockSize, 1, runs[k] ) == 1 )
+      heap[numHeap++] = k;
+  }
+  for ( k = numHeap / 2 - 1; k >= 0; --k )
+    siftDown( numHeap, k );
+
+  while ( numHeap ) {
+    const int best = heap[0];
+    if ( writeRecords( out, runBuf[best], 1 ) )
+      return -1;
+    ++numWritten;
+    if ( fread( runBuf[best], blockSize, 1, runs[best] ) != 1 )
+      heap[0] = heap[--numHeap];
+    siftDown( numHeap, 0 );
+  }
+
+  if (verboseFlag)
+    fprintf(stderr, "merged %d runs with %llu raw data sets\n", numRuns, numWritten);
+  return 0;
+}
+
+
+static
+void usage() {
+  fputs("Usage: srdssort [-v][-h][-B <bufferSize>][-M <memory>][-j <threads>][-T <tmpdir>][-r][-l <blockLength>][-b <keyBegin>][-e <keyEnd>][-o <output>] (<rds_file>)*\n", stderr);
+  fputs("  raw data set sort\n", stderr);
+  fputs("  -v     verbose output\n", stderr);
+  fputs("  -h     print usage\n",stderr);
+  fputs("  -B <v> bufferSize in kBytes\n", stderr);
+  fputs("  -M <v> memory budget in kBytes. default is 1048576 (= 1 GB)\n", stderr);
+  fputs("         input exceeding half of the budget is sorted in runs, spilled to temp files\n", stderr);
+  fputs("  -j <v> number of threads. default is number of online cpus\n", stderr);
+  fputs("  -T <d> directory for temporary files. default is $TMPDIR or /tmp\n", stderr);
+  fputs("  -r     sort in reversed (descending) order\n", stderr);
+  fputs("  -l <v> length of each raw data set block in bytes\n", stderr);
+  fputs("  -b <v> key's begin offset inside block\n", stderr);
+  fputs("  -e <v> key's end offset inside block\n", stderr);
+  fputs("         the sort is not stable: order of records with equal keys is unspecified\n", stderr);
+  fputs("  -o <f> output to file. default is stdout\n", stderr);
+  fputs("  rds_file  input files. '-' or no file reads stdin\n", stderr);
+}
+
+
+int main(int argc, char *argv[]) {
+  FILE * out = stdout;
+  const char * outfn = NULL;
+  const char * tmpDir = NULL;
+  FILE ** inputs = NULL;
+  int numInputs = 0, currInput = 0;
+  int numRuns = 0, maxRuns = 0;
+  int optFlag;
+  int helpFlag = 0;
+  int changedKeyOrBlock = 0;
+  size_t vBufSize = 0;
+  size_t bufferSize = 0;
+  size_t memBudget = (size_t)1024 * 1024 * 1024;
+  size_t maxRecords, n;
+  unsigned long long numTotal = 0;
+  unsigned char * chunk[2];
+  void * wrBuffer = NULL;
+  char * tmpName = NULL;
+  extern int optind;
+
+  /* parse command line options */
+  while ((optFlag = getopt(argc, argv, "vhB:M:j:T:rl:b:e:o:")) > 0 && optFlag != '?') {
+    switch(optFlag) {
+    case 'v': ++verboseFlag; break;
+    case 'h': ++helpFlag; break;
+    case 'B': vBufSize = (size_t)( atol(optarg) * 1024 ); break;
+    case 'M': memBudget = (size_t)( atol(optarg) * 1024 ); break;
+    case 'j': numThreads = atoi(optarg); break;
+    case 'T': tmpDir = optarg; break;
+    case 'r': ++revFlag; break;
+    case 'l':
+      blockSize = atoi(optarg);
+      if ( verboseFlag >= 2 )
+        fprintf(stderr, "parsed block length %d\n", blockSize);
+      break;
+    case 'b':
+      keyBeg = atoi(optarg);
+      if ( verboseFlag >= 2 )
+        fprintf(stderr, "parsed key Begin %d\n", keyBeg);
+      break;
+    case 'e':
+      keyEnd = atoi(optarg);
+      if ( verboseFlag >= 2 )
+        fprintf(stderr, "parsed key End %d\n", keyEnd);
+      break;
+    case 'o':
+      outfn = optarg;
+      break;
+    }
+  }
+  if (optFlag == '?' || helpFlag) {
+    usage();
+    exit(2);
+  }
+  optFlag = optind;
+
+  keyLen = keyEnd - keyBeg + 1;
+
+  if ( keyEnd < 0 && blockSize > 0 )
+  {
+    keyEnd = blockSize -1;
+    keyLen = keyEnd - keyBeg + 1;
+    changedKeyOrBlock = 1;
+  }
+
+  if ( blockSize <= 0 ) {
+    blockSize = keyBeg + keyLen;
+    changedKeyOrBlock = 1;
+    if (verboseFlag)
+      fprintf(stderr, "info: using block size %d\n", blockSize);
+  }
+  else if ( blockSize < keyBeg + keyLen ) {
+    fprintf(stderr, "error: blockSize %d is smaller than key end %d !\n", blockSize, keyBeg + keyLen);
+    return 10;
+  }
+
+  if (changedKeyOrBlock && verboseFlag)
+    fprintf(stderr, "using key at offset %d with length %d at blockSize %d\n", keyBeg, keyLen, blockSize );
+
+  if ( blockSize <= 0 ) {
+    fprintf(stderr, "error: blockSize %d is <= 0 !\n", blockSize);
+    return 10;
+  }
+  if ( keyLen <= 0 ) {
+    fprintf(stderr, "error: keyLen %d is <= 0 !\n", keyLen);
+    return 10;
+  }
+  if ( keyEnd <= 0 ) {
+    fprintf(stderr, "error: keyEnd %d is <= 0 !\n", keyEnd);
+    return 10;
+  }
+
+  if ( numThreads <= 0 )
+    numThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if ( numThreads <= 0 )
+    numThreads = 1;
+  else if ( numThreads > MAXTHREADS )
+    numThreads = MAXTHREADS;
+
+  /* chunk is sorted from chunk[0] into chunk[1] */
+  maxRecords = memBudget / ( 2 * (size_t)blockSize );
+  if ( maxRecords < (size_t)numThreads * 256 )
+    maxRecords = (size_t)numThreads * 256;
+
+  if (verboseFlag)
+    fprintf(stderr, "using %d threads and chunks of %lu raw data sets\n", numThreads, (unsigned long)maxRecords);
+
+  bufferSize = vBufSize ? vBufSize : 65536;
+
+  /* open input files */
+  inputs = (FILE **)malloc( ( argc - optFlag + 1 ) * sizeof(FILE *) );
+  for ( ; optFlag < argc; optFlag++) {
+    FILE * fp = strcmp(argv[optFlag], "-") ? fopen(argv[optFlag], "rb") : stdin;
+    if (!fp) {
+      fprintf(stderr, "srdssort:  could not open %s\n", argv[optFlag]);
+      exit(2);
+    }
+    inputs[numInputs++] = fp;
+  }
+  if ( !numInputs )
+    inputs[numInputs++] = stdin;
+
+  chunk[0] = (unsigned char *)malloc( maxRecords * blockSize );
+  chunk[1] = (unsigned char *)malloc( maxRecords * blockSize );
+  if ( !chunk[0] || !chunk[1] ) {
+    fprintf(stderr, "error allocating chunk buffers of %lu bytes!\n", (unsigned long)( maxRecords * blockSize ));
+    exit(10);
+  }
+
+  if ( !tmpDir )
+    tmpDir = getenv("TMPDIR");
+  if ( !tmpDir || !tmpDir[0] )
+    tmpDir = "/tmp";
+  tmpName = (char *)malloc( strlen(tmpDir) + 32 );
+
+  while ( (n = readChunk( chunk[0], maxRecords, inputs, numInputs, &currInput )) > 0 ) {
+    numTotal += n;
+    sortChunk( chunk[0], chunk[1], n );
+
+    if ( !numRuns && currInput >= numInputs )
+      break;  /* everything fits into memory */
+
+    /* spill sorted run to temporary file */
+    {
+      int fd;
+      FILE * fp;
+      sprintf( tmpName, "%s/srdssort-XXXXXX", tmpDir );
+      fd = mkstemp( tmpName );
+      if ( fd < 0 || !(fp = fdopen( fd, "w+b" )) ) {
+        fprintf(stderr, "error creating temporary file in '%s'!\n", tmpDir);
+        exit(8);
+      }
+      unlink( tmpName );  /* removed automatically on close/exit */
+      if ( writeRecords( fp, chunk[1], n ) || fflush(fp) || fseeko(fp, 0, SEEK_SET) ) {
+        fprintf(stderr, "error writing temporary file in '%s'!\n", tmpDir);
+        exit(8);
+      }
+      if ( numRuns >= maxRuns ) {
+        maxRuns = maxRuns ? 2 * maxRuns : 16;
+        runs = (FILE **)realloc( runs, maxRuns * sizeof(FILE *) );
+      }
+      runs[numRuns++] = fp;
+      if (verboseFlag)
+        fprintf(stderr, "spilled run %d with %lu raw data sets\n", numRuns, (unsigned long)n);
+    }
+  }
+
+  if ( outfn )
+  {
+    out = fopen(outfn, "wb");
+    if (!out) {
+      fputs("error opening output file!\n", stderr);
+      exit(8);
+    }
+  }
+
+  wrBuffer = malloc( bufferSize );
+  if (wrBuffer) setbuffer( out, wrBuffer, bufferSize );
+
+  if ( !numRuns ) {
+    if ( writeRecords( out, chunk[1], n ) ) {
+      fputs("error writing to output file!\n", stderr);
+      exit(7);
+    }
+  }
+  else {
+    free( chunk[0] );
+    free( chunk[1] );
+    if ( mergeRuns( out, numRuns, bufferSize ) ) {
+      fputs("error writing to output file!\n", stderr);
+      exit(7);
+    }
+  }
+
+  if ( fflush(out) ) {
+    fputs("error writing to output file!\n", stderr);
+    exit(7);
+  }
+
+  if (verboseFlag)
+    fprintf(stderr, "sorted %llu raw data sets\n", numTotal);
+
+  if ( out != stdout ) {
+    fclose(out);
+    free( wrBuffer );
+  }
+
+  return 0;
+}
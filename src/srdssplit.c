@@ -0,0 +1,288 @@
+/*
+ * srdssplit (sorted raw data set split)
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * srdssplit splits a sorted raw data set file into N shards of (nearly)
+ * equal size - at boundaries of the leading 'prefixBits' bits of the key.
+ * a manifest with each shard's prefix range and path is written,
+ * which srdsgrep -S uses to route each key directly to its shard, see srdsshard.h.
+ * shards can be distributed round robin over several directories (disks).
+ * the key must start at offset 0 of each block.
+ *
+ * Usage: see below at usage()
+ *
+ * Author:  Hayati Ayguen
+ */
+
+/* large file support */
+
+#ifdef _AIX
+#define _LARGE_FILES
+#else
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include <sys/stat.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <limits.h>
+
+#include "srdsshard.h"
+
+#define MAXDIRS    64
+#define MAXSHARDS  4096
+
+static int blockSize = 20;
+static int prefixBits = 16;
+
+
+/* prefix of record r */
+static
+int readPrefix( FILE * fp, uint64_t r, uint32_t * prefix )
+{
+  unsigned char key[4];
+  const int n = ( blockSize < 4 ) ? blockSize : 4;
+  if ( fseeko( fp, (off_t)( r * blockSize ), SEEK_SET ) || fread( key, n, 1, fp ) != 1 )
+    return -1;
+  *prefix = keyPrefix( key, n, prefixBits, 0 );
+  return 0;
+}
+
+/* number of the first record in [ lo, hi ) with prefix > p */
+static
+int upperBound( FILE * fp, uint64_t lo, uint64_t hi, uint32_t p, uint64_t * result )
+{
+  while ( lo < hi ) {
+    const uint64_t mid = lo + ( hi - lo ) / 2;
+    uint32_t q;
+    if ( readPrefix( fp, mid, &q ) )
+      return -1;
+    if ( q <= p )
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  *result = lo;
+  return 0;
+}
+
+/* copies records [ first, last ) to file fn. returns 0 on success */
+static
+int copyRecords( FILE * inp, uint64_t first, uint64_t last, const char * fn, unsigned char * buf, size_t bufSize )
+{
+  FILE * out = fopen( fn, "wb" );
+  uint64_t rem = ( last - first ) * blockSize;
+  int ret = 0;
+  if ( !out ) {
+    fprintf(stderr, "error opening output file '%s'\n", fn);
+    return 10;
+  }
+  if ( fseeko( inp, (off_t)( first * blockSize ), SEEK_SET ) )
+    ret = 9;
+  while ( !ret && rem ) {
+    const size_t n = ( rem < bufSize ) ? (size_t)rem : bufSize;
+    if ( fread( buf, 1, n, inp ) != n ) {
+      fprintf(stderr, "error reading from input!\n");
+      ret = 9;
+    }
+    else if ( fwrite( buf, 1, n, out ) != n ) {
+      fprintf(stderr, "error writing to output file '%s'!\n", fn);
+      ret = 8;
+    }
+    rem -= n;
+  }
+  if ( fclose( out ) && !ret ) {
+    fprintf(stderr, "error writing to output file '%s'!\n", fn);
+    ret = 8;
+  }
+  return ret;
+}
+
+/* path of shard file as written into the manifest: relative to the manifest's directory - or absolute */
+static
+void manifestPath( const char * manifestFn, const char * fn, char * out )
+{
+  const char * slash = strrchr( manifestFn, '/' );
+  const size_t dirLen = slash ? (size_t)( slash - manifestFn + 1 ) : 0;
+  char abs[PATH_MAX];
+  if ( ( dirLen || fn[0] != '/' ) && !strncmp( fn, manifestFn, dirLen ) )
+    strcpy( out, fn + dirLen );
+  else if ( fn[0] != '/' && realpath( fn, abs ) )
+    strcpy( out, abs );
+  else
+    strcpy( out, fn );
+}
+
+
+static
+void usage() {
+  fputs("Usage: srdssplit [-v][-h][-l <blockLength>][-n <shards>][-p <prefixBits>][-B <bufferSize>]\n", stderr);
+  fputs("                 [-d <directory>]* [-m <manifest>] -o <outputBase> <sorted_file>\n", stderr);
+  fputs("  splits a sorted raw data set into shards of key ranges at prefix boundaries\n", stderr);
+  fputs("  and writes a manifest for srdsgrep -S. the key must start at offset 0\n", stderr);
+  fputs("  -v     verbose output\n", stderr);
+  fputs("  -h     print usage\n",stderr);
+  fputs("  -l <v> length of each raw data set block in bytes. default: 20\n", stderr);
+  fputs("  -n <v> number of shards. default: 2\n", stderr);
+  fputs("  -p <v> number of key prefix bits, at which shards are split. default: 16. maximum: 32\n", stderr);
+  fputs("  -B <v> bufferSize in kBytes. default: 1024\n", stderr);
+  fputs("  -d <d> put shards into directory. can be given multiple times: shards are distributed round robin\n", stderr);
+  fputs("  -m <f> manifest file. default: <outputBase>.manifest\n", stderr);
+  fputs("  -o <f> output base name. shards are named <outputBase>.000, <outputBase>.001, ..\n", stderr);
+}
+
+
+int main(int argc, char *argv[])
+{
+  FILE * inp = NULL;
+  FILE * mf = NULL;
+  const char * outBase = NULL;
+  const char * manifestFn = NULL;
+  const char * dirs[MAXDIRS];
+  char defManifest[PATH_MAX];
+  char fn[PATH_MAX], mpath[PATH_MAX];
+  int numDirs = 0, numShards = 2;
+  int helpFlag = 0, verboseFlag = 0;
+  int optFlag, ret = 0, k;
+  size_t bufSize = 1024 * 1024;
+  unsigned char * buf = NULL;
+  uint64_t n, start;
+  uint32_t firstPrefix, maxPrefix;
+  struct SrdsShard * shards = NULL;
+  int written = 0;
+  struct stat st;
+  extern int optind;
+
+  /* parse command line options */
+  while ((optFlag = getopt(argc, argv, "vhl:n:p:B:d:m:o:")) > 0 && optFlag != '?') {
+    switch(optFlag) {
+    case 'v': ++verboseFlag; break;
+    case 'h': ++helpFlag; break;
+    case 'l': blockSize = atoi(optarg); break;
+    case 'n': numShards = atoi(optarg); break;
+    case 'p': prefixBits = atoi(optarg); break;
+    case 'B': bufSize = (size_t)( atol(optarg) * 1024 ); break;
+    case 'd':
+      if ( numDirs >= MAXDIRS ) {
+        fprintf(stderr, "error: maximum number of directories is %d!\n", MAXDIRS);
+        return 10;
+      }
+      dirs[numDirs++] = optarg;
+      break;
+    case 'm': manifestFn = optarg; break;
+    case 'o': outBase = optarg; break;
+    }
+  }
+  if (optFlag == '?' || helpFlag || !outBase || optind + 1 != argc) {
+    usage();
+    exit(2);
+  }
+
+  if ( blockSize <= 0 || prefixBits <= 0 || prefixBits > 32 || prefixBits > 8 * blockSize
+       || numShards <= 0 || numShards > MAXSHARDS || bufSize < (size_t)blockSize ) {
+    fprintf(stderr, "error: invalid blockSize %d, prefixBits %d or number of shards %d!\n", blockSize, prefixBits, numShards);
+    return 10;
+  }
+  if ( !manifestFn ) {
+    snprintf( defManifest, sizeof(defManifest), "%s.manifest", outBase );
+    manifestFn = defManifest;
+  }
+
+  inp = fopen( argv[optind], "rb" );
+  if ( !inp || fstat( fileno(inp), &st ) || !S_ISREG(st.st_mode) ) {
+    fprintf(stderr, "error opening input file '%s' - must be a regular file\n", argv[optind]);
+    return 10;
+  }
+  if ( st.st_size % blockSize )
+    fprintf(stderr, "warning: input has %u trailing bytes - not a multiple of blockSize %d!\n", (unsigned)( st.st_size % blockSize ), blockSize);
+  n = (uint64_t)st.st_size / blockSize;
+
+  buf = (unsigned char *)malloc( bufSize );
+  shards = (struct SrdsShard *)calloc( numShards, sizeof(struct SrdsShard) );
+  if ( !buf || !shards ) {
+    fprintf(stderr, "error allocating buffers!\n");
+    return 10;
+  }
+
+  maxPrefix = (uint32_t)( ( (uint64_t)1 << prefixBits ) - 1 );
+  for ( k = 0, start = 0, firstPrefix = 0; k < numShards && !ret; ++k ) {
+    uint64_t end = n;
+    uint32_t lastPrefix = maxPrefix;
+    const char * base = strrchr( outBase, '/' );
+
+    if ( k < numShards - 1 ) {
+      /* end at the prefix of the record at the target size */
+      uint64_t t = ( k + 1 ) * n / numShards;
+      if ( t <= start )
+        t = start + 1;
+      if ( t > n || readPrefix( inp, t - 1, &lastPrefix ) || upperBound( inp, t, n, lastPrefix, &end ) ) {
+        if ( t <= n ) {
+          fprintf(stderr, "error reading from input!\n");
+          ret = 9;
+          break;
+        }
+        end = n;
+        lastPrefix = maxPrefix;
+      }
+    }
+    if ( lastPrefix == maxPrefix )
+      end = n;
+
+    if ( numDirs )
+      snprintf( fn, sizeof(fn), "%s/%s.%03d", dirs[k % numDirs], base ? base + 1 : outBase, k );
+    else
+      snprintf( fn, sizeof(fn), "%s.%03d", outBase, k );
+    ret = copyRecords( inp, start, end, fn, buf, bufSize );
+
+    shards[k].first = firstPrefix;
+    shards[k].last = lastPrefix;
+    shards[k].numRecords = end - start;
+    shards[k].path = strdup( fn );
+    ++written;
+    if (verboseFlag)
+      fprintf(stderr, "shard %d: prefixes %X .. %X with %llu records to '%s'\n",
+              k, firstPrefix, lastPrefix, (unsigned long long)( end - start ), fn);
+    start = end;
+    if ( lastPrefix == maxPrefix )
+      break;
+    firstPrefix = lastPrefix + 1;
+  }
+  if ( !ret && written < numShards )
+    fprintf(stderr, "warning: only %d shards: not enough distinct prefixes at %d prefix bits\n", written, prefixBits);
+
+  if ( !ret ) {
+    mf = fopen( manifestFn, "w" );
+    if ( !mf ) {
+      fprintf(stderr, "error opening manifest file '%s'\n", manifestFn);
+      ret = 10;
+    }
+  }
+  if ( !ret ) {
+    fprintf( mf, "# srds shard manifest from srdssplit of '%s'\n", argv[optind] );
+    fprintf( mf, "blockSize=%d\n", blockSize );
+    fprintf( mf, "prefixBits=%d\n", prefixBits );
+    fprintf( mf, "shards=%d\n", written );
+    for ( k = 0; k < written; ++k ) {
+      manifestPath( manifestFn, shards[k].path, mpath );
+      fprintf( mf, "shard=%0*X %0*X %llu %s\n", ( prefixBits + 3 ) / 4, shards[k].first,
+               ( prefixBits + 3 ) / 4, shards[k].last, shards[k].numRecords, mpath );
+    }
+    if ( fclose( mf ) ) {
+      fprintf(stderr, "error writing manifest file '%s'\n", manifestFn);
+      ret = 8;
+    }
+  }
+
+  for ( k = 0; k < written; ++k )
+    free( shards[k].path );
+  free( shards );
+  free( buf );
+  fclose( inp );
+  return ret;
+}
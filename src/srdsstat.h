@@ -0,0 +1,265 @@
+/*
+ * srdsstat.h
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * telemetry of the bulk tools (options -P and -J):
+ * periodic progress lines to stderr - records, bytes, MB/s and ETA, if the
+ * input size is known - and a final summary as JSON with the wall time split
+ * into read, process and write phases, CPU times and peak RSS.
+ *
+ * read and write time is measured at the system calls: the tool's FILE streams
+ * are wrapped with fopencookie(), so buffered per record fread()/fwrite() calls
+ * cost nothing extra. process time is the remainder of the wall time -
+ * or measured explicitly by multithreaded tools (summed over threads).
+ * the tool must define _GNU_SOURCE for fopencookie(). without,
+ * streams are not wrapped: all time counts as processing.
+ *
+ * Author:  Hayati Ayguen
+ */
+
+#ifndef SRDSSTAT_H
+#define SRDSSTAT_H
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+
+enum { SRDSSTAT_READ = 0, SRDSSTAT_PROCESS, SRDSSTAT_WRITE };
+
+struct SrdsStat {
+  const char * tool;
+  int enabled;
+  int processMeasured;      /* phase[SRDSSTAT_PROCESS] is measured by the tool */
+  double interval;          /* seconds between progress lines. 0 for none */
+  double start;
+  double nextReport;
+  double phase[3];          /* seconds */
+  uint64_t records;
+  uint64_t bytesIn;
+  uint64_t bytesOut;
+  uint64_t totalIn;         /* size of regular input files. 0 if unknown */
+};
+
+/* wrapped stream */
+struct SrdsStatCookie {
+  struct SrdsStat * s;
+  FILE * fp;                /* original stream - closed with the wrapper, except stdin/stdout */
+  int fd;
+};
+
+static inline
+double srdsStatNow()
+{
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return (double)ts.tv_sec + 1E-9 * (double)ts.tv_nsec;
+}
+
+static
+void srdsStatInit( struct SrdsStat * s, const char * tool, double interval, int enabled )
+{
+  memset( s, 0, sizeof(*s) );
+  s->tool = tool;
+  s->enabled = enabled;
+  s->interval = interval;
+  s->start = srdsStatNow();
+  s->nextReport = s->start + interval;
+}
+
+/* add seconds to phase - from any thread */
+static inline
+void srdsStatAddPhase( struct SrdsStat * s, int phase, double seconds )
+{
+  /* double has no atomic add: phases are updated by a single thread each - or under the tool's lock */
+  s->phase[phase] += seconds;
+}
+
+static
+void srdsStatProgressLine( struct SrdsStat * s, double now )
+{
+  const uint64_t in = __atomic_load_n( &s->bytesIn, __ATOMIC_RELAXED );
+  const double elapsed = now - s->start;
+  const double rate = elapsed > 0.0 ? (double)in / elapsed : 0.0;
+  fprintf(stderr, "%s: %llu records, %.1f MB in, %.1f MB out, %.1f MB/s",
+          s->tool, (unsigned long long)__atomic_load_n( &s->records, __ATOMIC_RELAXED ),
+          1E-6 * (double)in, 1E-6 * (double)__atomic_load_n( &s->bytesOut, __ATOMIC_RELAXED ), 1E-6 * rate);
+  if ( s->totalIn && in && in <= s->totalIn ) {
+    const long eta = (long)( elapsed * (double)( s->totalIn - in ) / (double)in + 0.5 );
+    fprintf(stderr, ", %.1f %%, ETA %ld:%02ld:%02ld", 100.0 * (double)in / (double)s->totalIn,
+            eta / 3600, ( eta / 60 ) % 60, eta % 60);
+  }
+  fputc('\n', stderr);
+}
+
+/* count processed records - and print progress, when due. call per batch of records - from any thread */
+static inline
+void srdsStatRecords( struct SrdsStat * s, uint64_t n )
+{
+  double now, next, due;
+  if ( !s->enabled )
+    return;
+  __atomic_add_fetch( &s->records, n, __ATOMIC_RELAXED );
+  if ( s->interval <= 0.0 )
+    return;
+  now = srdsStatNow();
+  __atomic_load( &s->nextReport, &next, __ATOMIC_RELAXED );
+  if ( now < next )
+    return;
+  /* only the thread, which moves nextReport on, prints the progress line */
+  due = now + s->interval;
+  if ( __atomic_compare_exchange( &s->nextReport, &next, &due, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+    srdsStatProgressLine( s, now );
+}
+
+/* add size of fp to the known input size - if it is a regular file */
+static
+void srdsStatInputSize( struct SrdsStat * s, FILE * fp )
+{
+  struct stat st;
+  if ( s->enabled && !fstat( fileno(fp), &st ) && S_ISREG(st.st_mode) )
+    s->totalIn += (uint64_t)st.st_size;
+}
+
+#if defined(__GLIBC__) && defined(_GNU_SOURCE)
+
+static
+ssize_t srdsStatCookieRead( void * c, char * buf, size_t n )
+{
+  struct SrdsStatCookie * k = (struct SrdsStatCookie *)c;
+  const double t = srdsStatNow();
+  ssize_t r;
+  do
+    r = read( k->fd, buf, n );
+  while ( r < 0 && errno == EINTR );
+  srdsStatAddPhase( k->s, SRDSSTAT_READ, srdsStatNow() - t );
+  if ( r > 0 )
+    __atomic_add_fetch( &k->s->bytesIn, (uint64_t)r, __ATOMIC_RELAXED );
+  return r;
+}
+
+static
+ssize_t srdsStatCookieWrite( void * c, const char * buf, size_t n )
+{
+  struct SrdsStatCookie * k = (struct SrdsStatCookie *)c;
+  const double t = srdsStatNow();
+  size_t done = 0;
+  while ( done < n ) {
+    const ssize_t w = write( k->fd, buf + done, n - done );
+    if ( w < 0 && errno == EINTR )
+      continue;
+    if ( w <= 0 )
+      break;
+    done += (size_t)w;
+  }
+  srdsStatAddPhase( k->s, SRDSSTAT_WRITE, srdsStatNow() - t );
+  __atomic_add_fetch( &k->s->bytesOut, (uint64_t)done, __ATOMIC_RELAXED );
+  return ( done || !n ) ? (ssize_t)done : -1;
+}
+
+static
+int srdsStatCookieClose( void * c )
+{
+  struct SrdsStatCookie * k = (struct SrdsStatCookie *)c;
+  int ret = 0;
+  if ( k->fp != stdin && k->fp != stdout )
+    ret = fclose( k->fp );
+  free( k );
+  return ret;
+}
+
+/*
+ * returns a stream, which measures the read or write system calls of fp.
+ * call before any I/O on fp - and before setbuffer(). closing the returned
+ * stream closes fp - except stdin and stdout.
+ */
+static
+FILE * srdsStatWrap( struct SrdsStat * s, FILE * fp, int forWrite )
+{
+  cookie_io_functions_t io;
+  struct SrdsStatCookie * k;
+  FILE * w;
+  if ( !s->enabled || !fp )
+    return fp;
+  k = (struct SrdsStatCookie *)malloc( sizeof(*k) );
+  if ( !k )
+    return fp;
+  k->s = s;
+  k->fp = fp;
+  k->fd = fileno( fp );
+  memset( &io, 0, sizeof(io) );
+  if ( forWrite )
+    io.write = srdsStatCookieWrite;
+  else
+    io.read = srdsStatCookieRead;
+  io.close = srdsStatCookieClose;
+  w = fopencookie( k, forWrite ? "w" : "r", io );
+  if ( !w ) {
+    free( k );
+    return fp;
+  }
+  return w;
+}
+
+#else
+
+static
+FILE * srdsStatWrap( struct SrdsStat * s, FILE * fp, int forWrite )
+{
+  (void)s;
+  (void)forWrite;
+  return fp;
+}
+
+#endif
+
+/* prints final progress line and writes the JSON summary to file fn - '-' for stderr. returns 0 on success */
+static
+int srdsStatSummary( struct SrdsStat * s, const char * fn, int status )
+{
+  const double now = srdsStatNow();
+  const double wall = now - s->start;
+  double process = s->processMeasured ? s->phase[SRDSSTAT_PROCESS]
+                   : wall - s->phase[SRDSSTAT_READ] - s->phase[SRDSSTAT_WRITE];
+  struct rusage ru;
+  FILE * f;
+  int ret = 0;
+
+  if ( !s->enabled )
+    return 0;
+  if ( s->interval > 0.0 )
+    srdsStatProgressLine( s, now );
+  if ( !fn )
+    return 0;
+  if ( process < 0.0 )
+    process = 0.0;
+  memset( &ru, 0, sizeof(ru) );
+  getrusage( RUSAGE_SELF, &ru );
+
+  f = strcmp( fn, "-" ) ? fopen( fn, "w" ) : stderr;
+  if ( !f )
+    return -1;
+  fprintf(f, "{\"tool\":\"%s\",\"status\":%d,\"records\":%llu,\"bytes_in\":%llu,\"bytes_out\":%llu,\"input_size\":%llu,",
+          s->tool, status, (unsigned long long)s->records, (unsigned long long)s->bytesIn,
+          (unsigned long long)s->bytesOut, (unsigned long long)s->totalIn);
+  fprintf(f, "\"wall_s\":%.6f,\"read_s\":%.6f,\"process_s\":%.6f,\"write_s\":%.6f,",
+          wall, s->phase[SRDSSTAT_READ], process, s->phase[SRDSSTAT_WRITE]);
+  fprintf(f, "\"cpu_user_s\":%.6f,\"cpu_sys_s\":%.6f,\"mb_per_s\":%.3f,\"peak_rss_kb\":%ld}\n",
+          (double)ru.ru_utime.tv_sec + 1E-6 * (double)ru.ru_utime.tv_usec,
+          (double)ru.ru_stime.tv_sec + 1E-6 * (double)ru.ru_stime.tv_usec,
+          wall > 0.0 ? 1E-6 * (double)s->bytesIn / wall : 0.0, (long)ru.ru_maxrss);
+  if ( f != stderr && fclose( f ) )
+    ret = -1;
+  return ret;
+}
+
+#endif /* SRDSSTAT_H */
@@ -0,0 +1,277 @@
+/*
+ * srdstree.h
+ *
+ * Copyright 2026 Hayati Ayguen.  Distributed under the terms
+ * of the GNU General Public License (GPL)
+ *
+ * static search tree layout of a sorted raw data set (srds) - from srds2tree:
+ * the records stay in sorted order - as leaves of leafRecords records,
+ * which fill one 4 kB page. only the leading 64 bits (big endian) of the
+ * first record of each leaf (except the first leaf) are keys of the tree.
+ *
+ * the tree is a static B+ tree (S+ tree) with nodeKeys keys per node - see
+ * https://en.algorithmica.org/hpc/data-structures/s-tree/ :
+ * layer 0 holds all keys in sorted order, each upper layer the first key of
+ * each node's right siblings. the children of node k are at k * ( nodeKeys + 1 ) + i
+ * of the next lower layer - no pointers are stored. nodes of 8 or 16 keys
+ * are one or two cache lines, 512 keys are one page.
+ * a lookup reads one node per layer - and one or two leaves.
+ *
+ * file format - header little endian, nodes as uint64 in host byte order (little endian):
+ *   8 bytes   magic "SRDSTRE1"
+ *   4 bytes   blockSize
+ *   4 bytes   nodeKeys
+ *   8 bytes   number of records
+ *   8 bytes   leafRecords: number of records per leaf
+ *   8 bytes   dataOffset: file offset of the records
+ *   zero padding up to 4 kB
+ *   uint64    layers of nodes: layer 0 first, the root layer last
+ *   zero padding up to dataOffset: a multiple of blockSize and 4 kB
+ *   records   in ascending order - as in the srds
+ *
+ * the nodes are mmap()ed for lookups.
+ *
+ * Author:  Hayati Ayguen
+ */
+
+#ifndef SRDSTREE_H
+#define SRDSTREE_H
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "srdsindex.h"
+
+#define SRDSTREE_MAGIC        "SRDSTRE1"
+#define SRDSTREE_HEADER_SIZE  4096
+#define SRDSTREE_PAGE         4096
+#define SRDSTREE_MAX_HEIGHT   32
+
+struct SrdsTree {
+  void * base;
+  size_t size;
+  int blockSize;
+  int nodeKeys;
+  int height;
+  uint64_t numRecords;
+  uint64_t leafRecords;
+  uint64_t numKeys;         /* number of leaves - 1 */
+  uint64_t dataOffset;
+  uint64_t layer[SRDSTREE_MAX_HEIGHT + 1];  /* offset of each layer in keys */
+  const uint64_t * nodes;
+};
+
+
+static inline
+uint64_t srdsTreeLeafRecords( int blockSize )
+{
+  return ( blockSize < SRDSTREE_PAGE ) ? (uint64_t)( SRDSTREE_PAGE / blockSize ) : 1;
+}
+
+/* nodes of n keys in the layer */
+static inline
+uint64_t srdsTreeBlocks( uint64_t n, int B )  { return ( n + B - 1 ) / B; }
+
+/* keys of the next upper layer: one per child - except the first */
+static inline
+uint64_t srdsTreePrevKeys( uint64_t n, int B )  { return ( srdsTreeBlocks( n, B ) + B ) / ( B + 1 ) * B; }
+
+/* sets numKeys, height and layer offsets from numRecords, leafRecords and nodeKeys */
+static
+int srdsTreeLayout( struct SrdsTree * t )
+{
+  const int B = t->nodeKeys;
+  const uint64_t numLeaves = ( t->numRecords + t->leafRecords - 1 ) / t->leafRecords;
+  uint64_t n;
+  int h;
+
+  t->numKeys = numLeaves ? numLeaves - 1 : 0;
+  t->layer[0] = 0;
+  n = t->numKeys;
+  for ( h = 0; h < SRDSTREE_MAX_HEIGHT; ++h ) {
+    t->layer[h + 1] = t->layer[h] + srdsTreeBlocks( n, B ) * B;
+    if ( n <= (uint64_t)B ) {
+      t->height = h + 1;
+      return 0;
+    }
+    n = srdsTreePrevKeys( n, B );
+  }
+  return -1;
+}
+
+/* file offset of the records: behind the nodes - aligned to blockSize and page */
+static inline
+uint64_t srdsTreeDataOffset( const struct SrdsTree * t )
+{
+  uint64_t a = SRDSTREE_PAGE, b = (uint64_t)t->blockSize, align;
+  const uint64_t end = SRDSTREE_HEADER_SIZE + 8 * t->layer[t->height];
+  while ( b ) {
+    const uint64_t r = a % b;
+    a = b;
+    b = r;
+  }
+  align = SRDSTREE_PAGE / a * (uint64_t)t->blockSize;  /* least common multiple */
+  return ( end + align - 1 ) / align * align;
+}
+
+/*
+ * fills the nodes - with layer 0 already holding the sorted keys.
+ * unused keys are UINT64_MAX
+ */
+static
+void srdsTreeBuild( const struct SrdsTree * t, uint64_t * nodes )
+{
+  const uint64_t B = (uint64_t)t->nodeKeys;
+  uint64_t i, k;
+  int h, l;
+
+  for ( i = t->numKeys; i < t->layer[1]; ++i )
+    nodes[i] = UINT64_MAX;
+  for ( h = 1; h < t->height; ++h ) {
+    for ( i = 0; i < t->layer[h + 1] - t->layer[h]; ++i ) {
+      /* first key of the subtree right of key i: its leftmost key in layer 0 */
+      k = ( i / B ) * ( B + 1 ) + ( i % B ) + 1;
+      for ( l = 1; l < h; ++l )
+        k *= B + 1;
+      nodes[ t->layer[h] + i ] = ( k * B < t->numKeys ) ? nodes[ k * B ] : UINT64_MAX;
+    }
+  }
+}
+
+static
+int srdsTreeWriteHeader( const struct SrdsTree * t, FILE * fp )
+{
+  unsigned char h[SRDSTREE_HEADER_SIZE];
+  memset( h, 0, sizeof(h) );
+  memcpy( h, SRDSTREE_MAGIC, 8 );
+  putLE32( h + 8, (uint32_t)t->blockSize );
+  putLE32( h + 12, (uint32_t)t->nodeKeys );
+  putLE64( h + 16, t->numRecords );
+  putLE64( h + 24, t->leafRecords );
+  putLE64( h + 32, t->dataOffset );
+  return fwrite( h, SRDSTREE_HEADER_SIZE, 1, fp ) == 1 ? 0 : -1;
+}
+
+/* checks the magic at start of file - without moving the file position */
+static
+int srdsTreeDetect( int fd )
+{
+  char m[8];
+  return pread( fd, m, 8, 0 ) == 8 && !memcmp( m, SRDSTREE_MAGIC, 8 );
+}
+
+/* maps the nodes of the opened file. returns 0 on success */
+static
+int srdsTreeOpen( struct SrdsTree * t, int fd )
+{
+  unsigned char h[40];
+  struct stat st;
+
+  memset( t, 0, sizeof(*t) );
+  if ( pread( fd, h, 40, 0 ) != 40 || memcmp( h, SRDSTREE_MAGIC, 8 ) || fstat( fd, &st ) )
+    return -1;
+  t->blockSize = (int)getLE32( h + 8 );
+  t->nodeKeys = (int)getLE32( h + 12 );
+  t->numRecords = getLE64( h + 16 );
+  t->leafRecords = getLE64( h + 24 );
+  t->dataOffset = getLE64( h + 32 );
+  if ( t->blockSize <= 0 || t->nodeKeys <= 0 || !t->leafRecords
+       || srdsTreeLayout( t ) || t->dataOffset != srdsTreeDataOffset( t )
+       || (uint64_t)st.st_size != t->dataOffset + t->numRecords * t->blockSize )
+    return -1;
+  t->size = (size_t)t->dataOffset;
+  t->base = mmap( NULL, t->size, PROT_READ, MAP_SHARED, fd, 0 );
+  if ( t->base == MAP_FAILED ) {
+    t->base = NULL;
+    return -1;
+  }
+  t->nodes = (const uint64_t *)( (const unsigned char *)t->base + SRDSTREE_HEADER_SIZE );
+  return 0;
+}
+
+static
+void srdsTreeClose( struct SrdsTree * t )
+{
+  if ( t->base )
+    munmap( t->base, t->size );
+  t->base = NULL;
+}
+
+/* number of keys < x in the node */
+static inline
+uint64_t srdsTreeNodeRank( const uint64_t * node, int B, uint64_t x )
+{
+  uint64_t i = 0;
+  int j, n = B;
+  if ( B <= 64 ) {
+    /* branchless - vectorizable */
+    for ( j = 0; j < B; ++j )
+      i += ( node[j] < x );
+    return i;
+  }
+  /* page sized nodes: binary search */
+  while ( n > 0 ) {
+    j = n / 2;
+    if ( node[ i + j ] < x ) {
+      i += j + 1;
+      n -= j + 1;
+    }
+    else
+      n = j;
+  }
+  return i;
+}
+
+/* number of keys < x: walks from the root - prefetching the child's cache lines */
+static inline
+uint64_t srdsTreeRank( const struct SrdsTree * t, uint64_t x )
+{
+  const uint64_t B = (uint64_t)t->nodeKeys;
+  uint64_t k = 0, i;
+  int h;
+
+  if ( !t->numKeys )
+    return 0;
+  for ( h = t->height - 1; h > 0; --h ) {
+    i = srdsTreeNodeRank( t->nodes + t->layer[h] + k * B, t->nodeKeys, x );
+    k = k * ( B + 1 ) + i;
+    {
+      /* each node's lines are needed together: request all - not one after the other */
+      const char * child = (const char *)( t->nodes + t->layer[h - 1] + k * B );
+      uint64_t line;
+      for ( line = 0; line < 8 * B && line < 256; line += 64 )
+        __builtin_prefetch( child + line );
+    }
+  }
+  i = k * B + srdsTreeNodeRank( t->nodes + k * B, t->nodeKeys, x );
+  return ( i < t->numKeys ) ? i : t->numKeys;
+}
+
+/*
+ * range of records [ *first, *last ), which holds all records starting with key.
+ * keyLen might be shorter than 8 bytes
+ */
+static
+void srdsTreeLookup( const struct SrdsTree * t, const unsigned char * key, int keyLen,
+                     uint64_t * first, uint64_t * last )
+{
+  const uint64_t lo = keyPrefix64( key, keyLen, 0x00 );
+  const uint64_t hi = keyPrefix64( key, keyLen, 0xFF );
+  /* leaves 1 .. p start below lo: the first match is in leaf p or later */
+  const uint64_t p = srdsTreeRank( t, lo );
+  /* leaves 1 .. q start at or below hi: the last match is in leaf q or before */
+  const uint64_t q = ( hi == UINT64_MAX ) ? t->numKeys : srdsTreeRank( t, hi + 1 );
+  *first = p * t->leafRecords;
+  *last = ( q + 1 ) * t->leafRecords;
+  if ( *last > t->numRecords )
+    *last = t->numRecords;
+  if ( *first > *last )
+    *first = *last;
+}
+
+#endif /* SRDSTREE_H */
@@ -0,0 +1,100 @@
+#!/bin/bash
+
+# throughput benchmark of the bulk tools: hex2rds, srdsmerge, srdscheck and srdshashencode
+# over buffer sizes, record widths, thread counts and number of merge inputs.
+# synthetic input is generated deterministically with srdsgen.
+# each measurement is a row in bench.csv and bench.json of the data directory -
+# compare the files of two builds, e.g. with 'join' or a spreadsheet.
+#
+# usage: bench.sh [-b <bindir>] [-d <datadir>] [-n <records>] [-r <repetitions>] [-p] [-t <tag>]
+#   -b  directory with the built tools. default: tools from PATH
+#   -d  directory for generated data and results. default: ./bench
+#   -n  number of records per input. default: 1000000
+#   -r  repetitions per measurement - the fastest is reported. default: 3
+#   -p  read hardware counters with perf_event_open()
+#   -t  tag prepended to each label, e.g. the build's git revision
+
+N=1000000
+REPS=3
+PERF=""
+TAG=""
+DATA="bench"
+
+while getopts "b:d:n:r:pt:" opt; do
+  case ${opt} in
+    b) export PATH="$(cd "${OPTARG}" && pwd):${PATH}" ;;
+    d) DATA="${OPTARG}" ;;
+    n) N="${OPTARG}" ;;
+    r) REPS="${OPTARG}" ;;
+    p) PERF="-p" ;;
+    t) TAG="${OPTARG} " ;;
+    *) sed -n '3,16p' "$0" ; exit 2 ;;
+  esac
+done
+
+WIDTHS="16 20 32"
+BUFFERS="64 1024 8192"
+THREADS="1 2 4"
+INPUTS="2 4 8 16"
+
+mkdir -p "${DATA}" || exit 10
+cd "${DATA}" || exit 10
+CSV="$(pwd)/bench.csv"
+JSON="$(pwd)/bench.json"
+
+size() {
+  stat -c %s "$@" | awk '{ s += $1 } END { print s }'
+}
+
+# bench <label> <bytes> <records> command [args]
+bench() {
+  local label="$1" bytes="$2" records="$3"
+  shift 3
+  echo "${TAG}${label}" >&2
+  srdsbench -r ${REPS} ${PERF} -L "${TAG}${label}" -s ${bytes} -n ${records} -o "${CSV}" -J "${JSON}" -- "$@"
+}
+
+for W in ${WIDTHS} ; do
+  echo "generating ${N} records of ${W} bytes" >&2
+  srdsgen -n ${N} -l ${W} -c -s 1 -o in${W}.txt || exit 10
+  srdsgen -n ${N} -l ${W} -s 1 -o sorted${W}.srds || exit 10
+  for K in ${INPUTS} ; do
+    for (( k = 1; k <= K; ++k )); do
+      srdsgen -n $(( N / K )) -l ${W} -s $(( 1000 * K + k )) -o merge${W}_${K}_${k}.srds || exit 10
+    done
+  done
+
+  TXTSIZE=$(size in${W}.txt)
+  RDSSIZE=$(size sorted${W}.srds)
+
+  for B in ${BUFFERS} ; do
+    for J in ${THREADS} ; do
+      bench "hex2rds w=${W} B=${B} j=${J}" ${TXTSIZE} ${N} \
+        hex2rds -n ${W} -B ${B} -j ${J} -i in${W}.txt -o out.srds
+    done
+    bench "hex2rds w=${W} B=${B} j=1 -c -H" ${TXTSIZE} ${N} \
+      hex2rds -n ${W} -B ${B} -c -H out.hot -i in${W}.txt -o out.srds
+
+    bench "srdscheck w=${W} B=${B}" ${RDSSIZE} ${N} \
+      srdscheck -l ${W} -B ${B} sorted${W}.srds
+
+    bench "srdshashencode w=${W} B=${B} encode" ${RDSSIZE} ${N} \
+      srdshashencode -l ${W} -B ${B} -i sorted${W}.srds -o out.enc
+    bench "srdshashencode w=${W} B=${B} decode" $(size out.enc) ${N} \
+      srdshashencode -l ${W} -B ${B} -d -i out.enc -o out.srds
+    bench "srdshashencode w=${W} B=${B} gap encode" ${RDSSIZE} ${N} \
+      srdshashencode -l ${W} -B ${B} -g -i sorted${W}.srds -o out.gap
+    bench "srdshashencode w=${W} B=${B} gap decode" $(size out.gap) ${N} \
+      srdshashencode -l ${W} -B ${B} -d -i out.gap -o out.srds
+
+    for K in ${INPUTS} ; do
+      FILES=$(for (( k = 1; k <= K; ++k )); do echo merge${W}_${K}_${k}.srds; done)
+      bench "srdsmerge w=${W} B=${B} inputs=${K}" $(size ${FILES}) $(( K * ( N / K ) )) \
+        srdsmerge -l ${W} -B ${B} -o out.srds ${FILES}
+    done
+  done
+
+  rm -f in${W}.txt sorted${W}.srds merge${W}_*.srds out.srds out.hot out.enc out.gap
+done
+
+echo "results in ${CSV} and ${JSON}" >&2
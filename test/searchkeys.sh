@@ -0,0 +1,31 @@
+#!/bin/bash
+
+# helpers for the tests of srdsgrep's search variants - source it after setting PATH
+
+# writeKeys <file> <numRecords> <every> <shortLen> [<numAbsent>]
+# writes every <every>-th key of 'srdsgen -n <numRecords> -l 20 -s 5', <numAbsent> keys
+# not in there, the lowest and the highest key to <file>.
+# the leading <shortLen> hex digits of these keys go to <file>.short
+writeKeys() {
+  srdsgen -n $2 -l 20 -s 5 -x | awk -v e=$3 'NR % e == 1' >$1
+  if [ -n "$5" ]; then
+    srdsgen -n $5 -l 20 -s 77 -x >>$1
+  fi
+  echo "0000000000000000000000000000000000000000" >>$1
+  echo "FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF" >>$1
+  cut -c 1-$4 $1 >$1.short
+}
+
+# sameOutput <label> <reference> <command> ...
+# runs command and prints '<label> identical' when its output equals file <reference>
+sameOutput() {
+  local label="$1" ref="$2"
+  shift 2
+  "$@" | cmp - "$ref" && echo "${label} identical"
+}
+
+# countMatches <srdsgrep options> ...
+# prints how many keys got how many matches with 'srdsgrep -c'
+countMatches() {
+  srdsgrep -c "$@" | awk -F: '{ ++n[$NF] } END { for (c in n) print n[c] " keys with " c " matches" }' | sort -n -k 4
+}
@@ -0,0 +1,26 @@
+#!/bin/bash
+
+source searchkeys.sh
+
+srdsgen -n 100000 -l 20 -s 5 -o a.srds
+srdsmerge -l 20 -o ad.srds a.srds a.srds
+writeKeys a.keys 100000 37 4 1000
+
+echo -e "\n\ntest 1: keys of the data set, which has each record twice, and 1000 other keys - expecting 1002 keys with 0 matches and 2703 keys with 2 matches"
+countMatches -q 64 -l 20 -x -f a.keys ad.srds
+
+for O in "-c" "-X" "-c -m 1" "-X -m 3" ; do
+  srdsgrep ${O} -l 20 -x -f a.keys ad.srds >a.sync
+  srdsgrep ${O} -l 20 -x -f a.keys.short ad.srds >a.syncshort
+  for Q in "-q 64" "-q 1" "-q 64 -Q" ; do
+    echo -e "\n\ntest '${O} ${Q}': expecting same output as synchronous search"
+    sameOutput "keys" a.sync srdsgrep ${O} ${Q} -l 20 -x -f a.keys ad.srds
+    sameOutput "short keys" a.syncshort srdsgrep ${O} ${Q} -l 20 -x -f a.keys.short ad.srds
+  done
+done
+
+echo -e "\n\ntest 2: without key file - expecting error 'needs keys from file' and exit code 2"
+srdsgrep -c -q 64 -l 20 -x 0123 ad.srds
+echo "exit code $?"
+
+rm -f a.srds ad.srds a.keys a.keys.short a.sync a.syncshort
@@ -0,0 +1,33 @@
+#!/bin/bash
+
+source prepare.sh
+
+OPTS="-l 7 -b 3 -e 5"
+
+srdsmerge ${OPTS} -o 12.srds 1.srds 2.srds
+
+# unsorted: key 003 after key 004
+echo -n -e "abc002\n"  >u.srds
+echo -n -e "abc004\n" >>u.srds
+echo -n -e "abc003\n" >>u.srds
+echo -n -e "abc005\n" >>u.srds
+
+echo -e "\n\ntest 1: expected result: 12.srds is sorted (exit code 0)"
+srdscheck ${OPTS} 12.srds
+echo "exit code $?"
+
+echo -e "\n\ntest 2: expected result: u.srds is not sorted at data set 2 (exit code 1)"
+srdscheck -v ${OPTS} u.srds
+echo "exit code $?"
+
+echo -e "\n\ntest 3: expected result: sorted input from stdin (exit code 0)"
+cat 12.srds | srdscheck ${OPTS} -
+echo "exit code $?"
+
+echo -e "\n\ntest 4: expected result: pass-through output is identical to input"
+cat 12.srds | srdscheck ${OPTS} -p | cmp - 12.srds && echo "OK"
+
+echo -e "\n\ntest 5: expected result: pass-through stops at unsorted data set 2 (exit code 1)"
+srdscheck ${OPTS} -p -o p.srds u.srds
+echo "exit code $?"
+cat p.srds
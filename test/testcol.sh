@@ -0,0 +1,30 @@
+#!/bin/bash
+
+source searchkeys.sh
+
+srdsgen -n 100000 -l 20 -s 5 -o c.srds
+srdsmerge -l 20 -o cd.srds c.srds c.srds
+writeKeys c.keys 100000 997 6
+
+echo -e "\n\ntest 1: keys of the data set, which has each record twice - expecting 101 keys with 2 matches and 2 keys with 0 matches"
+srds2col -l 20 -i cd.srds -o cd.col
+countMatches -x -K cd.col -f c.keys cd.srds
+
+for S in 1 0 7 ; do
+  echo -e "\n\ntest S=${S}: keys with duplicates - expecting same output with and without key prefix column"
+  srds2col -v -l 20 -s ${S} -i cd.srds -o cd.col
+  srdsgrep -l 20 -x -f c.keys cd.srds >c.full
+  sameOutput "keys" c.full srdsgrep -x -K cd.col -f c.keys cd.srds
+  srdsgrep -c -l 20 -x -f c.keys.short cd.srds >c.full
+  sameOutput "short keys" c.full srdsgrep -c -x -K cd.col -f c.keys.short cd.srds
+done
+
+echo -e "\n\ntest 2: column of other data - expecting warning 'does not match'"
+srdsgrep -c -x -K cd.col $(head -n 1 c.keys) c.srds
+
+echo -e "\n\ntest 3: unsorted input - expecting error 'not in ascending order' and exit code 1"
+srdsgen -n 100 -l 20 -u | srds2col -o cu.col
+echo "exit code $?"
+ls cu.col 2>/dev/null
+
+rm -f c.srds cd.srds cd.col c.keys c.keys.short c.full
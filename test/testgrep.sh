@@ -58,3 +58,26 @@ cat 1.srds |srdsgrep -c ${OPTS} "005"
 
 echo -e "\n\ntest 11: expected result: 2 matches for 005 with input from pipe"
 srdsgrep -c ${OPTS} "005" <1.srds
+
+echo -e "\n\ntest 12: expected result: 2 matches for 005 - as hexadecimal lines"
+srdsgrep ${OPTS} -X "005" 1.srds
+
+echo -e "\n\ntest 13: expected result: 2 matches for 0123 with prefix bucket index"
+echo -e "0011\n0022\n0123\n0123\n0124\nFF00" | hex2rds -n 2 -I 2.idx -p 12 -m 2.meta -o 2x.srds
+srdsgrep -c -l 2 -I 2.idx -x "0123" 2x.srds
+cat 2.meta
+rm -f 2.idx 2.meta
+
+echo -e "\n\ntest 14: expected result: 2 matches for 0123456789ABCDEF01 with Elias-Fano representation"
+echo -e "00112233445566778800\n0123456789ABCDEF0100\n0123456789ABCDEF0102\n0123456789ABCDEF0200\nFF00000000000000000A" | hex2rds -n 10 -o 3x.srds
+srds2ef -l 10 -r 1 -i 3x.srds -o 3.ef
+srdsgrep -c -x -E 3.ef "0123456789ABCDEF01"
+srdsgrep -X -x -E 3.ef "0123456789ABCDEF01"
+rm -f 3.ef
+
+echo -e "\n\ntest 15: expected result: 1, 3, 0 and 1 matches for the 1 byte keys 00, 01, 02 and FF from key file"
+echo -e "00\n01\n02\nFF" | srdsgrep -c -x -l 10 -f - 3x.srds
+
+echo -e "\n\ntest 16: keys of different length in key file - expecting error 'differs in length' and exit code 2"
+echo -e "01\n0123456789ABCDEF01" | srdsgrep -c -x -l 10 -f - 3x.srds
+echo "exit code $?"
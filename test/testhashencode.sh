@@ -0,0 +1,23 @@
+#!/bin/bash
+
+source prepare.sh
+
+head -c 400000 /dev/urandom | srdssort -l 20 -o r.srds
+
+echo -e "\n\ntest 1: delta encode/decode roundtrip of sorted random data"
+srdshashencode -c -l 20 -i r.srds | srdshashencode -d -l 20 | cmp - r.srds && echo "OK"
+
+echo -e "\n\ntest 2: gap coding roundtrip - expecting less than 20 bytes per data set"
+srdshashencode -g -v -l 20 -i r.srds -o r.gap && srdshashencode -d -l 20 -i r.gap | cmp - r.srds && echo "OK"
+ls -l r.srds r.gap
+
+echo -e "\n\ntest 3: gap coding roundtrip of unsorted data"
+srdshashencode -g -l 7 -i 1.srds | srdshashencode -d -l 7 | cmp - 1.srds && echo "OK"
+
+echo -e "\n\ntest 4: gap coding of 300 byte data sets - expecting error 'requires blockSize <= 256', exit code 10 and no output file"
+rm -f r.gap
+srdshashencode -g -l 300 -i r.srds -o r.gap
+echo "exit code $?"
+ls r.gap 2>/dev/null
+
+rm -f r.gap
@@ -0,0 +1,21 @@
+#!/bin/bash
+
+echo -e "0000000000000000000000000000000000000001:5\n12340000000000000000000000000000000000AA:900\n12340000000000000000000000000000000000AA:100\n12350000000000000000000000000000000000BB:7\n8000000000000000000000000000000000000000:300\nFFFF000000000000000000000000000000000000:1" | hex2rds -c -H h.hot -t 2 -o h.srds
+
+echo -e "\n\ntest 1: hot hash sidecar holds top 2 - expecting 2 entries of 20 + 12 bytes after 24 bytes header: 88 bytes"
+stat -c %s h.hot
+
+echo -e "\n\ntest 2: hot key with 2 occurrences - expecting 2 matches"
+srdsgrep -v -c -x -H h.hot 12340000000000000000000000000000000000AA h.srds
+
+echo -e "\n\ntest 3: hot and cold keys from file - expecting same output with and without sidecar"
+echo -e "8000000000000000000000000000000000000000\n12350000000000000000000000000000000000BB\n7777000000000000000000000000000000000000" >h.keys
+srdsgrep -c -x -f h.keys h.srds >h.cold
+srdsgrep -c -x -H h.hot -f h.keys h.srds | tee h.warm
+cmp h.cold h.warm && echo "identical"
+
+echo -e "\n\ntest 4: sidecar of other data - expecting warning 'does not match'"
+head -c 60 h.srds >h2.srds
+srdsgrep -c -x -H h.hot 12340000000000000000000000000000000000AA h2.srds
+
+rm -f h.srds h2.srds h.hot h.keys h.cold h.warm
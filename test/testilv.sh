@@ -0,0 +1,51 @@
+#!/bin/bash
+
+source searchkeys.sh
+
+srdsgen -n 100000 -l 20 -s 5 -x >a.txt
+hex2rds -I a.idx -i a.txt -o a.srds 2>/dev/null
+srdsmerge -l 20 -o ad.srds a.srds a.srds
+srdsmerge -r -l 20 -o ar.srds <(srdssort -r -l 20 <a.srds) <(srdssort -r -l 20 <a.srds)
+writeKeys a.keys 100000 37 4 1000
+
+echo -e "\n\ntest 1: keys of the data set, which has each record twice, and 1000 other keys - expecting 1002 keys with 0 matches and 2703 keys with 2 matches"
+countMatches -M 16 -l 20 -x -f a.keys ad.srds
+echo "with -m 1 - expecting 1002 keys with 0 matches and 2703 keys with 1 match"
+countMatches -m 1 -M 16 -l 20 -x -f a.keys ad.srds
+
+for O in "-c" "-X" "-c -m 1" "-X -m 3" "-c -m 0" ; do
+  srdsgrep ${O} -l 20 -x -f a.keys ad.srds >a.sync
+  srdsgrep ${O} -l 20 -x -f a.keys.short ad.srds >a.syncshort
+  for M in "-M 16" "-M 1" "-M 64" ; do
+    echo -e "\n\ntest '${O} ${M}': expecting same output as sequential search"
+    sameOutput "keys" a.sync srdsgrep ${O} ${M} -l 20 -x -f a.keys ad.srds
+    sameOutput "short keys" a.syncshort srdsgrep ${O} ${M} -l 20 -x -f a.keys.short ad.srds
+  done
+done
+
+echo -e "\n\ntest 2: descending order, prefix index, stdin and several files - expecting same output as sequential search"
+srdsgrep -c -r -l 20 -x -f a.keys ar.srds | cmp - <(srdsgrep -c -r -M 16 -l 20 -x -f a.keys ar.srds) && echo "descending identical"
+srdsgrep -X -l 20 -x -I a.idx -f a.keys a.srds | cmp - <(srdsgrep -X -M 16 -l 20 -x -I a.idx -f a.keys a.srds) && echo "index identical"
+srdsgrep -c -l 20 -x -f a.keys <ad.srds | cmp - <(srdsgrep -c -M 16 -l 20 -x -f a.keys <ad.srds) && echo "stdin identical"
+srdsgrep -c -l 20 -x -f a.keys a.srds ad.srds | cmp - <(srdsgrep -c -M 16 -l 20 -x -f a.keys a.srds ad.srds) && echo "files identical"
+
+echo -e "\n\ntest 3: srdsserve - expecting same replies with 16 and 1 interleaved searches"
+srdsserve -L 127.0.0.1:17416 ad.srds & P16=$!
+srdsserve -w 1 -L 127.0.0.1:17401 ad.srds & P1=$!
+sleep 0.5
+srdsgrep -c -l 20 -x -f a.keys ad.srds >a.sync
+N=$( wc -l <a.keys )
+for W in 17416 17401 ; do
+  exec 3<>/dev/tcp/127.0.0.1/${W}
+  cat a.keys >&3
+  head -n ${N} <&3 | cmp - a.sync && echo "port ${W} identical"
+  exec 3>&-
+done
+kill $P16 $P1
+wait 2>/dev/null
+
+echo -e "\n\ntest 4: with -q - expecting error 'interleaved search needs' and exit code 2"
+srdsgrep -c -q 64 -M 16 -l 20 -x -f a.keys ad.srds
+echo "exit code $?"
+
+rm -f a.txt a.idx a.srds ad.srds ar.srds a.keys a.keys.short a.sync a.syncshort
@@ -0,0 +1,30 @@
+#!/bin/bash
+
+# I/O modes (-D) of the bulk tools: output must not depend on the mode.
+# inputs are larger than the two 4 MB buffers of 'direct' - and not aligned to 4096 bytes
+srdsgen -n 500003 -l 20 -s 11 -x >d.txt
+srdsgen -n 400009 -l 20 -s 12 -o d2.srds
+hex2rds -c -i d.txt -o d1.srds 2>/dev/null
+srdsmerge -l 20 -o dm.srds d1.srds d2.srds
+srdshashencode -l 20 -i dm.srds -o dm.dlt
+
+for M in dontneed direct ; do
+  echo -e "\n\nI/O mode '${M}' - expecting same output of all tools"
+  hex2rds -D ${M} -j 2 -c -i d.txt -o x.srds 2>/dev/null && cmp x.srds d1.srds && echo "hex2rds OK"
+  srdsmerge -D ${M} -l 20 -o x.srds d1.srds d2.srds && cmp x.srds dm.srds && echo "srdsmerge OK"
+  srdscheck -D ${M} -l 20 -p -o x.srds dm.srds && cmp x.srds dm.srds && echo "srdscheck OK"
+  srdshashencode -D ${M} -l 20 -i dm.srds -o x.dlt && cmp x.dlt dm.dlt && echo "srdshashencode -c OK"
+  srdshashencode -D ${M} -l 20 -d -i dm.dlt >x.srds && cmp x.srds dm.srds && echo "srdshashencode -d to stdout OK"
+  cat dm.dlt | srdshashencode -D ${M} -l 20 -d | cmp - dm.srds && echo "pipes OK"
+done
+
+echo -e "\n\ninterrupted srdsmerge resumed with '-D direct' at an unaligned offset - expecting same output"
+( ulimit -f 8000; srdsmerge -D direct -l 20 -C 0.001 -o r.srds d1.srds d2.srds )
+srdsmerge -D direct -l 20 -C 0.001 --resume -o r.srds d1.srds d2.srds
+cmp r.srds dm.srds && echo "identical"
+
+echo -e "\n\nunknown I/O mode - expecting error and exit code 10"
+srdscheck -D fast -l 20 dm.srds
+echo "exit code $?"
+
+rm -f d.txt d1.srds d2.srds dm.srds dm.dlt x.srds x.dlt r.srds r.srds.ckpt
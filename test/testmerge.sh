@@ -6,3 +6,22 @@ OPTS="-l 7 -b 3 -e 5"
 
 srdsmerge ${OPTS} -o 12.srds 1.srds 2.srds
 cat 12.srds
+
+echo -e "\n\nmerge with 2nd input from stdin - expecting same result"
+cat 2.srds | srdsmerge ${OPTS} 1.srds - | cmp - 12.srds && echo "OK"
+
+echo -e "\n\nmerge with process substitution - expecting same result"
+srdsmerge ${OPTS} <(cat 1.srds) <(cat 2.srds) | cmp - 12.srds && echo "OK"
+
+echo -e "\n\nmerge delta coded and gap coded inputs - expecting same result"
+srdshashencode -c -l 7 -i 1.srds -o 1.dlt
+srdshashencode -g -l 7 -i 2.srds -o 2.gap
+srdsmerge ${OPTS} -d 1.dlt 2.gap | cmp - 12.srds && echo "OK"
+
+echo -e "\n\nmerge into gap coded output - expecting same result after decode"
+srdsmerge ${OPTS} -g 1.srds <(cat 2.gap) | srdshashencode -d -l 7 | cmp - 12.srds && echo "OK"
+
+echo -e "\n\nmerge delta coded input into delta coded output - expecting same result after decode"
+srdsmerge ${OPTS} -d -c 1.dlt - <2.gap | srdshashencode -d -l 7 | cmp - 12.srds && echo "OK"
+
+rm -f 1.dlt 2.gap
@@ -0,0 +1,33 @@
+#!/bin/bash
+
+for S in 1 2 3 4 ; do
+  srdsgen -n 50000 -l 20 -s ${S} -o j${S}.srds
+done
+srdsmerge -l 20 -o jd.srds j1.srds j1.srds
+srds2tree -l 20 -i j2.srds -o jt.srds
+srdsgen -n 50000 -l 20 -s 1 -x | awk 'NR % 5000 == 1' | cut -c 1-40 >j.keys
+K=$( head -n 1 j.keys )
+F="j1.srds jd.srds jt.srds j3.srds jd.srds j4.srds"
+
+echo -e "\n\ntest 1: concurrent search of several files - expecting same output and exit code as one after another"
+for O in "-x ${K}" "-c -x ${K}" "-X -x 0001" "-c -x 0001" "-c -x -f j.keys" "-X -m 1 -x -f j.keys" ; do
+  srdsgrep -l 20 -j 1 ${O} ${F} >j.seq
+  R1=$?
+  srdsgrep -l 20 -j 4 ${O} ${F} >j.par
+  R2=$?
+  cmp j.seq j.par && [ ${R1} -eq ${R2} ] && echo "identical: ${O}"
+done
+
+echo -e "\n\ntest 2: '-m' over all files - expecting 'j1.srds:1', 'jd.srds:2', 'jt.srds:1' and 'j3.srds:1'"
+srdsgrep -l 20 -j 4 -c -m 5 -x 0001 ${F}
+for M in 1 4 5 ; do
+  srdsgrep -l 20 -j 1 -X -m ${M} -x 0001 ${F} >j.seq
+  srdsgrep -l 20 -j 4 -X -m ${M} -x 0001 ${F} >j.par
+  cmp j.seq j.par && echo "identical with -m ${M}: $( wc -l <j.par ) matches"
+done
+
+echo -e "\n\ntest 3: missing file - expecting error 'could not open' and exit code 2"
+srdsgrep -l 20 -j 4 -c -x ${K} j1.srds nothere.srds jd.srds
+echo "exit code $?"
+
+rm -f j1.srds j2.srds j3.srds j4.srds jd.srds jt.srds j.keys j.seq j.par
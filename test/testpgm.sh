@@ -0,0 +1,33 @@
+#!/bin/bash
+
+source searchkeys.sh
+
+srdsgen -n 100000 -l 20 -s 5 -o p.srds
+srds2pgm -v -l 20 -e 16 -i p.srds -o p.pgm
+writeKeys p.keys 100000 997 5
+
+echo -e "\n\ntest 1: keys of the data set - expecting 101 keys with 1 match and 2 keys with 0 matches - and same output without learned index"
+countMatches -x -P p.pgm -f p.keys p.srds
+srdsgrep -c -l 20 -x -f p.keys p.srds >p.full
+sameOutput "keys" p.full srdsgrep -c -x -P p.pgm -f p.keys p.srds
+
+echo -e "\n\ntest 2: short keys - expecting same output with and without learned index"
+srdsgrep -c -l 20 -x -f p.keys.short p.srds >p.full
+sameOutput "short keys" p.full srdsgrep -c -x -P p.pgm -f p.keys.short p.srds
+
+echo -e "\n\ntest 3: duplicate keys with -m 2 - expecting 2 matches"
+echo -e "0011\n0022\n0123\n0123\n0123\n0124\nFF00" | hex2rds -n 2 -o 2p.srds
+srds2pgm -l 2 -e 1 -i 2p.srds -o 2p.pgm
+srdsgrep -c -l 2 -m 2 -P 2p.pgm -x "0123" 2p.srds
+
+echo -e "\n\ntest 4: multiple files and other data - expecting error 'only supported' and warning 'does not match'"
+srdsgrep -c -l 2 -P 2p.pgm -x "0123" 2p.srds p.srds 2>&1 | head -1
+head -c 8 2p.srds >2q.srds
+srdsgrep -c -l 2 -P 2p.pgm -x "0123" 2q.srds
+
+echo -e "\n\ntest 5: unsorted input - expecting error 'not in ascending order' and exit code 1"
+srdsgen -n 100 -l 20 -u | srds2pgm -o u.pgm
+echo "exit code $?"
+ls u.pgm 2>/dev/null
+
+rm -f p.srds p.pgm p.keys p.keys.short p.full 2p.srds 2p.pgm 2q.srds
@@ -0,0 +1,20 @@
+#!/bin/bash
+
+echo -e "\n\ntest 1: SHA-1 of 'password' - expecting 5BAA61E4C9B93F3F0682250B6CF8331B7EE68FD8"
+pwhash password
+
+echo -e "\n\ntest 2: NTLM of 'password' - expecting 8846F7EAEE8FB117AD06BDD830B7586C"
+pwhash -N password
+
+echo -e "\n\ntest 3: SHA-1 in bulk mode - expecting same as sha1sum"
+echo -e "a\nabc\n\nsecret" | pwhash | cmp - <(for p in a abc "" secret; do echo -n "$p" | sha1sum | cut -b 1-40 | tr a-f A-F; done) && echo "OK"
+
+echo -e "\n\ntest 4: NTLM multi-buffer bulk mode - expecting same as single passwords"
+for p in a abc secret "pässwörd" "0123456789012345678901234567" "x"; do echo "$p"; done >pw.txt
+for i in 1 2 3 4; do cat pw.txt; done | pwhash -N | cmp - <(for i in 1 2 3 4; do while read -r p; do pwhash -N "$p"; done <pw.txt; done) && echo "OK"
+
+echo -e "\n\ntest 5: bulk lookup of NTLM hashes with srdsgrep -f - expecting 3x count 1 and 1x count 0"
+pwhash -N a abc secret | sort | hex2rds -n 16 -o nt.srds
+pwhash -N abc nothere secret a | srdsgrep -c -x -l 16 -f - nt.srds
+
+rm -f pw.txt nt.srds
@@ -0,0 +1,11 @@
+#!/bin/bash
+
+echo -e "0123456789ABCDEF0123456789ABCDEF01234567\n0123456789ABCDEF0123456789ABCDEF01234567\n01234FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF\nABCDE00000000000000000000000000000000000" | hex2rds -n 20 -o r.srds
+
+echo -e "\n\ntest 1: range file 01234 - expecting '56789ABCDEF0123456789ABCDEF01234567:2' and 'FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF:1'"
+srds2range -L -i r.srds -t - | tar xO 01234
+
+echo -e "\n\ntest 2: number of files in sub directories - expecting 1048592"
+srds2range -d 1 -i r.srds -t - | tar t | wc -l
+
+rm -f r.srds
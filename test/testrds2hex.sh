@@ -0,0 +1,14 @@
+#!/bin/bash
+
+source prepare.sh
+
+echo -e "\n\ntest 1: hexadecimal lines of 1.srds - expecting same as od"
+rds2hex -l 7 -i 1.srds | cmp - <(od -A n -t x1 -w7 -v 1.srds | sed 's/ //g' | tr a-f A-F) && echo "OK"
+
+echo -e "\n\ntest 2: roundtrip of random data over hex2rds"
+head -c 200000 /dev/urandom >r.srds
+rds2hex -x -i r.srds | hex2rds -n 20 | cmp - r.srds && echo "OK"
+
+echo -e "\n\ntest 3: 2 bytes hash with 1 byte count - separated by ';'. expected '7879:122;6162:99;'"
+echo -n -e "xyz" | rds2hex -l 3 -n 2 -c -s ';'
+echo -n -e "abc" | rds2hex -l 3 -n 2 -c -s ';\n'
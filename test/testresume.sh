@@ -0,0 +1,41 @@
+#!/bin/bash
+
+# interruptions are simulated with a file size limit (ulimit -f in kB): the tool is killed with SIGXFSZ
+srdsgen -n 1000000 -l 20 -s 7 -x >k.txt
+hex2rds -c -m k.meta -I k.idx -i k.txt -o k.srds 2>/dev/null
+srdsgen -n 400000 -l 20 -s 8 -o k2.srds
+srdsmerge -l 20 -o km.srds k.srds k2.srds
+
+echo -e "\n\ntest 1: hex2rds interrupted with checkpoints - expecting same output, index and metadata after --resume"
+( ulimit -f 8000; hex2rds -c -m r.meta -I r.idx -C 0.001 -i k.txt -o r.srds 2>/dev/null )
+grep "^records=" r.srds.ckpt
+hex2rds -c -m r.meta -I r.idx -C 0.001 --resume -i k.txt -o r.srds 2>/dev/null
+echo "exit code $?"
+cmp r.srds k.srds && cmp r.idx k.idx && diff <(grep -v index r.meta) <(grep -v index k.meta) && echo "identical"
+ls r.srds.ckpt 2>/dev/null
+
+echo -e "\n\ntest 2: multithreaded hex2rds interrupted - expecting same output after --resume"
+( ulimit -f 8000; hex2rds -j 3 -C 0.001 -i k.txt -o r.srds 2>/dev/null )
+hex2rds -j 3 -C 0.001 --resume -i k.txt -o r.srds 2>/dev/null
+cmp r.srds k.srds && echo "identical"
+
+echo -e "\n\ntest 3: srdsmerge interrupted - expecting same output after --resume"
+( ulimit -f 8000; srdsmerge -l 20 -C 0.001 -o r.srds k.srds k2.srds )
+srdsmerge -l 20 -C 0.001 --resume -o r.srds k.srds k2.srds
+cmp r.srds km.srds && echo "identical"
+
+echo -e "\n\ntest 4: srdsmerge of delta coded inputs into delta coded output interrupted - expecting same output after --resume"
+srdshashencode -l 20 -i k.srds -o k.dlt
+srdshashencode -l 20 -i k2.srds -o k2.dlt
+( ulimit -f 8000; srdsmerge -d -c -l 20 -C 0.001 -o r.dlt k.dlt k2.dlt )
+srdsmerge -d -c -l 20 -C 0.001 --resume -o r.dlt k.dlt k2.dlt
+srdshashencode -d -l 20 -i r.dlt | cmp - km.srds && echo "identical"
+
+echo -e "\n\ntest 5: modified output - expecting error 'does not match the checkpoint' and exit code 10"
+( ulimit -f 8000; srdsmerge -l 20 -C 0.001 -o r.srds k.srds k2.srds )
+O=$( grep "^output=" r.srds.ckpt | cut -d = -f 2 )
+printf 'XXXX' | dd of=r.srds bs=1 seek=$(( O - 4 )) conv=notrunc 2>/dev/null
+srdsmerge -l 20 -C 0.001 --resume -o r.srds k.srds k2.srds
+echo "exit code $?"
+
+rm -f k.txt k.meta k.idx k.srds k2.srds km.srds k.dlt k2.dlt r.meta r.idx r.srds r.dlt r.srds.ckpt r.dlt.ckpt
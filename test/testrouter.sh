@@ -0,0 +1,36 @@
+#!/bin/bash
+
+echo -e "0000000000000000000000000000000000000001\n12340000000000000000000000000000000000AA\n12340000000000000000000000000000000000AA\n12350000000000000000000000000000000000BB\n8000000000000000000000000000000000000000\nFFFF000000000000000000000000000000000000" | hex2rds -n 20 -o r.srds
+
+# 3 shards - each served by its own srdsserve: 2 over unix sockets, 1 over TCP
+srdssplit -n 3 -p 16 -o r.srds.part r.srds
+srdsserve -L ./r0.sock r.srds.part.000 & P0=$!
+srdsserve -L 127.0.0.1:17402 r.srds.part.001 & P1=$!
+srdsserve -L ./r2.sock r.srds.part.002 & P2=$!
+sed -e 's| r.srds.part.000$| ./r0.sock|' -e 's| r.srds.part.001$| 127.0.0.1:17402|' -e 's| r.srds.part.002$| ./r2.sock|' r.srds.part.manifest > r.router.manifest
+srdsrouter -t 1000 -L 127.0.0.1:17401 r.router.manifest & PR=$!
+sleep 0.5
+
+exec 3<>/dev/tcp/127.0.0.1/17401
+
+echo -e "\n\ntest 1: single query - expecting '12340000000000000000000000000000000000AA:2'"
+echo "12340000000000000000000000000000000000AA" >&3
+read -r L <&3 ; echo "$L"
+
+echo -e "\n\ntest 2: batch over all shards - expecting counts 1, 0, 1, 1, 1 in request order"
+echo -e "FFFF000000000000000000000000000000000000\n7777000000000000000000000000000000000000\n0000000000000000000000000000000000000001\n12350000000000000000000000000000000000BB\n8000000000000000000000000000000000000000" >&3
+for k in 1 2 3 4 5; do read -r L <&3 ; echo "$L"; done
+
+echo -e "\n\ntest 3: short key - expecting '12:3' - and invalid key 'XY:ERR'"
+echo -e "12\nXY" >&3
+for k in 1 2; do read -r L <&3 ; echo "$L"; done
+
+echo -e "\n\ntest 4: stopped shard server - expecting '12350000000000000000000000000000000000BB:ERR' and 'FFFF000000000000000000000000000000000000:1'"
+kill $P1 ; wait $P1 2>/dev/null
+echo -e "12350000000000000000000000000000000000BB\nFFFF000000000000000000000000000000000000" >&3
+for k in 1 2; do read -r L <&3 ; echo "$L"; done
+
+exec 3>&-
+kill $PR $P0 $P2
+wait 2>/dev/null
+rm -f r.srds r.srds.part.* r.router.manifest r0.sock r2.sock
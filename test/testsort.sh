@@ -0,0 +1,23 @@
+#!/bin/bash
+
+source prepare.sh
+
+OPTS="-l 7 -b 3 -e 5"
+
+echo -e "\n\ntest 1: sort unsorted concatenation of 1.srds and 2.srds - expecting same keys as merge and same records"
+# cde005 and zyx005 have equal keys: their order is unspecified
+srdsmerge ${OPTS} -o 12.srds 1.srds 2.srds
+cat 2.srds 1.srds | srdssort ${OPTS} -o 21.srds
+cut -c 4-6 21.srds | cmp - <(cut -c 4-6 12.srds) && echo "keys OK"
+sort 21.srds | cmp - <(sort 12.srds) && echo "records OK"
+
+echo -e "\n\ntest 2: sort random 20 byte data sets with small memory budget - forcing merge of runs"
+head -c 2000000 /dev/urandom >r.rds
+srdssort -l 20 -M 256 -j 2 -o r.srds r.rds
+srdscheck -v -l 20 r.srds
+od -A n -t x1 -w20 -v r.rds | LC_ALL=C sort | cmp - <(od -A n -t x1 -w20 -v r.srds) && echo "OK"
+
+echo -e "\n\ntest 3: sort in descending order - expecting same result as reversed sort"
+srdssort -r -l 20 -o r.srds r.rds
+od -A n -t x1 -w20 -v r.rds | LC_ALL=C sort -r | cmp - <(od -A n -t x1 -w20 -v r.srds) && echo "OK"
+rm -f r.rds r.srds 21.srds
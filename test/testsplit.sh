@@ -0,0 +1,17 @@
+#!/bin/bash
+
+echo -e "0000000000000000000000000000000000000001\n0000000000000000000000000000000000000002\n12340000000000000000000000000000000000AA\n12340000000000000000000000000000000000AA\n12350000000000000000000000000000000000BB\n8000000000000000000000000000000000000000\nFFFF000000000000000000000000000000000000" | hex2rds -n 20 -o s.srds
+
+echo -e "\n\ntest 1: split into 3 shards - expecting the original file from concatenated shards"
+srdssplit -v -n 3 -p 16 -o s.srds.part s.srds
+cat s.srds.part.000 s.srds.part.001 s.srds.part.002 | cmp - s.srds && echo "shards are identical to original"
+cat s.srds.part.manifest
+
+echo -e "\n\ntest 2: routed search - expecting 2 matches for 1234 and 1 match for 1235"
+srdsgrep -c -x -S s.srds.part.manifest 12340000000000000000000000000000000000AA
+srdsgrep -X -x -S s.srds.part.manifest 12350000000000000000000000000000000000BB
+
+echo -e "\n\ntest 3: short keys with key file - expecting '1234:2', 'FFFF:1' and '7777:0'"
+echo -e "1234\nFFFF\n7777" | srdsgrep -c -x -l 20 -S s.srds.part.manifest -f -
+
+rm -f s.srds s.srds.part.*
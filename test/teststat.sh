@@ -0,0 +1,29 @@
+#!/bin/bash
+
+source prepare.sh
+
+OPTS="-l 7 -b 3 -e 5"
+
+echo -e "\n\ntest 1: expected result: merge output is identical with and without telemetry"
+srdsmerge ${OPTS} -o 12.srds 1.srds 2.srds
+srdsmerge ${OPTS} -P 1 -J m.json -o 12s.srds 1.srds 2.srds 2>/dev/null
+cmp 12.srds 12s.srds && echo "OK"
+
+echo -e "\n\ntest 2: expected result: JSON summary with records, phases and peak RSS"
+cat m.json
+for k in tool status records bytes_in bytes_out input_size wall_s read_s process_s write_s cpu_user_s cpu_sys_s mb_per_s peak_rss_kb ; do
+  grep -q "\"${k}\":" m.json || echo "missing key ${k}"
+done
+
+echo -e "\n\ntest 3: expected result: srdscheck summary to stderr - with status 0"
+srdscheck ${OPTS} -J - 12.srds
+
+echo -e "\n\ntest 4: expected result: hashencode round trip with telemetry. records equal in both summaries"
+srdshashencode -l 7 -i 12.srds -o 12.enc -J e.json
+srdshashencode -l 7 -d -i 12.enc -J d.json | cmp - 12.srds && echo "OK"
+grep -o '"records":[0-9]*' e.json d.json
+
+echo -e "\n\ntest 5: expected result: hex2rds summary counts converted lines"
+printf "0011AA\n0022BB\n0033CC\n" | hex2rds -J - >/dev/null
+
+rm -f m.json e.json d.json 12.enc
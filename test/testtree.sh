@@ -0,0 +1,35 @@
+#!/bin/bash
+
+source searchkeys.sh
+
+srdsgen -n 200000 -l 20 -s 5 -o t.srds
+srdsmerge -l 20 -o td.srds t.srds t.srds
+writeKeys t.keys 200000 997 6
+
+echo -e "\n\ntest 1: keys of the data set, which has each record twice - expecting 201 keys with 2 matches and 2 keys with 0 matches"
+srds2tree -l 20 -k 16 -i td.srds -o td.tree
+countMatches -l 20 -x -f t.keys td.tree
+
+for K in 8 16 512 ; do
+  echo -e "\n\ntest K=${K}: keys with duplicates - expecting same output from sorted file and search tree layout"
+  srds2tree -v -l 20 -k ${K} -i td.srds -o td.tree
+  srdsgrep -l 20 -x -f t.keys td.srds >t.full
+  sameOutput "keys" t.full srdsgrep -l 20 -x -f t.keys td.tree
+  srdsgrep -c -l 20 -x -f t.keys.short td.srds >t.full
+  sameOutput "short keys" t.full srdsgrep -c -l 20 -x -f t.keys.short td.tree
+done
+
+echo -e "\n\ntest 2: key from stdin with -m 1 - expecting 1 match"
+head -n 1 t.keys | srdsgrep -c -m 1 -l 20 -x -f - td.tree
+
+echo -e "\n\ntest 3: wrong block length - expecting error 'does not match' and exit code 2"
+srdsgrep -c -l 10 -x 0123 td.tree
+echo "exit code $?"
+
+echo -e "\n\ntest 4: unsorted input - expecting error 'not in ascending order' and exit code 1"
+srdsgen -n 100 -l 20 -u -o tu.srds
+srds2tree -i tu.srds -o tu.tree
+echo "exit code $?"
+ls tu.tree 2>/dev/null
+
+rm -f t.srds td.srds tu.srds td.tree t.keys t.keys.short t.full